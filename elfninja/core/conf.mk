@@ -1,2 +1,2 @@
 MODULE = core
-LD_FLAGS = -ldl
\ No newline at end of file
+LD_FLAGS = -ldl -lpthread
\ No newline at end of file
@@ -25,6 +25,7 @@
 
 struct enj_blob_anchor;
 struct enj_blob_cursor;
+struct enj_blob_listener;
 
 typedef struct enj_blob
 {
@@ -38,6 +39,15 @@ typedef struct enj_blob
 
     struct enj_blob_cursor* cursors;
     struct enj_blob_cursor* last_cursor;
+
+    struct enj_blob_listener* listeners;
+    struct enj_blob_listener* last_listener;
+
+    // Set by enj_elf_freeze, edits then fail with ENJ_ERR_FROZEN
+    int frozen;
+
+    // Set by every edit of the content, may be cleared by the owner
+    int dirty;
 } enj_blob;
 
 typedef struct enj_blob_anchor
@@ -68,6 +78,32 @@ typedef struct enj_blob_cursor
     struct enj_blob_cursor* next;
 } enj_blob_cursor;
 
+enum
+{
+    ENJ_BLOB_EDIT_INSERT,
+    ENJ_BLOB_EDIT_PAD,
+    ENJ_BLOB_EDIT_REMOVE,
+    ENJ_BLOB_EDIT_MOVE,
+    ENJ_BLOB_EDIT_COLLAPSE
+};
+
+typedef struct enj_blob_range
+{
+    size_t start;
+    size_t length;
+} enj_blob_range;
+
+typedef struct enj_blob_listener
+{
+    struct enj_blob* blob;
+
+    void* arg;
+    int (*o_edit)(void* arg, int edit, size_t start, size_t length, enj_error** err);
+
+    struct enj_blob_listener* prev;
+    struct enj_blob_listener* next;
+} enj_blob_listener;
+
 enj_blob* enj_blob_create(enj_error** err);
 void enj_blob_delete(enj_blob* blob);
 
@@ -77,14 +113,21 @@ int enj_blob_remove_anchor(enj_blob* blob, enj_blob_anchor* anchor, enj_error**
 enj_blob_cursor* enj_blob_new_cursor(enj_blob* blob, size_t pos, size_t length, enj_error** err);
 int enj_blob_remove_cursor(enj_blob* blob, enj_blob_cursor* cursor, enj_error** err);
 
+int enj_blob_add_listener(enj_blob* blob, enj_blob_listener* listener, enj_error** err);
+int enj_blob_remove_listener(enj_blob* blob, enj_blob_listener* listener, enj_error** err);
+
 int enj_blob_read(enj_blob* blob, size_t start, void* ptr, size_t length, enj_error** err);
 int enj_blob_write(enj_blob* blob, size_t start, void const* ptr, size_t length, enj_error** err);
 int enj_blob_set(enj_blob* blob, size_t start, char value, size_t count, enj_error** err);
 int enj_blob_insert(enj_blob* blob, size_t start, void const* ptr, size_t length, enj_error** err);
+int enj_blob_pad(enj_blob* blob, size_t start, size_t length, enj_error** err);
 int enj_blob_remove(enj_blob* blob, size_t start, size_t length, enj_error** err);
+int enj_blob_collapse(enj_blob* blob, enj_blob_range const* ranges, size_t count, enj_error** err);
 int enj_blob_move(enj_blob* blob, size_t src, size_t dest, size_t length, enj_error** err);
+int enj_blob_resize_cursor(enj_blob* blob, enj_blob_cursor* cursor, size_t length, enj_error** err);
 
 int enj_blob__update_cursors(enj_blob* blob, enj_error** err);
+int enj_blob__notify(enj_blob* blob, int edit, size_t start, size_t length, enj_error** err);
 int enj_blob__resize(enj_blob* blob, size_t new_size, enj_error** err);
 int enj_blob__grow(enj_blob* blob, enj_error** err);
 int enj_blob__shrink(enj_blob* blob, enj_error** err);
@@ -24,4 +24,9 @@
 #include "elfninja/core/note.h"
 #include "elfninja/core/note_gnu.h"
 #include "elfninja/core/dynamic.h"
+#include "elfninja/core/hash.h"
+#include "elfninja/core/reloc.h"
+#include "elfninja/core/compact.h"
+#include "elfninja/core/probe.h"
+#include "elfninja/core/strscan.h"
 #include "elfninja/core/trait/layout.h"
@@ -30,6 +30,20 @@ struct enj_elf_shdr;
 struct enj_elf_content_view;
 struct enj_elf_trait;
 struct enj_elf_phdr;
+struct enj_elf_edit;
+
+// Parts of the model traits depend on, see enj_elf_build_traits
+enum
+{
+    ENJ_ELF_DEP_HEADER   = 0x01,
+    ENJ_ELF_DEP_SECTIONS = 0x02,
+    ENJ_ELF_DEP_CONTENTS = 0x04,
+    ENJ_ELF_DEP_SEGMENTS = 0x08,
+    ENJ_ELF_DEP_BLOB     = 0x10,
+    ENJ_ELF_DEP_ALL      = 0x1F
+};
+
+#define ENJ_ELF_DEP_COUNT 5
 
 typedef struct enj_elf
 {
@@ -55,8 +69,33 @@ typedef struct enj_elf
     struct enj_elf_trait* last_trait;
 
     struct enj_elf_shdr* shstrtab;
+
+    // Change stamps of each ENJ_ELF_DEP_* part
+    size_t generation;
+    size_t stamps[ENJ_ELF_DEP_COUNT];
+
+    // Blob edits not yet applied by every patchable trait
+    enj_blob_listener listener;
+    struct enj_elf_edit* edits;
+    size_t edit_count;
+    size_t edit_capacity;
+
+    // See enj_elf_freeze
+    int frozen;
+
+    // File read by enj_elf_create_fd (0 otherwise), still owned by the
+    //  caller ; the blob holds its bytes as long as blob->dirty is unset
+    int source_fd;
 } enj_elf;
 
+typedef struct enj_elf_edit
+{
+    int edit;
+    size_t start;
+    size_t length;
+    size_t generation;
+} enj_elf_edit;
+
 typedef struct enj_elf_shdr
 {
     enj_elf* elf;
@@ -65,6 +104,8 @@ typedef struct enj_elf_shdr
     enj_fstring* cached_name;
     struct enj_elf_content_view* content_view;
     void* content;
+    // Last change stamp of the contents
+    size_t generation;
 
     enj_blob_anchor* header;
     enj_blob_anchor* name;
@@ -114,16 +155,36 @@ typedef struct enj_elf_content_view
     size_t tag;
     int target_shtype;
     int (*o_pull)(enj_elf_shdr* section, enj_error** err);
+    // Refresh cached values, returns 1 if any of them changed
     int (*o_update)(enj_elf_shdr* section, enj_error** err);
     int (*o_push)(enj_elf_shdr* section, enj_error** err);
     int (*o_delete)(enj_elf_shdr* section, enj_error** err);
+
+    // Optional split pull, used when pulling over several threads : o_stage
+    //  parses one of `parts` slices of the section without editing the blob and
+    //  may run concurrently, o_commit then creates the anchors (in section order,
+    //  on a single thread) and releases the stages, as does o_discard on errors
+    int (*o_stage)(enj_elf_shdr* section, size_t part, size_t parts, void** stage, enj_error** err);
+    int (*o_commit)(enj_elf_shdr* section, void** stages, size_t parts, enj_error** err);
+    void (*o_discard)(void* stage);
 } enj_elf_content_view;
 
 typedef struct enj_elf_trait
 {
     enj_elf* elf;
     void* arg;
+
+    // ENJ_ELF_DEP_* parts the trait is built from (0 for all of them), and
+    //  eventually the only content view tag it looks at
+    int deps;
+    size_t content_tag;
+
+    // Stamp of the last build
+    size_t generation;
+
     int (*o_build)(void* arg, enj_error** err);
+    // Apply a blob edit incrementally, returns 1 to ask for a full build instead
+    int (*o_patch)(void* arg, int edit, size_t start, size_t length, enj_error** err);
 
     struct enj_elf_trait* prev;
     struct enj_elf_trait* next;
@@ -176,6 +237,7 @@ int enj_elf_update_sections(enj_elf* elf, enj_error** err);
 int enj_elf_push_sections(enj_elf* elf, enj_error** err);
 
 int enj_elf_pull_contents(enj_elf* elf, enj_error** err);
+void enj_elf_set_pull_threads(size_t threads);
 int enj_elf_update_contents(enj_elf* elf, enj_error** err);
 int enj_elf_push_contents(enj_elf* elf, enj_error** err);
 
@@ -184,6 +246,7 @@ int enj_elf_update_segments(enj_elf* elf, enj_error** err);
 int enj_elf_push_segments(enj_elf* elf, enj_error** err);
 
 int enj_elf_build_traits(enj_elf* elf, enj_error** err);
+int enj_elf_freeze(enj_elf* elf, enj_error** err);
 
 enj_elf_shdr* enj_elf_find_shdr_by_index(enj_elf* elf, size_t index, enj_error** err);
 enj_elf_shdr* enj_elf_find_shdr_by_name(enj_elf* elf, const char* name, enj_error** err);
@@ -200,6 +263,7 @@ int enj_elf_shdr_rename(enj_elf_shdr* section, const char* name, enj_error** err
 int enj_elf_shdr_remove(enj_elf_shdr* section, int mode, enj_error** err);
 int enj_elf_shdr_swap(enj_elf_shdr* section, int index, enj_error** err);
 int enj_elf_shdr_move(enj_elf_shdr* section, int index, enj_error** err);
+int enj_elf_shdr_reorder(enj_elf* elf, enj_elf_shdr** order, size_t count, enj_error** err);
 
 int enj_elf_phdr_pull(enj_elf_phdr* segment, enj_error** err);
 int enj_elf_phdr_update(enj_elf_phdr* segment, enj_error** err);
@@ -212,6 +276,10 @@ int enj_elf_phdr_move(enj_elf_phdr* segment, int index, enj_error** err);
 int enj_elf_add_trait(enj_elf* elf, enj_elf_trait* trait, enj_error** err);
 int enj_elf_trait_remove(enj_elf_trait* trait, enj_error** err);
 
+int enj_elf__check_frozen(enj_elf* elf, enj_error** err);
+void enj_elf__touch(enj_elf* elf, int deps);
+void enj_elf__touch_content(enj_elf_shdr* section);
+int enj_elf__edit(void* arg, int edit, size_t start, size_t length, enj_error** err);
 int enj_elf__shdr_delete(enj_elf_shdr* section, enj_error** err);
 int enj_elf__phdr_delete(enj_elf_phdr* segment, enj_error** err);
 int enj_elf__get_content_view(enj_elf_shdr* section, enj_elf_content_view** view, enj_error** err);
@@ -45,6 +45,14 @@ enj_error* enj_error_create_posix_errno(int code, int posix_errno);
 enj_error* enj_error_create_wrap(int code, enj_error* wrap);
 void enj_error_delete(enj_error* err);
 
+// Code-only errors, for calls whose failures are expected and discarded
+//  right away : errors put into the returned slot only record their code and
+//  location, into thread-local preallocated storage, and never allocate nor
+//  keep wrapped errors. Slots are handed out from a small ring so that
+//  nested probes do not overwrite each other.
+enj_error** enj_error_quiet();
+int enj_error_is_quiet(const enj_error* err);
+
 void enj_error__put(enj_error** err, int code, const char* function, size_t line, const char* file);
 void enj_error__put_posix_errno(enj_error** err, int code, int posix_errno, const char* function, size_t line, const char* file);
 void enj_error__wrap(enj_error** err, int code, enj_error* wrap, const char* function, size_t line, const char* file);
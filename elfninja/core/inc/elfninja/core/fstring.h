@@ -34,6 +34,8 @@ typedef struct enj_fstring
 enj_fstring* enj_fstring_create(const char* string, enj_error** err);
 enj_fstring* enj_fstring_create_n(const char* string, size_t size, enj_error** err);
 void enj_fstring_delete(enj_fstring* fstr);
+// Both strings may be null
+int enj_fstring_equal(const enj_fstring* lhs, const enj_fstring* rhs);
 
 enj_fstring_hash_t enj_fstring_hash(const char* string);
 enj_fstring_hash_t enj_fstring_hash_n(const char* string, size_t size);
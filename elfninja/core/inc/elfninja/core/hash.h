@@ -0,0 +1,69 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ELFNINJA_CORE_HASH_H__
+#define __ELFNINJA_CORE_HASH_H__
+
+#include "elfninja/core/error.h"
+#include "elfninja/core/elf.h"
+#include "elfninja/core/symtab.h"
+
+#include <elf.h>
+#include <stdint.h>
+
+typedef struct enj_hash
+{
+    enj_elf_shdr* section;
+    enj_elf_shdr* symtab;
+
+    // Set for SHT_GNU_HASH sections
+    int gnu;
+
+    size_t bucket_count;
+    uint32_t* buckets;
+
+    // SysV : one entry per symbol, GNU : one hash value per symbol past symoffset
+    size_t chain_count;
+    uint32_t* chains;
+
+    // GNU only : first hashed symbol and bloom filter
+    size_t symoffset;
+    size_t bloom_count;
+    size_t bloom_shift;
+    uint64_t* bloom;
+
+    // Symbol table index, built on demand by lookups
+    size_t symbol_count;
+    enj_symbol** symbols;
+} enj_hash;
+
+uint32_t enj_hash_sysv(const char* name);
+uint32_t enj_hash_gnu(const char* name);
+
+enj_symbol* enj_hash_find_symbol(enj_hash* hash, const char* name, enj_error** err);
+int enj_hash_is_stale(enj_hash* hash, enj_error** err);
+int enj_hash_rebuild(enj_hash* hash, enj_error** err);
+
+int enj_hash__index(enj_hash* hash, enj_error** err);
+
+int enj_hash__pull(enj_elf_shdr* section, enj_error** err);
+int enj_hash__update(enj_elf_shdr* section, enj_error** err);
+int enj_hash__push(enj_elf_shdr* section, enj_error** err);
+int enj_hash__delete(enj_elf_shdr* section, enj_error** err);
+
+#endif // __ELFNINJA_CORE_HASH_H__
@@ -74,6 +74,7 @@ typedef struct enj_note_content_view
     size_t tag;
     int target_type;
     int (*o_pull)(enj_note* note, enj_error** err);
+    // Refresh cached values, returns 1 if any of them changed
     int (*o_update)(enj_note* note, enj_error** err);
     int (*o_push)(enj_note* note, enj_error** err);
     int (*o_delete)(enj_note* note, enj_error** err);
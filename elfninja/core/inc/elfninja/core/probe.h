@@ -0,0 +1,62 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ELFNINJA_CORE_PROBE_H__
+#define __ELFNINJA_CORE_PROBE_H__
+
+#include "elfninja/core/error.h"
+
+enum
+{
+    ENJ_PROBE_CLASS    = 0x01,
+    ENJ_PROBE_MACHINE  = 0x02,
+    ENJ_PROBE_TYPE     = 0x04,
+    ENJ_PROBE_BUILD_ID = 0x08,
+    ENJ_PROBE_SONAME   = 0x10,
+    ENJ_PROBE_NEEDED   = 0x20,
+    ENJ_PROBE_ALL      = 0x3F
+};
+
+#define ENJ_PROBE_BUILD_ID_SIZE 64
+#define ENJ_PROBE_NAME_SIZE     256
+#define ENJ_PROBE_MAX_NEEDED    32
+
+typedef struct enj_probe_result
+{
+    // ENJ_PROBE_* fields that were found
+    int fields;
+
+    int bits;
+    int type;
+    int machine;
+
+    unsigned char build_id[ENJ_PROBE_BUILD_ID_SIZE];
+    size_t build_id_length;
+
+    char soname[ENJ_PROBE_NAME_SIZE];
+
+    char needed[ENJ_PROBE_MAX_NEEDED][ENJ_PROBE_NAME_SIZE];
+    size_t needed_count;
+
+    // Set when a name or some DT_NEEDED entries did not fit
+    int truncated;
+} enj_probe_result;
+
+int enj_elf_probe(int fd, int fields, enj_probe_result* result, enj_error** err);
+
+#endif // __ELFNINJA_CORE_PROBE_H__
@@ -0,0 +1,71 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ELFNINJA_CORE_RELOC_H__
+#define __ELFNINJA_CORE_RELOC_H__
+
+#include "elfninja/core/error.h"
+#include "elfninja/core/elf.h"
+
+#include <elf.h>
+#include <stdint.h>
+
+typedef struct enj_reloc
+{
+    enj_elf_shdr* section;
+    enj_elf_shdr* symtab;
+    enj_elf_shdr* target;
+
+    // Set for SHT_RELA sections
+    int rela;
+
+    // Entries are decoded into parallel arrays, addends are
+    //  left to zero for SHT_REL sections
+    size_t count;
+    size_t capacity;
+    uint64_t* offsets;
+    uint64_t* infos;
+    int64_t* addends;
+} enj_reloc;
+
+#define ENJ_RELOC_SYM(reloc, i) \
+        (reloc->section->elf->bits == 64 ? ELF64_R_SYM(reloc->infos[i]) : ELF32_R_SYM(reloc->infos[i]))
+
+#define ENJ_RELOC_TYPE(reloc, i) \
+        (reloc->section->elf->bits == 64 ? ELF64_R_TYPE(reloc->infos[i]) : ELF32_R_TYPE(reloc->infos[i]))
+
+#define ENJ_RELOC_INFO(reloc, i, sym, type) do {\
+        if (reloc->section->elf->bits == 64) reloc->infos[i] = ELF64_R_INFO(sym, type); \
+        else reloc->infos[i] = ELF32_R_INFO(sym, type); \
+    } while (0)
+
+enum
+{
+    ENJ_RELOC_SHIFT_OFFSETS = 0x01,
+    ENJ_RELOC_SHIFT_ADDENDS = 0x02
+};
+
+int enj_reloc_reserve(enj_reloc* reloc, size_t count, enj_error** err);
+int enj_reloc_shift(enj_reloc* reloc, uint64_t from, uint64_t to, int64_t delta, int flags, enj_error** err);
+
+int enj_reloc__pull(enj_elf_shdr* section, enj_error** err);
+int enj_reloc__update(enj_elf_shdr* section, enj_error** err);
+int enj_reloc__push(enj_elf_shdr* section, enj_error** err);
+int enj_reloc__delete(enj_elf_shdr* section, enj_error** err);
+
+#endif // __ELFNINJA_CORE_RELOC_H__
@@ -0,0 +1,39 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ELFNINJA_CORE_STRSCAN_H__
+#define __ELFNINJA_CORE_STRSCAN_H__
+
+#include "elfninja/core/error.h"
+
+#include <stddef.h>
+
+// One string of a string table ; length does not count the terminating
+//   null byte, which is missing for the last span if terminated is 0
+typedef struct enj_strspan
+{
+    size_t offset;
+    size_t length;
+    int printable;
+    int terminated;
+} enj_strspan;
+
+size_t enj_strscan(const void* data, size_t length, enj_strspan** spans, enj_error** err);
+size_t enj_strscan_printable(const void* data, size_t length);
+
+#endif // __ELFNINJA_CORE_STRSCAN_H__
@@ -100,5 +100,8 @@ int enj_symtab__pull(enj_elf_shdr* section, enj_error** err);
 int enj_symtab__update(enj_elf_shdr* section, enj_error** err);
 int enj_symtab__push(enj_elf_shdr* section, enj_error** err);
 int enj_symtab__delete(enj_elf_shdr* section, enj_error** err);
+int enj_symtab__stage(enj_elf_shdr* section, size_t part, size_t parts, void** stage, enj_error** err);
+int enj_symtab__commit(enj_elf_shdr* section, void** stages, size_t parts, enj_error** err);
+void enj_symtab__discard(void* stage);
 
 #endif // __ELFNINJA_CORE_SYMTAB_H__
@@ -21,6 +21,7 @@
 
 #include "elfninja/core/error.h"
 #include "elfninja/core/elf.h"
+#include "elfninja/core/blob.h"
 
 enum
 {
@@ -28,7 +29,16 @@ enum
     ENJ_TRAIT_LAYOUT_EHDR,
     ENJ_TRAIT_LAYOUT_PHDRS,
     ENJ_TRAIT_LAYOUT_SHDRS,
-    ENJ_TRAIT_LAYOUT_SECTION
+    ENJ_TRAIT_LAYOUT_SECTION,
+    ENJ_TRAIT_LAYOUT_RESERVED,
+    ENJ_TRAIT_LAYOUT_SEGMENT
+};
+
+enum
+{
+    ENJ_TRAIT_LAYOUT_NO_APPEND  = 0x01,
+    // Keep out of the file ranges of segments
+    ENJ_TRAIT_LAYOUT_NO_SEGMENT = 0x02
 };
 
 typedef struct enj_trait_layout_chunk
@@ -38,22 +48,86 @@ typedef struct enj_trait_layout_chunk
     size_t type;
 
     enj_elf_shdr* section;
+    enj_elf_phdr* segment;
+
+    // Memory image, only set for segment chunks
+    size_t addr;
+    size_t mem_size;
 
     struct enj_trait_layout_chunk* prev;
     struct enj_trait_layout_chunk* next;
 } enj_trait_layout_chunk;
 
+typedef struct enj_trait_layout_section_key
+{
+    size_t type;
+    size_t flags;
+    size_t addr;
+    size_t size;
+} enj_trait_layout_section_key;
+
+typedef struct enj_trait_layout_constraints
+{
+    // Allowed file range for the allocation, max_offset = 0 means no limit
+    size_t min_offset;
+    size_t max_offset;
+    int flags;
+
+    // When addr_align is set, the offset must be congruent to addr modulo
+    //  addr_align (as the loader maps p_offset = p_vaddr (mod p_align))
+    size_t addr;
+    size_t addr_align;
+} enj_trait_layout_constraints;
+
 typedef struct enj_trait_layout
 {
     enj_elf_trait trait;
+    enj_blob_listener listener;
 
     enj_trait_layout_chunk* chunks;
     enj_trait_layout_chunk* last_chunk;
+
+    // Chunks sorted by offset, kept in sync with the list
+    enj_trait_layout_chunk** index;
+    size_t chunk_count;
+    size_t index_capacity;
+
+    // Segment chunks sorted by offset, kept apart as they overlap the others
+    enj_trait_layout_chunk** segments;
+    size_t segment_count;
+
+    // Section <-> segment membership, as a segment_count x section_count
+    //  bit matrix indexed by header indices, and the PT_LOAD of each section
+    unsigned char* membership;
+    enj_elf_phdr** loads;
+    size_t section_count;
+
+    // Section header values the membership was computed from
+    enj_trait_layout_section_key* section_keys;
+
+    // Set when an edit could not be tracked, forces a full rebuild
+    int dirty;
 } enj_trait_layout;
 
 enj_trait_layout* enj_trait_layout_create(enj_elf* elf, enj_error** err);
 void enj_trait_layout_delete(enj_trait_layout* fs);
 
+enj_trait_layout_chunk* enj_trait_layout_find(enj_trait_layout* lay, size_t offset);
+int enj_trait_layout_in_segment(enj_trait_layout* lay, enj_elf_phdr* segment, enj_elf_shdr* section);
+enj_elf_phdr* enj_trait_layout_load_segment(enj_trait_layout* lay, enj_elf_shdr* section);
+size_t enj_trait_layout_alloc(enj_trait_layout* lay, size_t size, size_t align,
+                              enj_trait_layout_constraints const* constraints, enj_error** err);
+
+void enj_trait_layout__clear(enj_trait_layout* lay);
+int enj_trait_layout__push_chunk(enj_trait_layout* lay, enj_trait_layout_chunk* chunk, enj_error** err);
+enj_trait_layout_chunk* enj_trait_layout__add_chunk(enj_trait_layout* lay, size_t offset, size_t size, size_t type, enj_error** err);
+int enj_trait_layout__sort(enj_trait_layout* lay, enj_error** err);
+int enj_trait_layout__normalize(enj_trait_layout* lay, enj_error** err);
+int enj_trait_layout__check(enj_trait_layout* lay);
+int enj_trait_layout__map(enj_trait_layout* lay, enj_error** err);
 int enj_trait_layout__build(void* arg, enj_error** err);
+int enj_trait_layout__rebuild(enj_trait_layout* lay, enj_error** err);
+int enj_trait_layout__patch(void* arg, int edit, size_t start, size_t length, enj_error** err);
+int enj_trait_layout__edit(void* arg, int edit, size_t start, size_t length, enj_error** err);
 
 #endif // __ELFNINJA_CORE_TRAIT_LAYOUT_H__
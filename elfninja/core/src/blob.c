@@ -39,6 +39,10 @@ enj_blob* enj_blob_create(enj_error** err)
     blob->last_anchor = 0;
     blob->cursors = 0;
     blob->last_cursor = 0;
+    blob->listeners = 0;
+    blob->last_listener = 0;
+    blob->frozen = 0;
+    blob->dirty = 0;
 
     return blob;
 }
@@ -62,6 +66,10 @@ void enj_blob_delete(enj_blob* blob)
         cursor = next;
     }
 
+    // Listeners are owned by their users, only detach them
+    for (enj_blob_listener* listener = blob->listeners; listener; listener = listener->next)
+        listener->blob = 0;
+
     enj_free(blob->buffer);
     enj_free(blob);
 }
@@ -74,6 +82,12 @@ enj_blob_anchor* enj_blob_new_anchor(enj_blob* blob, size_t pos, enj_error** err
         return 0;
     }
 
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return 0;
+    }
+
     if (pos > blob->buffer_size)
     {
         enj_error_put(err, ENJ_ERR_BOUNDS);
@@ -112,6 +126,12 @@ int enj_blob_remove_anchor(enj_blob* blob, enj_blob_anchor* anchor, enj_error**
         return 0;
     }
 
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return -1;
+    }
+
     if (anchor->prev)
         anchor->prev->next = anchor->next;
     else
@@ -135,6 +155,12 @@ enj_blob_cursor* enj_blob_new_cursor(enj_blob* blob, size_t pos, size_t length,
         return 0;
     }
 
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return 0;
+    }
+
     if (pos > blob->buffer_size)
     {
         enj_error_put(err, ENJ_ERR_BOUNDS);
@@ -185,6 +211,12 @@ int enj_blob_remove_cursor(enj_blob* blob, enj_blob_cursor* cursor, enj_error**
         return 0;
     }
 
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return -1;
+    }
+
     if (enj_blob_remove_anchor(blob, cursor->start, err) < 0 ||
         enj_blob_remove_anchor(blob, cursor->end, err) < 0)
     {
@@ -206,6 +238,62 @@ int enj_blob_remove_cursor(enj_blob* blob, enj_blob_cursor* cursor, enj_error**
     return 0;
 }
 
+int enj_blob_add_listener(enj_blob* blob, enj_blob_listener* listener, enj_error** err)
+{
+    if (!blob || !listener)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return -1;
+    }
+
+    listener->blob = blob;
+
+    listener->prev = blob->last_listener;
+    listener->next = 0;
+    if (listener->prev)
+        listener->prev->next = listener;
+    else
+        blob->listeners = listener;
+    blob->last_listener = listener;
+
+    return 0;
+}
+
+int enj_blob_remove_listener(enj_blob* blob, enj_blob_listener* listener, enj_error** err)
+{
+    if (!blob || !listener || listener->blob != blob)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return -1;
+    }
+
+    if (listener->prev)
+        listener->prev->next = listener->next;
+    else
+        blob->listeners = listener->next;
+
+    if (listener->next)
+        listener->next->prev = listener->prev;
+    else
+        blob->last_listener = listener->prev;
+
+    listener->blob = 0;
+
+    return 0;
+}
+
 int enj_blob_read(enj_blob* blob, size_t start, void* ptr, size_t length, enj_error** err)
 {
     if (!blob || !ptr)
@@ -236,6 +324,14 @@ int enj_blob_write(enj_blob* blob, size_t start, void const* ptr, size_t length,
         return -1;
     }
 
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return -1;
+    }
+
+    blob->dirty = 1;
+
     if (!length)
         return 0;
 
@@ -258,6 +354,14 @@ int enj_blob_set(enj_blob* blob, size_t start, char value, size_t count, enj_err
         return -1;
     }
 
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return -1;
+    }
+
+    blob->dirty = 1;
+
     if (!count)
         return 0;
 
@@ -280,6 +384,14 @@ int enj_blob_insert(enj_blob* blob, size_t start, void const* ptr, size_t length
         return -1;
     }
 
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return -1;
+    }
+
+    blob->dirty = 1;
+
     if (!length)
         return 0;
 
@@ -324,6 +436,70 @@ int enj_blob_insert(enj_blob* blob, size_t start, void const* ptr, size_t length
     if (enj_blob__update_cursors(blob, err) < 0)
         return -1;
 
+    if (enj_blob__notify(blob, ENJ_BLOB_EDIT_INSERT, start, length, err) < 0)
+        return -1;
+
+    return 0;
+}
+
+int enj_blob_pad(enj_blob* blob, size_t start, size_t length, enj_error** err)
+{
+    if (!blob)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return -1;
+    }
+
+    blob->dirty = 1;
+
+    if (!length)
+        return 0;
+
+    if (start > blob->buffer_size)
+    {
+        enj_error_put(err, ENJ_ERR_BOUNDS);
+        return -1;
+    }
+
+    if (enj_blob__resize(blob, blob->buffer_size + length, err) < 0)
+        return -1;
+
+    memmove(blob->buffer + start + length, blob->buffer + start, blob->buffer_size - length - start);
+    memset(blob->buffer + start, 0, length);
+
+    // Unlike enj_blob_insert, push away what starts at the insertion point,
+    //  leaving behind only what ends there
+    for (enj_blob_anchor* anchor = blob->anchors; anchor; anchor = anchor->next)
+    {
+        if (!anchor->valid)
+            continue;
+
+        if (anchor->pos > start || (!anchor->is_cursor_end && anchor->pos == start))
+            anchor->pos += length;
+    }
+
+    // Empty cursors at the insertion point follow their start
+    for (enj_blob_cursor* cursor = blob->cursors; cursor; cursor = cursor->next)
+    {
+        if (!cursor->valid || !cursor->start->valid || !cursor->end->valid)
+            continue;
+
+        if (cursor->end->pos == start && cursor->start->pos > start)
+            cursor->end->pos += length;
+    }
+
+    if (enj_blob__update_cursors(blob, err) < 0)
+        return -1;
+
+    if (enj_blob__notify(blob, ENJ_BLOB_EDIT_PAD, start, length, err) < 0)
+        return -1;
+
     return 0;
 }
 
@@ -335,6 +511,14 @@ int enj_blob_remove(enj_blob* blob, size_t start, size_t length, enj_error** err
         return -1;
     }
 
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return -1;
+    }
+
+    blob->dirty = 1;
+
     if (!length)
         return 0;
 
@@ -373,6 +557,116 @@ int enj_blob_remove(enj_blob* blob, size_t start, size_t length, enj_error** err
     if (enj_blob__update_cursors(blob, err) < 0)
         return -1;
 
+    if (enj_blob__notify(blob, ENJ_BLOB_EDIT_REMOVE, start, length, err) < 0)
+        return -1;
+
+    return 0;
+}
+
+// Remove several sorted, disjoint ranges in a single pass ; anchors are shifted as
+//  enj_blob_remove would do for each range
+int enj_blob_collapse(enj_blob* blob, enj_blob_range const* ranges, size_t count, enj_error** err)
+{
+    if (!blob || (count && !ranges))
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return -1;
+    }
+
+    blob->dirty = 1;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if ((i && ranges[i].start < ranges[i - 1].start + ranges[i - 1].length) ||
+            ranges[i].start + ranges[i].length > blob->buffer_size)
+        {
+            enj_error_put(err, ENJ_ERR_BOUNDS);
+            return -1;
+        }
+    }
+
+    if (!count)
+        return 0;
+
+    // Count of bytes removed before each range
+    size_t* before = enj_malloc((count + 1) * sizeof(size_t));
+    if (!before)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        before[i + 1] = before[i] + ranges[i].length;
+
+    size_t removed = before[count];
+
+    // Slide live bytes down
+    size_t dest = ranges[0].start;
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t src = ranges[i].start + ranges[i].length;
+        size_t end = i + 1 < count ? ranges[i + 1].start : blob->buffer_size;
+
+        memmove(blob->buffer + dest, blob->buffer + src, end - src);
+        dest += end - src;
+    }
+
+    size_t first = ranges[0].start;
+
+    if (enj_blob__resize(blob, blob->buffer_size - removed, err) < 0)
+    {
+        enj_free(before);
+        return -1;
+    }
+
+    for (enj_blob_anchor* anchor = blob->anchors; anchor; anchor = anchor->next)
+    {
+        if (!anchor->valid || anchor->pos <= first)
+            continue;
+
+        // Find the last range starting before the anchor
+        size_t lo = 0;
+        size_t hi = count;
+
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+
+            if (ranges[mid].start < anchor->pos)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        enj_blob_range const* range = &ranges[lo - 1];
+        size_t shift = before[lo - 1];
+
+        if (anchor->pos < range->start + range->length)
+        {
+            anchor->valid = 0;
+            anchor->pos = range->start - shift;
+        }
+        else
+        {
+            anchor->pos -= shift + range->length;
+        }
+    }
+
+    enj_free(before);
+
+    if (enj_blob__update_cursors(blob, err) < 0)
+        return -1;
+
+    if (enj_blob__notify(blob, ENJ_BLOB_EDIT_COLLAPSE, first, removed, err) < 0)
+        return -1;
+
     return 0;
 }
 
@@ -384,6 +678,14 @@ int enj_blob_move(enj_blob* blob, size_t src, size_t dest, size_t length, enj_er
         return -1;
     }
 
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return -1;
+    }
+
+    blob->dirty = 1;
+
     if (!length)
         return 0;
 
@@ -411,9 +713,66 @@ int enj_blob_move(enj_blob* blob, size_t src, size_t dest, size_t length, enj_er
     if (enj_blob__update_cursors(blob, err) < 0)
         return -1;
 
+    if (enj_blob__notify(blob, ENJ_BLOB_EDIT_MOVE, src, length, err) < 0)
+        return -1;
+
     return 0;
 }
 
+int enj_blob_resize_cursor(enj_blob* blob, enj_blob_cursor* cursor, size_t length, enj_error** err)
+{
+    if (!blob || !cursor || cursor->blob != blob)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (blob->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return -1;
+    }
+
+    size_t old_length = cursor->length;
+
+    if (length < old_length)
+        return enj_blob_remove(blob, cursor->end->pos - (old_length - length), old_length - length, err);
+
+    if (length == old_length)
+        return 0;
+
+    unsigned char* zeroes = enj_malloc(length - old_length);
+    if (!zeroes)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    // Insert before the last byte, so that anchors sitting right after
+    //  the cursor are shifted too ; the new bytes are then moved at the end
+    int ret;
+    if (old_length)
+    {
+        size_t last_pos = cursor->end->pos - 1;
+        unsigned char last = blob->buffer[last_pos];
+
+        ret = enj_blob_insert(blob, last_pos, zeroes, length - old_length, err);
+        if (ret >= 0)
+        {
+            blob->buffer[last_pos] = last;
+            memset(blob->buffer + last_pos + 1, 0, length - old_length);
+        }
+    }
+    else
+    {
+        ret = enj_blob_insert(blob, cursor->end->pos, zeroes, length - old_length, err);
+    }
+
+    enj_free(zeroes);
+
+    return ret;
+}
+
 int enj_blob__update_cursors(enj_blob* blob, enj_error** err)
 {
     if (!blob)
@@ -449,6 +808,24 @@ int enj_blob__update_cursors(enj_blob* blob, enj_error** err)
     return 0;
 }
 
+int enj_blob__notify(enj_blob* blob, int edit, size_t start, size_t length, enj_error** err)
+{
+    if (!blob)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    for (enj_blob_listener* listener = blob->listeners; listener; listener = listener->next)
+    {
+        if (listener->o_edit &&
+           (*listener->o_edit)(listener->arg, edit, start, length, err) < 0)
+            return -1;
+    }
+
+    return 0;
+}
+
 int enj_blob__resize(enj_blob* blob, size_t new_size, enj_error** err)
 {
     if (!blob)
@@ -0,0 +1,401 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "elfninja/core/compact.h"
+#include "elfninja/core/malloc.h"
+#include "elfninja/core/trait/layout.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Live file range ; ranges holding loadable segment contents can only move by a
+//  multiple of the segment alignments, other ones should stay aligned
+typedef struct _live_range
+{
+    size_t start;
+    size_t end;
+    size_t align;
+    size_t load_align;
+} _live_range;
+
+static int _compare_live_ranges(const void* a, const void* b)
+{
+    const _live_range* lhs = (const _live_range*) a;
+    const _live_range* rhs = (const _live_range*) b;
+
+    if (lhs->start != rhs->start)
+        return lhs->start < rhs->start ? -1 : 1;
+
+    return lhs->end < rhs->end ? -1 : lhs->end > rhs->end;
+}
+
+static int _compare_blob_ranges(const void* a, const void* b)
+{
+    const enj_blob_range* lhs = (const enj_blob_range*) a;
+    const enj_blob_range* rhs = (const enj_blob_range*) b;
+
+    return lhs->start < rhs->start ? -1 : lhs->start > rhs->start;
+}
+
+static size_t _lcm(size_t a, size_t b)
+{
+    size_t x = a;
+    size_t y = b;
+
+    while (y)
+    {
+        size_t t = x % y;
+        x = y;
+        y = t;
+    }
+
+    if (a / x > ((size_t) -1) / b)
+        return (size_t) -1;
+
+    return a / x * b;
+}
+
+// Find unreferenced bytes in the section name string table, as left by removed or
+//  renamed sections ; returns the number of ranges written to *ranges
+static size_t _dead_names(enj_elf* elf, enj_blob_range** ranges, enj_error** err)
+{
+    enj_elf_shdr* shstrtab = elf->shstrtab;
+    *ranges = 0;
+
+    if (!shstrtab || !shstrtab->data || !shstrtab->data->length)
+        return 0;
+
+    // The table may also hold other strings (such as symbol names, when it is shared
+    //  with the symbol table) ; only section names are known, so leave it as is
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        if (section != shstrtab && ENJ_ELF_SHDR_GET(section, sh_link) == shstrtab->index)
+            return 0;
+    }
+
+    size_t start = shstrtab->data->start->pos;
+    size_t end = shstrtab->data->end->pos;
+
+    size_t count = 0;
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+        ++count;
+
+    enj_blob_range* names = enj_malloc((count + 1) * sizeof(enj_blob_range));
+    enj_blob_range* dead = enj_malloc((count + 2) * sizeof(enj_blob_range));
+    if (!names || !dead)
+    {
+        enj_free(names);
+        enj_free(dead);
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return (size_t) -1;
+    }
+
+    size_t name_count = 0;
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        if (!section->name || !section->name->valid || section->name->pos < start || section->name->pos >= end)
+            continue;
+
+        size_t pos = section->name->pos;
+        const unsigned char* string = section->elf->blob->buffer + pos;
+        const unsigned char* nul = memchr(string, 0, end - pos);
+
+        names[name_count].start = pos;
+        names[name_count].length = nul ? (size_t) (nul - string) + 1 : end - pos;
+        ++name_count;
+    }
+
+    qsort(names, name_count, sizeof(enj_blob_range), &_compare_blob_ranges);
+
+    // Always keep the leading null byte
+    size_t dead_count = 0;
+    size_t pos = start + 1;
+
+    for (size_t i = 0; i < name_count; ++i)
+    {
+        if (names[i].start > pos)
+        {
+            dead[dead_count].start = pos;
+            dead[dead_count].length = names[i].start - pos;
+            ++dead_count;
+        }
+
+        if (names[i].start + names[i].length > pos)
+            pos = names[i].start + names[i].length;
+    }
+
+    if (pos < end)
+    {
+        dead[dead_count].start = pos;
+        dead[dead_count].length = end - pos;
+        ++dead_count;
+    }
+
+    enj_free(names);
+
+    *ranges = dead;
+    return dead_count;
+}
+
+int enj_elf_compact(enj_elf* elf, size_t* saved, enj_error** err)
+{
+    if (!elf || !elf->bits)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
+    _live_range* live = 0;
+    size_t* need = 0;
+    enj_blob_range* ranges = 0;
+    enj_blob_range* residuals = 0;
+    enj_blob_range* names = 0;
+
+    // Gather live ranges : headers, section contents and segment contents
+    enj_trait_layout* lay = enj_trait_layout_create(elf, err);
+    if (!lay)
+        return -1;
+
+    size_t count = lay->chunk_count;
+    for (enj_elf_phdr* segment = elf->segments; segment; segment = segment->next)
+        ++count;
+
+    live = enj_malloc((count + 1) * sizeof(_live_range));
+    if (!live)
+    {
+        enj_trait_layout_delete(lay);
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    size_t live_count = 0;
+
+    for (enj_trait_layout_chunk* chunk = lay->chunks; chunk; chunk = chunk->next)
+    {
+        if (chunk->type == ENJ_TRAIT_LAYOUT_FREE || !chunk->size)
+            continue;
+
+        size_t align = 1;
+        if (chunk->type == ENJ_TRAIT_LAYOUT_SECTION && chunk->section)
+            align = ENJ_ELF_SHDR_GET(chunk->section, sh_addralign);
+        else if (chunk->type == ENJ_TRAIT_LAYOUT_PHDRS || chunk->type == ENJ_TRAIT_LAYOUT_SHDRS)
+            align = elf->bits / 8;
+
+        live[live_count].start = chunk->offset;
+        live[live_count].end = chunk->offset + chunk->size;
+        live[live_count].align = align ? align : 1;
+        live[live_count].load_align = 0;
+        ++live_count;
+    }
+
+    enj_trait_layout_delete(lay);
+
+    // Loadable segments must keep p_offset = p_vaddr (mod p_align)
+    for (enj_elf_phdr* segment = elf->segments; segment; segment = segment->next)
+    {
+        if (!segment->data || !segment->data->length)
+            continue;
+
+        size_t align = ENJ_ELF_PHDR_GET(segment, p_align);
+        int load = ENJ_ELF_PHDR_GET(segment, p_type) == PT_LOAD;
+
+        live[live_count].start = segment->data->start->pos;
+        live[live_count].end = segment->data->end->pos;
+        live[live_count].align = align ? align : 1;
+        live[live_count].load_align = load ? live[live_count].align : 0;
+        ++live_count;
+    }
+
+    qsort(live, live_count, sizeof(_live_range), &_compare_live_ranges);
+
+    // Merge overlapping ranges, so that they move together
+    size_t unit_count = 0;
+    for (size_t i = 0; i < live_count; ++i)
+    {
+        if (unit_count && live[i].start < live[unit_count - 1].end)
+        {
+            _live_range* unit = &live[unit_count - 1];
+
+            if (live[i].end > unit->end)
+                unit->end = live[i].end;
+            unit->align = _lcm(unit->align, live[i].align);
+
+            if (live[i].load_align)
+                unit->load_align = unit->load_align ? _lcm(unit->load_align, live[i].load_align) : live[i].load_align;
+        }
+        else
+        {
+            live[unit_count++] = live[i];
+        }
+    }
+
+    // A range may only move by a multiple of the alignments of all the following
+    //  loadable segments, as they will also move by (at least) the same amount
+    need = enj_malloc((unit_count + 1) * sizeof(size_t));
+    ranges = enj_malloc((unit_count + 2) * sizeof(enj_blob_range));
+    residuals = enj_malloc((unit_count + 1) * sizeof(enj_blob_range));
+    if (!need || !ranges || !residuals)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        goto fail;
+    }
+
+    need[unit_count] = 1;
+    for (size_t i = unit_count; i > 0; --i)
+        need[i - 1] = live[i - 1].load_align ? _lcm(live[i - 1].load_align, need[i]) : need[i];
+
+    size_t name_count = _dead_names(elf, &names, err);
+    if (name_count == (size_t) -1)
+        goto fail;
+
+    enj_blob_range* all = enj_realloc(ranges, (unit_count + name_count + 2) * sizeof(enj_blob_range));
+    if (!all)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        goto fail;
+    }
+    ranges = all;
+
+    // Plan the whole compaction in a single pass
+    size_t range_count = 0;
+    size_t residual_count = 0;
+    size_t shift = 0;
+    size_t prev_end = 0;
+
+    for (size_t i = 0; i < unit_count; ++i)
+    {
+        size_t gap = live[i].start - prev_end;
+        size_t removed = gap / need[i] * need[i];
+
+        // Other ranges also have to stay aligned, try smaller moves if needed
+        if (!live[i].load_align && live[i].align > 1)
+        {
+            size_t start = live[i].start - shift;
+
+            for (size_t k = 0; k < 64 && k * need[i] <= removed; ++k)
+            {
+                if (!((start - removed + k * need[i]) % live[i].align))
+                {
+                    removed -= k * need[i];
+                    break;
+                }
+            }
+        }
+
+        if (removed)
+        {
+            ranges[range_count].start = prev_end;
+            ranges[range_count].length = removed;
+            ++range_count;
+        }
+
+        if (gap > removed)
+        {
+            residuals[residual_count].start = prev_end - shift;
+            residuals[residual_count].length = gap - removed;
+            ++residual_count;
+        }
+
+        shift += removed;
+
+        // Drop dead names when the string table moves on its own
+        if (name_count && live[i].start == elf->shstrtab->data->start->pos && live[i].end == elf->shstrtab->data->end->pos)
+        {
+            size_t total = 0;
+            for (size_t j = 0; j < name_count; ++j)
+                total += names[j].length;
+
+            size_t budget = total / need[i + 1] * need[i + 1];
+
+            for (size_t j = 0; j < name_count && budget; ++j)
+            {
+                size_t length = names[j].length < budget ? names[j].length : budget;
+
+                ranges[range_count].start = names[j].start;
+                ranges[range_count].length = length;
+                ++range_count;
+
+                budget -= length;
+                shift += length;
+            }
+        }
+
+        prev_end = live[i].end;
+    }
+
+    if (prev_end < elf->blob->buffer_size)
+    {
+        ranges[range_count].start = prev_end;
+        ranges[range_count].length = elf->blob->buffer_size - prev_end;
+        ++range_count;
+
+        shift += elf->blob->buffer_size - prev_end;
+    }
+
+    if (enj_blob_collapse(elf->blob, ranges, range_count, err) < 0)
+        goto fail;
+
+    // Clear what is left of dead gaps
+    for (size_t i = 0; i < residual_count; ++i)
+    {
+        if (enj_blob_set(elf->blob, residuals[i].start, 0, residuals[i].length, err) < 0)
+            goto fail;
+    }
+
+    // SHT_NOBITS sections have no data to follow, keep their offset consistent with their segment
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        if (ENJ_ELF_SHDR_GET(section, sh_type) != SHT_NOBITS || !(ENJ_ELF_SHDR_GET(section, sh_flags) & SHF_ALLOC))
+            continue;
+
+        size_t addr = ENJ_ELF_SHDR_GET(section, sh_addr);
+
+        for (enj_elf_phdr* segment = elf->segments; segment; segment = segment->next)
+        {
+            size_t vaddr = ENJ_ELF_PHDR_GET(segment, p_vaddr);
+
+            if (ENJ_ELF_PHDR_GET(segment, p_type) == PT_LOAD && segment->data &&
+                addr >= vaddr && addr <= vaddr + ENJ_ELF_PHDR_GET(segment, p_memsz))
+            {
+                ENJ_ELF_SHDR_SET(section, sh_offset, segment->data->start->pos + (addr - vaddr));
+                break;
+            }
+        }
+    }
+
+    if (saved)
+        *saved = shift;
+
+    enj_free(live);
+    enj_free(need);
+    enj_free(ranges);
+    enj_free(residuals);
+    enj_free(names);
+    return 0;
+
+fail:
+    enj_free(live);
+    enj_free(need);
+    enj_free(ranges);
+    enj_free(residuals);
+    enj_free(names);
+    return -1;
+}
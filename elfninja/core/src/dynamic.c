@@ -31,6 +31,9 @@ int enj_dynamic_entry_pull(enj_dynamic_entry* dyn, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(dyn->dynamic->section->elf, err) < 0)
+        return -1;
+
     enj_elf* elf = dyn->dynamic->section->elf;
 
     // Read entry
@@ -76,17 +79,20 @@ int enj_dynamic_entry_update(enj_dynamic_entry* dyn, enj_error** err)
         return -1;
     }
 
+    if (dyn->dynamic->section->elf->frozen)
+        return 0;
+
     enj_elf* elf = dyn->dynamic->section->elf;
 
+    int changed = dyn->tag != (size_t) ENJ_DYNAMIC_ENTRY_GET(dyn, d_tag) ||
+                  dyn->value != (size_t) ENJ_DYNAMIC_ENTRY_GET(dyn, d_un.d_val);
+
     dyn->tag = ENJ_DYNAMIC_ENTRY_GET(dyn, d_tag);
     dyn->value = ENJ_DYNAMIC_ENTRY_GET(dyn, d_un.d_val);
 
-    // Clear cached string value
-    if (dyn->cached_string)
-    {
-        enj_fstring_delete(dyn->cached_string);
-        dyn->cached_string = 0;
-    }
+    // Clear cached string value, keeping it to tell whether it changed
+    enj_fstring* cached_string = dyn->cached_string;
+    dyn->cached_string = 0;
 
     // Cache string value (if applicable)
     if (dyn->string)
@@ -108,16 +114,19 @@ int enj_dynamic_entry_update(enj_dynamic_entry* dyn, enj_error** err)
         if (string_ok)
         {
             char buffer[string_len];
-            if (enj_blob_read(elf->blob, dyn->string->pos, &buffer[0], string_len, err) < 0)
-                return -1;
-
-            dyn->cached_string = enj_fstring_create(&buffer[0], err);
-            if (!dyn->cached_string)
+            if (enj_blob_read(elf->blob, dyn->string->pos, &buffer[0], string_len, err) < 0 ||
+                !(dyn->cached_string = enj_fstring_create(&buffer[0], err)))
+            {
+                enj_fstring_delete(cached_string);
                 return -1;
+            }
         }
     }
 
-    return 0;
+    changed |= !enj_fstring_equal(cached_string, dyn->cached_string);
+    enj_fstring_delete(cached_string);
+
+    return changed;
 }
 
 int enj_dynamic_entry_push(enj_dynamic_entry* dyn, enj_error** err)
@@ -129,6 +138,9 @@ int enj_dynamic_entry_push(enj_dynamic_entry* dyn, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(dyn->dynamic->section->elf, err) < 0)
+        return -1;
+
     enj_elf* elf = dyn->dynamic->section->elf;
 
     ENJ_DYNAMIC_ENTRY_SET(dyn, d_tag, dyn->tag);
@@ -250,14 +262,18 @@ int enj_dynamic__update(enj_elf_shdr* section, enj_error** err)
     }
 
     enj_dynamic* dynamic = (enj_dynamic*) section->content;
+    int changed = 0;
 
     for (enj_dynamic_entry* dyn = dynamic->entries; dyn; dyn = dyn->next)
     {
-        if (enj_dynamic_entry_update(dyn, err) < 0)
+        int ret = enj_dynamic_entry_update(dyn, err);
+        if (ret < 0)
             return -1;
+
+        changed |= ret;
     }
 
-    return 0;
+    return changed;
 }
 
 int enj_dynamic__push(enj_elf_shdr* section, enj_error** err)
@@ -24,10 +24,14 @@
 #include "elfninja/core/symtab.h"
 #include "elfninja/core/note.h"
 #include "elfninja/core/dynamic.h"
+#include "elfninja/core/hash.h"
+#include "elfninja/core/reloc.h"
 
 #include <string.h>
 #include <unistd.h>
 #include <dlfcn.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 enj_elf* enj_elf_create_fd(int fd, enj_error** err)
 {
@@ -50,6 +54,9 @@ enj_elf* enj_elf_create_fd(int fd, enj_error** err)
         return 0;
     }
 
+    // Blob offsets are file offsets only when reading from the start
+    off_t origin = lseek(fd, 0, SEEK_CUR);
+
     unsigned char* buffer[elf->blob->chunk_size];
     ssize_t count;
     while ((count = read(fd, &buffer[0], elf->blob->chunk_size)) > 0)
@@ -70,6 +77,21 @@ enj_elf* enj_elf_create_fd(int fd, enj_error** err)
         return 0;
     }
 
+    // The blob is a copy of the file until edited
+    elf->source_fd = origin == 0 ? fd : 0;
+    elf->blob->dirty = 0;
+
+    // Track blob edits for traits
+    elf->listener.arg = elf;
+    elf->listener.o_edit = &enj_elf__edit;
+
+    if (enj_blob_add_listener(elf->blob, &elf->listener, err) < 0)
+    {
+        enj_blob_delete(elf->blob);
+        enj_free(elf);
+        return 0;
+    }
+
     if (enj_elf_pull(elf, err) < 0)
         return 0;
 
@@ -91,9 +113,14 @@ enj_elf* enj_elf_create_buffer(void const* buffer, size_t length, enj_error** er
         return 0;
     }
 
+    elf->listener.arg = elf;
+    elf->listener.o_edit = &enj_elf__edit;
+
     if (!(elf->blob = enj_blob_create(err)) ||
-        enj_blob_insert(elf->blob, 0, buffer, length, err) < 0)
+        enj_blob_insert(elf->blob, 0, buffer, length, err) < 0 ||
+        enj_blob_add_listener(elf->blob, &elf->listener, err) < 0)
     {
+        enj_blob_delete(elf->blob);
         enj_free(elf);
         return 0;
     }
@@ -109,6 +136,10 @@ void enj_elf_delete(enj_elf* elf)
     if (!elf)
         return;
 
+    // Deleting sections removes their anchors
+    elf->frozen = 0;
+    elf->blob->frozen = 0;
+
     for (enj_elf_shdr* section = elf->sections; section; )
     {
         enj_elf_shdr* next = section->next;
@@ -117,6 +148,7 @@ void enj_elf_delete(enj_elf* elf)
     }
 
     enj_blob_delete(elf->blob);
+    enj_free(elf->edits);
     enj_free(elf);
 }
 
@@ -128,6 +160,9 @@ int enj_elf_pull(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
     if (enj_elf_pull_header(elf, err) < 0)
         return -1;
 
@@ -152,6 +187,10 @@ int enj_elf_update(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    // The model cannot be out of date with a frozen blob
+    if (elf->frozen)
+        return 0;
+
     if (enj_elf_update_header(elf, err) < 0)
         return -1;
 
@@ -179,6 +218,9 @@ int enj_elf_push(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
     if (enj_elf_push_segments(elf, err) < 0)
         return -1;
 
@@ -197,6 +239,9 @@ int enj_elf_push(enj_elf* elf, enj_error** err)
 
 int enj_elf_pull_header(enj_elf* elf, enj_error** err)
 {
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
     return enj_elf_update_header(elf, err);
 }
 
@@ -208,6 +253,13 @@ int enj_elf_update_header(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    if (elf->frozen)
+        return 0;
+
+    // Only stamp the header when pulled values differ from the cached ones
+    int bits = elf->bits;
+    Elf64_Ehdr cached = elf->ehdr64;
+
     unsigned char e_ident[EI_NIDENT];
     if (enj_blob_read(elf->blob, 0, &e_ident[0], sizeof(e_ident), err) < 0)
     {
@@ -270,6 +322,9 @@ int enj_elf_update_header(enj_elf* elf, enj_error** err)
     if (!(elf->pht = enj_blob_new_cursor(elf->blob, pht_pos, pht_length, err)))
         return -1;
 
+    if (bits != elf->bits || memcmp(&cached, &elf->ehdr64, sizeof(Elf64_Ehdr)))
+        enj_elf__touch(elf, ENJ_ELF_DEP_HEADER);
+
     return 0;
 }
 
@@ -281,6 +336,9 @@ int enj_elf_push_header(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
     // Update program header table offset
     ENJ_ELF_EHDR_SET(elf, e_phoff, elf->pht->start->pos);
 
@@ -312,6 +370,20 @@ int enj_elf_push_header(enj_elf* elf, enj_error** err)
     return 0;
 }
 
+// Write a header only if it differs from the blob bytes ; returns 1 if it did
+static int _write_changed(enj_elf* elf, size_t pos, const void* ptr, size_t size, enj_error** err)
+{
+    unsigned char current[size];
+    if (enj_blob_read(elf->blob, pos, &current[0], size, enj_error_quiet()) == 0 &&
+        !memcmp(&current[0], ptr, size))
+        return 0;
+
+    if (enj_blob_write(elf->blob, pos, ptr, size, err) < 0)
+        return -1;
+
+    return 1;
+}
+
 int enj_elf_write_header(enj_elf* elf, enj_error** err)
 {
     if (!elf || !elf->bits)
@@ -320,16 +392,17 @@ int enj_elf_write_header(enj_elf* elf, enj_error** err)
         return -1;
     }
 
-    if (elf->bits == 32)
-    {
-        if (enj_blob_write(elf->blob, 0, &elf->ehdr32, sizeof(Elf32_Ehdr), err) < 0)
-            return -1;
-    }
-    else if (elf->bits == 64)
-    {
-        if (enj_blob_write(elf->blob, 0, &elf->ehdr64, sizeof(Elf64_Ehdr), err) < 0)
-            return -1;
-    }
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
+    int changed = elf->bits == 64 ?
+        _write_changed(elf, 0, &elf->ehdr64, sizeof(Elf64_Ehdr), err) :
+        _write_changed(elf, 0, &elf->ehdr32, sizeof(Elf32_Ehdr), err);
+
+    if (changed < 0)
+        return -1;
+    else if (changed)
+        enj_elf__touch(elf, ENJ_ELF_DEP_HEADER);
 
     return 0;
 }
@@ -342,6 +415,9 @@ int enj_elf_pull_sections(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
     // Delete existing sections, remove anchors
     for (enj_elf_shdr* section = elf->sections; section; )
     {
@@ -417,6 +493,8 @@ int enj_elf_pull_sections(enj_elf* elf, enj_error** err)
         } while (i < count);
     }
 
+    enj_elf__touch(elf, ENJ_ELF_DEP_SECTIONS);
+
     return 0;
 }
 
@@ -428,6 +506,9 @@ int enj_elf_update_sections(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    if (elf->frozen)
+        return 0;
+
     for (enj_elf_shdr* section = elf->sections; section; section = section->next)
     {
         if (enj_elf_shdr_update(section, err) < 0)
@@ -445,6 +526,9 @@ int enj_elf_push_sections(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
     for (enj_elf_shdr* section = elf->sections; section; section = section->next)
     {
         if (enj_elf_shdr_push(section, err) < 0)
@@ -454,6 +538,159 @@ int enj_elf_push_sections(enj_elf* elf, enj_error** err)
     return 0;
 }
 
+// Thread count used by enj_elf_pull_contents
+static size_t _pull_threads = 1;
+
+// Sections are staged in slices of about this size
+#define PULL_PART_SIZE (64 * 1024)
+
+void enj_elf_set_pull_threads(size_t threads)
+{
+    _pull_threads = threads ? threads : 1;
+}
+
+typedef struct _pull_job
+{
+    enj_elf_shdr* section;
+    size_t part;
+    size_t parts;
+    void** stage;
+    enj_error* err;
+} _pull_job;
+
+typedef struct _pull_pool
+{
+    _pull_job* jobs;
+    size_t job_count;
+    atomic_size_t next;
+} _pull_pool;
+
+static void* _pull_worker(void* arg)
+{
+    _pull_pool* pool = (_pull_pool*) arg;
+
+    size_t i;
+    while ((i = atomic_fetch_add(&pool->next, 1)) < pool->job_count)
+    {
+        _pull_job* job = &pool->jobs[i];
+        (*job->section->content_view->o_stage)(job->section, job->part, job->parts, job->stage, &job->err);
+    }
+
+    return 0;
+}
+
+static size_t _pull_parts(enj_elf_shdr* section, size_t threads)
+{
+    enj_elf_content_view* view = section->content_view;
+    if (!view || !view->o_stage || !view->o_commit || !view->o_discard)
+        return 0;
+
+    size_t parts = ENJ_ELF_SHDR_GET(section, sh_size) / PULL_PART_SIZE;
+
+    if (parts < 1)
+        parts = 1;
+    if (parts > 4 * threads)
+        parts = 4 * threads;
+
+    return parts;
+}
+
+// Run the stages of all sections that support it over several threads ; gives
+//  back one stage per job, in section order, or none if staging is not worth it
+static int _pull_stage(enj_elf* elf, size_t threads, void*** stages_out, size_t* count_out, enj_error** err)
+{
+    size_t job_count = 0;
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+        job_count += _pull_parts(section, threads);
+
+    *stages_out = 0;
+    *count_out = 0;
+
+    if (job_count < 2)
+        return 0;
+
+    _pull_pool pool;
+    pool.jobs = enj_malloc(job_count * sizeof(_pull_job));
+    pool.job_count = job_count;
+    atomic_init(&pool.next, 0);
+
+    void** stages = enj_malloc(job_count * sizeof(void*));
+
+    if (!pool.jobs || !stages)
+    {
+        enj_free(pool.jobs);
+        enj_free(stages);
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    size_t j = 0;
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        size_t parts = _pull_parts(section, threads);
+
+        for (size_t p = 0; p < parts; ++p, ++j)
+        {
+            pool.jobs[j].section = section;
+            pool.jobs[j].part = p;
+            pool.jobs[j].parts = parts;
+            pool.jobs[j].stage = &stages[j];
+            pool.jobs[j].err = 0;
+        }
+    }
+
+    // The calling thread takes its share of the jobs
+    if (threads > job_count)
+        threads = job_count;
+
+    pthread_t workers[threads];
+    size_t started = 0;
+
+    for (; started + 1 < threads; ++started)
+    {
+        if (pthread_create(&workers[started], 0, &_pull_worker, &pool))
+            break;
+    }
+
+    _pull_worker(&pool);
+
+    for (size_t i = 0; i < started; ++i)
+        pthread_join(workers[i], 0);
+
+    // Report the first error, in section order
+    int ret = 0;
+    for (size_t i = 0; i < job_count; ++i)
+    {
+        if (!pool.jobs[i].err)
+            continue;
+
+        if (!ret)
+        {
+            enj_error_wrap(err, ENJ_ERR_INTERNAL, pool.jobs[i].err);
+            ret = -1;
+        }
+        else
+            enj_error_delete(pool.jobs[i].err);
+    }
+
+    if (ret < 0)
+    {
+        for (size_t i = 0; i < job_count; ++i)
+            (*pool.jobs[i].section->content_view->o_discard)(stages[i]);
+
+        enj_free(stages);
+        enj_free(pool.jobs);
+        return -1;
+    }
+
+    enj_free(pool.jobs);
+
+    *stages_out = stages;
+    *count_out = job_count;
+
+    return 0;
+}
+
 int enj_elf_pull_contents(enj_elf* elf, enj_error** err)
 {
     if (!elf)
@@ -462,16 +699,57 @@ int enj_elf_pull_contents(enj_elf* elf, enj_error** err)
         return -1;
     }
 
-    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
+    void** stages = 0;
+    size_t stage_count = 0;
+
+    if (_pull_threads > 1 && _pull_stage(elf, _pull_threads, &stages, &stage_count, err) < 0)
+        return -1;
+
+    enj_elf_shdr* section = elf->sections;
+    size_t j = 0;
+    int ret = 0;
+
+    for (; section; section = section->next)
     {
-        if (section->content_view && section->content_view->o_pull &&
-           (*section->content_view->o_pull)(section, err) < 0)
+        enj_elf_content_view* view = section->content_view;
+
+        // Staged sections have their parts next to each other
+        size_t parts = stage_count ? _pull_parts(section, _pull_threads) : 0;
+
+        if (parts)
         {
-            return -1;
+            ret = (*view->o_commit)(section, &stages[j], parts, err);
+            j += parts;
         }
+        else if (view && view->o_pull)
+        {
+            ret = (*view->o_pull)(section, err);
+        }
+
+        if (ret < 0)
+            break;
+
+        if (view)
+            enj_elf__touch_content(section);
     }
 
-    return 0;
+    // Release the stages of the sections left behind by an error
+    if (section && stage_count)
+    {
+        for (section = section->next; section; section = section->next)
+        {
+            size_t parts = _pull_parts(section, _pull_threads);
+
+            for (size_t p = 0; p < parts; ++p, ++j)
+                (*section->content_view->o_discard)(stages[j]);
+        }
+    }
+
+    enj_free(stages);
+    return ret;
 }
 
 int enj_elf_update_contents(enj_elf* elf, enj_error** err)
@@ -482,19 +760,45 @@ int enj_elf_update_contents(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    if (elf->frozen)
+        return 0;
+
+    // Views return 1 when a refreshed value differs from the cached one
     for (enj_elf_shdr* section = elf->sections; section; section = section->next)
     {
-        if (section->content_view && section->content_view->o_update &&
-            section->content &&
-           (*section->content_view->o_update)(section, err) < 0)
-        {
+        int ret = 0;
+        if (section->content_view && section->content_view->o_update && section->content)
+            ret = (*section->content_view->o_update)(section, err);
+
+        if (ret < 0)
             return -1;
-        }
+        else if (ret)
+            enj_elf__touch_content(section);
     }
 
     return 0;
 }
 
+static unsigned char* _read_data(enj_elf_shdr* section, enj_error** err)
+{
+    size_t length = section->data ? section->data->length : 0;
+
+    unsigned char* data = enj_malloc(length + 1);
+    if (!data)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return 0;
+    }
+
+    if (length && enj_blob_read(section->elf->blob, section->data->start->pos, data, length, err) < 0)
+    {
+        enj_free(data);
+        return 0;
+    }
+
+    return data;
+}
+
 int enj_elf_push_contents(enj_elf* elf, enj_error** err)
 {
     if (!elf)
@@ -503,14 +807,48 @@ int enj_elf_push_contents(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
     for (enj_elf_shdr* section = elf->sections; section; section = section->next)
     {
-        if (section->content_view && section->content_view->o_push &&
-            section->content &&
-           (*section->content_view->o_push)(section, err) < 0)
+        if (!section->content_view || !section->content_view->o_push || !section->content)
+            continue;
+
+        // Only stamp the contents when the push changed the section bytes
+        size_t stamp = elf->stamps[ENJ_ELF_DEP_BLOB];
+        unsigned char* cached = _read_data(section, err);
+        if (!cached)
+            return -1;
+
+        size_t length = section->data ? section->data->length : 0;
+
+        if ((*section->content_view->o_push)(section, err) < 0)
         {
+            enj_free(cached);
             return -1;
         }
+
+        int changed = stamp != elf->stamps[ENJ_ELF_DEP_BLOB] ||
+                      length != (section->data ? section->data->length : 0);
+
+        if (!changed && length)
+        {
+            unsigned char* pushed = _read_data(section, err);
+            if (!pushed)
+            {
+                enj_free(cached);
+                return -1;
+            }
+
+            changed = memcmp(cached, pushed, length) != 0;
+            enj_free(pushed);
+        }
+
+        enj_free(cached);
+
+        if (changed)
+            enj_elf__touch_content(section);
     }
 
     return 0;
@@ -524,6 +862,9 @@ int enj_elf_pull_segments(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
     // Delete existing segments, remove anchors
     for (enj_elf_phdr* segment = elf->segments; segment; )
     {
@@ -573,6 +914,8 @@ int enj_elf_pull_segments(enj_elf* elf, enj_error** err)
         elf->last_segment = segment;
     }
 
+    enj_elf__touch(elf, ENJ_ELF_DEP_SEGMENTS);
+
     return 0;
 }
 
@@ -584,6 +927,9 @@ int enj_elf_update_segments(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    if (elf->frozen)
+        return 0;
+
     for (enj_elf_phdr* segment = elf->segments; segment; segment = segment->next)
     {
         if (enj_elf_phdr_update(segment, err) < 0)
@@ -601,6 +947,9 @@ int enj_elf_push_segments(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
     for (enj_elf_phdr* segment = elf->segments; segment; segment = segment->next)
     {
         if (enj_elf_phdr_push(segment, err) < 0)
@@ -610,6 +959,40 @@ int enj_elf_push_segments(enj_elf* elf, enj_error** err)
     return 0;
 }
 
+// Get the dependencies of a trait that changed since it was last built
+static int _trait_changes(enj_elf_trait* trait)
+{
+    enj_elf* elf = trait->elf;
+    int deps = trait->deps ? trait->deps : ENJ_ELF_DEP_ALL;
+    int changes = 0;
+
+    for (int i = 0; i < ENJ_ELF_DEP_COUNT; ++i)
+    {
+        if ((deps & (1 << i)) && elf->stamps[i] > trait->generation)
+            changes |= 1 << i;
+    }
+
+    // Only look at the contents of the sections using the right view
+    if ((changes & ENJ_ELF_DEP_CONTENTS) && trait->content_tag)
+    {
+        changes &= ~ENJ_ELF_DEP_CONTENTS;
+
+        for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+        {
+            if (section->content_view && section->content_view->tag == trait->content_tag &&
+                section->generation > trait->generation)
+            {
+                changes |= ENJ_ELF_DEP_CONTENTS;
+                break;
+            }
+        }
+    }
+
+    return changes;
+}
+
+// Rebuild the traits whose dependencies changed ; when only the blob was
+//  edited, patchable traits are given the pending edits instead
 int enj_elf_build_traits(enj_elf* elf, enj_error** err)
 {
     if (!elf)
@@ -618,15 +1001,92 @@ int enj_elf_build_traits(enj_elf* elf, enj_error** err)
         return -1;
     }
 
+    if (elf->frozen)
+        return 0;
+
     for (enj_elf_trait* trait = elf->traits; trait; trait = trait->next)
     {
-        if (trait->o_build &&
+        int changes = _trait_changes(trait);
+        if (!changes)
+            continue;
+
+        size_t generation = elf->generation;
+        int build = 1;
+
+        if (changes == ENJ_ELF_DEP_BLOB && trait->o_patch)
+        {
+            build = 0;
+
+            for (size_t i = 0; i < elf->edit_count && !build; ++i)
+            {
+                enj_elf_edit* edit = &elf->edits[i];
+                if (edit->generation <= trait->generation)
+                    continue;
+
+                int ret = (*trait->o_patch)(trait->arg, edit->edit, edit->start, edit->length, err);
+                if (ret < 0)
+                    return -1;
+
+                build = ret > 0;
+            }
+        }
+
+        if (build && trait->o_build &&
            (*trait->o_build)(trait->arg, err) < 0)
         {
             return -1;
         }
+
+        trait->generation = generation;
+    }
+
+    // Drop the edits every patchable trait has seen
+    size_t oldest = elf->generation;
+    for (enj_elf_trait* trait = elf->traits; trait; trait = trait->next)
+    {
+        if (trait->o_patch && trait->generation < oldest)
+            oldest = trait->generation;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < elf->edit_count; ++i)
+    {
+        if (elf->edits[i].generation > oldest)
+            elf->edits[count++] = elf->edits[i];
+    }
+    elf->edit_count = count;
+
+    return 0;
+}
+
+// Make the object read-only : state built lazily by queries is built now, and
+//  every later edit fails with ENJ_ERR_FROZEN. Query functions and the dump
+//  formatters can then be called from several threads at once.
+int enj_elf_freeze(enj_elf* elf, enj_error** err)
+{
+    if (!elf)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (elf->frozen)
+        return 0;
+
+    if (enj_elf_build_traits(elf, err) < 0)
+        return -1;
+
+    // Hash lookups index the symbol table on first use
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        if (section->content_view && section->content_view->tag == ENJ_ELF_HASH && section->content &&
+            enj_hash__index((enj_hash*) section->content, err) < 0)
+            return -1;
     }
 
+    elf->frozen = 1;
+    elf->blob->frozen = 1;
+
     return 0;
 }
 
@@ -677,6 +1137,9 @@ enj_elf_shdr* enj_elf_new_shdr(enj_elf* elf, int type, const char* name, enj_err
         return 0;
     }
 
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return 0;
+
     // Get new section index
     size_t index = 0;
     for (enj_elf_shdr* section = elf->sections; section/* && section->next*/; section = section->next)
@@ -805,6 +1268,9 @@ enj_elf_phdr* enj_elf_new_phdr(enj_elf* elf, int type, enj_error** err)
         return 0;
     }
 
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return 0;
+
     // Get new segment index
     size_t index = 0;
     for (enj_elf_phdr* segment = elf->segments; segment/* && segment->next*/; segment = segment->next)
@@ -882,6 +1348,13 @@ int enj_elf_shdr_pull(enj_elf_shdr* section, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(section->elf, err) < 0)
+        return -1;
+
+    Elf64_Shdr cached = section->shdr64;
+    size_t cached_pos = section->data ? section->data->start->pos : 0;
+    size_t cached_length = section->data ? section->data->length : 0;
+
     // Read section header
     if (section->elf->bits == 32)
     {
@@ -923,6 +1396,11 @@ int enj_elf_shdr_pull(enj_elf_shdr* section, enj_error** err)
     if (!(section->name = enj_blob_new_anchor(section->elf->blob, name_off, err)))
         return -1;
 
+    if (memcmp(&cached, &section->shdr64, sizeof(Elf64_Shdr)) ||
+        cached_pos != (section->data ? section->data->start->pos : 0) ||
+        cached_length != (section->data ? section->data->length : 0))
+        enj_elf__touch(section->elf, ENJ_ELF_DEP_SECTIONS);
+
     if (enj_elf_shdr_update(section, err) < 0)
         return -1;
 
@@ -937,16 +1415,17 @@ int enj_elf_shdr_update(enj_elf_shdr* section, enj_error** err)
         return -1;
     }
 
-    // Update section name
+    if (section->elf->frozen)
+        return 0;
+
+    // Update section name, keeping the cached one to tell whether it changed
+    enj_fstring* cached_name = section->cached_name;
+    enj_elf_content_view* cached_view = section->content_view;
+
     if (section->elf->shstrtab)
     {
         size_t name_off = section->name->pos;
-
-        if (section->cached_name)
-        {
-            enj_fstring_delete(section->cached_name);
-            section->cached_name = 0;
-        }
+        section->cached_name = 0;
 
         int name_ok = 1;
         size_t name_len = 0;
@@ -965,17 +1444,21 @@ int enj_elf_shdr_update(enj_elf_shdr* section, enj_error** err)
         if (name_ok)
         {
             char buffer[name_len];
-            if (enj_blob_read(section->elf->blob, name_off, &buffer[0], name_len, err) < 0)
-                return -1;
-
-            section->cached_name = enj_fstring_create(&buffer[0], err);
-            if (!section->cached_name)
+            if (enj_blob_read(section->elf->blob, name_off, &buffer[0], name_len, err) < 0 ||
+                !(section->cached_name = enj_fstring_create(&buffer[0], err)))
+            {
+                enj_fstring_delete(cached_name);
                 return -1;
+            }
         }
     }
     else
         section->name = 0;
 
+    int renamed = !enj_fstring_equal(cached_name, section->cached_name);
+    if (cached_name != section->cached_name)
+        enj_fstring_delete(cached_name);
+
     size_t shtype = ENJ_ELF_SHDR_GET(section, sh_type);
 
     // Update content view if the section type changed
@@ -990,8 +1473,14 @@ int enj_elf_shdr_update(enj_elf_shdr* section, enj_error** err)
 
         if (enj_elf__get_content_view(section, &section->content_view, err) < 0)
             return -1;
+
+        if (section->content_view != cached_view)
+            enj_elf__touch_content(section);
     }
 
+    if (renamed || section->content_view != cached_view)
+        enj_elf__touch(section->elf, ENJ_ELF_DEP_SECTIONS);
+
     return 0;
 }
 
@@ -1003,6 +1492,9 @@ int enj_elf_shdr_push(enj_elf_shdr* section, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(section->elf, err) < 0)
+        return -1;
+
     // Update data pointers
     if (section->data)
     {
@@ -1028,16 +1520,17 @@ int enj_elf_shdr_write(enj_elf_shdr* section, enj_error** err)
         return -1;
     }
 
-    if (section->elf->bits == 32)
-    {
-        if (enj_blob_write(section->elf->blob, section->header->pos, &section->shdr32, sizeof(Elf32_Shdr), err) < 0)
-            return -1;
-    }
-    else if (section->elf->bits == 64)
-    {
-        if (enj_blob_write(section->elf->blob, section->header->pos, &section->shdr64, sizeof(Elf64_Shdr), err) < 0)
-            return -1;
-    }
+    if (enj_elf__check_frozen(section->elf, err) < 0)
+        return -1;
+
+    int changed = section->elf->bits == 64 ?
+        _write_changed(section->elf, section->header->pos, &section->shdr64, sizeof(Elf64_Shdr), err) :
+        _write_changed(section->elf, section->header->pos, &section->shdr32, sizeof(Elf32_Shdr), err);
+
+    if (changed < 0)
+        return -1;
+    else if (changed)
+        enj_elf__touch(section->elf, ENJ_ELF_DEP_SECTIONS);
 
     return 0;
 }
@@ -1050,6 +1543,9 @@ int enj_elf_shdr_rename(enj_elf_shdr* section, const char* name, enj_error** err
         return -1;
     }
 
+    if (enj_elf__check_frozen(section->elf, err) < 0)
+        return -1;
+
     if (!section->elf->shstrtab)
     {
         enj_error_put(err, ENJ_ERR_NO_STRTAB);
@@ -1088,6 +1584,11 @@ int enj_elf_shdr_remove(enj_elf_shdr* section, int mode, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(section->elf, err) < 0)
+        return -1;
+
+    enj_elf__touch(section->elf, ENJ_ELF_DEP_SECTIONS);
+
     // First of all, take care of the section name
     if (section->elf->shstrtab && section->cached_name)
     {
@@ -1193,6 +1694,11 @@ int enj_elf_shdr_swap(enj_elf_shdr* section, int index, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(section->elf, err) < 0)
+        return -1;
+
+    enj_elf__touch(section->elf, ENJ_ELF_DEP_SECTIONS);
+
     enj_elf_shdr* other = enj_elf_find_shdr_by_index(section->elf, index, err);
     if (!other || other == section)
     {
@@ -1248,6 +1754,11 @@ int enj_elf_shdr_move(enj_elf_shdr* section, int index, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(section->elf, err) < 0)
+        return -1;
+
+    enj_elf__touch(section->elf, ENJ_ELF_DEP_SECTIONS);
+
     if (!enj_elf_find_shdr_by_index(section->elf, index, err) || index == section->index)
     {
         if (!*err)
@@ -1280,6 +1791,148 @@ int enj_elf_shdr_move(enj_elf_shdr* section, int index, enj_error** err)
     return 0;
 }
 
+int enj_elf_shdr_reorder(enj_elf* elf, enj_elf_shdr** order, size_t count, enj_error** err)
+{
+    if (!elf || !order || !count)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
+    enj_elf__touch(elf, ENJ_ELF_DEP_SECTIONS);
+
+    size_t num_sections = 0;
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+        ++num_sections;
+
+    if (count != num_sections)
+    {
+        enj_error_put(err, ENJ_ERR_BAD_INDEX);
+        return -1;
+    }
+
+    // Build the old index -> new index map, checking that the order is a permutation
+    size_t* map = enj_malloc(count * sizeof(size_t));
+    enj_blob_anchor** headers = enj_malloc(count * sizeof(enj_blob_anchor*));
+    if (!map || !headers)
+    {
+        enj_free(map);
+        enj_free(headers);
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        map[i] = count;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!order[i] || order[i]->elf != elf || order[i]->index >= count || map[order[i]->index] != count ||
+            (!i && order[i]->index))
+        {
+            enj_free(map);
+            enj_free(headers);
+            enj_error_put(err, ENJ_ERR_BAD_INDEX);
+            return -1;
+        }
+
+        map[order[i]->index] = i;
+        headers[order[i]->index] = order[i]->header;
+    }
+
+    // Symbols can only refer to sections that keep a direct index
+    for (size_t i = 0; i < count && i < SHN_LORESERVE; ++i)
+    {
+        if (map[i] >= SHN_LORESERVE)
+        {
+            enj_free(map);
+            enj_free(headers);
+            enj_error_put(err, ENJ_ERR_BAD_INDEX);
+            return -1;
+        }
+    }
+
+    // Update section links
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        size_t link = ENJ_ELF_SHDR_GET(section, sh_link);
+        if (link && link < count)
+            ENJ_ELF_SHDR_SET(section, sh_link, map[link]);
+
+        // Also update sh_info if it contains a section index (relocation sections
+        //  may not have SHF_INFO_LINK set)
+        size_t type = ENJ_ELF_SHDR_GET(section, sh_type);
+        size_t flags = ENJ_ELF_SHDR_GET(section, sh_flags);
+        if ((flags & SHF_INFO_LINK) || type == SHT_REL || type == SHT_RELA)
+        {
+            size_t info = ENJ_ELF_SHDR_GET(section, sh_info);
+            if (info && info < count)
+                ENJ_ELF_SHDR_SET(section, sh_info, map[info]);
+        }
+
+        // Update symbols section indices
+        if (section->content_view && section->content_view->tag == ENJ_ELF_SYMTAB && section->content)
+        {
+            enj_symtab* symtab = (enj_symtab*) section->content;
+
+            for (enj_symbol* sym = symtab->symbols; sym; sym = sym->next)
+            {
+                size_t shndx = ENJ_SYMBOL_GET(sym, st_shndx);
+                if (shndx && shndx < SHN_LORESERVE && shndx < count)
+                    ENJ_SYMBOL_SET(sym, st_shndx, map[shndx]);
+            }
+        }
+
+        // Update group members and extended symbol section indices
+        if ((type == SHT_GROUP || type == SHT_SYMTAB_SHNDX) && section->data)
+        {
+            size_t start = type == SHT_GROUP ? sizeof(Elf32_Word) : 0;
+
+            for (size_t pos = start; pos + sizeof(Elf32_Word) <= section->data->length; pos += sizeof(Elf32_Word))
+            {
+                Elf32_Word member;
+                if (enj_blob_read(elf->blob, section->data->start->pos + pos, &member, sizeof(Elf32_Word), err) < 0)
+                    goto fail;
+
+                if (member && member < count)
+                {
+                    member = map[member];
+                    if (enj_blob_write(elf->blob, section->data->start->pos + pos, &member, sizeof(Elf32_Word), err) < 0)
+                        goto fail;
+                }
+            }
+        }
+    }
+
+    size_t shstrndx = ENJ_ELF_EHDR_GET(elf, e_shstrndx);
+    if (shstrndx && shstrndx < count && shstrndx != SHN_XINDEX)
+        ENJ_ELF_EHDR_SET(elf, e_shstrndx, map[shstrndx]);
+
+    // Hand section header slots over, and keep the section list in index order
+    for (size_t i = 0; i < count; ++i)
+    {
+        order[i]->header = headers[i];
+        order[i]->index = i;
+        order[i]->prev = i ? order[i - 1] : 0;
+        order[i]->next = i + 1 < count ? order[i + 1] : 0;
+    }
+
+    elf->sections = order[0];
+    elf->last_section = order[count - 1];
+
+    enj_free(map);
+    enj_free(headers);
+    return 0;
+
+fail:
+    enj_free(map);
+    enj_free(headers);
+    return -1;
+}
+
 int enj_elf_phdr_pull(enj_elf_phdr* segment, enj_error** err)
 {
     if (!segment || !segment->elf || !segment->elf->bits)
@@ -1288,6 +1941,11 @@ int enj_elf_phdr_pull(enj_elf_phdr* segment, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(segment->elf, err) < 0)
+        return -1;
+
+    Elf64_Phdr cached = segment->phdr64;
+
     // Read segment header
     if (segment->elf->bits == 32)
     {
@@ -1312,6 +1970,9 @@ int enj_elf_phdr_pull(enj_elf_phdr* segment, enj_error** err)
     if (!(segment->data = enj_blob_new_cursor(segment->elf->blob, offset, size, err)))
         return -1;
 
+    if (memcmp(&cached, &segment->phdr64, sizeof(Elf64_Phdr)))
+        enj_elf__touch(segment->elf, ENJ_ELF_DEP_SEGMENTS);
+
     return 0;
 }
 
@@ -1323,6 +1984,8 @@ int enj_elf_phdr_update(enj_elf_phdr* segment, enj_error** err)
         return -1;
     }
 
+    // Segments cache nothing from the blob ; their headers are stamped when
+    //  pulled or written
     return 0;
 }
 
@@ -1334,6 +1997,9 @@ int enj_elf_phdr_push(enj_elf_phdr* segment, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(segment->elf, err) < 0)
+        return -1;
+
     // Update data pointers
     if (segment->data)
     {
@@ -1353,17 +2019,6 @@ int enj_elf_phdr_push(enj_elf_phdr* segment, enj_error** err)
     }
 
     // Then, write back the updated header
-    if (segment->elf->bits == 32)
-    {
-        if (enj_blob_write(segment->elf->blob, segment->header->pos, &segment->phdr32, sizeof(Elf32_Phdr), err) < 0)
-            return -1;
-    }
-    else if (segment->elf->bits == 64)
-    {
-        if (enj_blob_write(segment->elf->blob, segment->header->pos, &segment->phdr64, sizeof(Elf64_Phdr), err) < 0)
-            return -1;
-    }
-
     if (enj_elf_phdr_write(segment, err) < 0)
         return -1;
 
@@ -1378,16 +2033,17 @@ int enj_elf_phdr_write(enj_elf_phdr* segment, enj_error** err)
         return -1;
     }
 
-    if (segment->elf->bits == 32)
-    {
-        if (enj_blob_write(segment->elf->blob, segment->header->pos, &segment->phdr32, sizeof(Elf32_Phdr), err) < 0)
-            return -1;
-    }
-    else if (segment->elf->bits == 64)
-    {
-        if (enj_blob_write(segment->elf->blob, segment->header->pos, &segment->phdr64, sizeof(Elf64_Phdr), err) < 0)
-            return -1;
-    }
+    if (enj_elf__check_frozen(segment->elf, err) < 0)
+        return -1;
+
+    int changed = segment->elf->bits == 64 ?
+        _write_changed(segment->elf, segment->header->pos, &segment->phdr64, sizeof(Elf64_Phdr), err) :
+        _write_changed(segment->elf, segment->header->pos, &segment->phdr32, sizeof(Elf32_Phdr), err);
+
+    if (changed < 0)
+        return -1;
+    else if (changed)
+        enj_elf__touch(segment->elf, ENJ_ELF_DEP_SEGMENTS);
 
     return 0;
 }
@@ -1400,6 +2056,11 @@ int enj_elf_phdr_remove(enj_elf_phdr* segment, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(segment->elf, err) < 0)
+        return -1;
+
+    enj_elf__touch(segment->elf, ENJ_ELF_DEP_SEGMENTS);
+
     // Shift other segment indices
     for (enj_elf_phdr* other = segment->elf->segments; other; other = other->next)
     {
@@ -1440,6 +2101,11 @@ int enj_elf_phdr_swap(enj_elf_phdr* segment, int index, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(segment->elf, err) < 0)
+        return -1;
+
+    enj_elf__touch(segment->elf, ENJ_ELF_DEP_SEGMENTS);
+
     enj_elf_phdr* other = enj_elf_find_phdr_by_index(segment->elf, index, err);
     if (!other || other == segment)
     {
@@ -1468,6 +2134,11 @@ int enj_elf_phdr_move(enj_elf_phdr* segment, int index, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(segment->elf, err) < 0)
+        return -1;
+
+    enj_elf__touch(segment->elf, ENJ_ELF_DEP_SEGMENTS);
+
     if (!enj_elf_find_shdr_by_index(segment->elf, index, err) || index == segment->index)
     {
         if (!*err)
@@ -1508,7 +2179,11 @@ int enj_elf_add_trait(enj_elf* elf, enj_elf_trait* trait, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(elf, err) < 0)
+        return -1;
+
     trait->elf = elf;
+    trait->generation = elf->generation;
 
     trait->prev = elf->last_trait;
     trait->next = 0;
@@ -1529,6 +2204,9 @@ int enj_elf_trait_remove(enj_elf_trait* trait, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(trait->elf, err) < 0)
+        return -1;
+
     if (trait->prev)
         trait->prev->next = trait->next;
     else
@@ -1544,6 +2222,84 @@ int enj_elf_trait_remove(enj_elf_trait* trait, enj_error** err)
     return 0;
 }
 
+int enj_elf__check_frozen(enj_elf* elf, enj_error** err)
+{
+    if (!elf)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (elf->frozen)
+    {
+        enj_error_put(err, ENJ_ERR_FROZEN);
+        return -1;
+    }
+
+    return 0;
+}
+
+void enj_elf__touch(enj_elf* elf, int deps)
+{
+    ++elf->generation;
+
+    for (int i = 0; i < ENJ_ELF_DEP_COUNT; ++i)
+    {
+        if (deps & (1 << i))
+            elf->stamps[i] = elf->generation;
+    }
+}
+
+void enj_elf__touch_content(enj_elf_shdr* section)
+{
+    enj_elf__touch(section->elf, ENJ_ELF_DEP_CONTENTS);
+    section->generation = section->elf->generation;
+}
+
+int enj_elf__edit(void* arg, int edit, size_t start, size_t length, enj_error** err)
+{
+    enj_elf* elf = (enj_elf*) arg;
+
+    if (!elf)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enj_elf__touch(elf, ENJ_ELF_DEP_BLOB);
+
+    // Only log edits when some trait can apply them
+    int patchable = 0;
+    for (enj_elf_trait* trait = elf->traits; trait && !patchable; trait = trait->next)
+        patchable = trait->o_patch != 0;
+
+    if (!patchable)
+        return 0;
+
+    if (elf->edit_count == elf->edit_capacity)
+    {
+        size_t capacity = elf->edit_capacity ? 2 * elf->edit_capacity : 16;
+
+        enj_elf_edit* edits = enj_realloc(elf->edits, capacity * sizeof(enj_elf_edit));
+        if (!edits)
+        {
+            enj_error_put(err, ENJ_ERR_MALLOC);
+            return -1;
+        }
+
+        elf->edits = edits;
+        elf->edit_capacity = capacity;
+    }
+
+    enj_elf_edit* entry = &elf->edits[elf->edit_count++];
+    entry->edit = edit;
+    entry->start = start;
+    entry->length = length;
+    entry->generation = elf->generation;
+
+    return 0;
+}
+
 int enj_elf__shdr_delete(enj_elf_shdr* section, enj_error** err)
 {
     if (!section || !section->elf)
@@ -1615,7 +2371,10 @@ int enj_elf__get_content_view(enj_elf_shdr* section, enj_elf_content_view** view
         &enj_symtab__pull,
         &enj_symtab__update,
         &enj_symtab__push,
-        &enj_symtab__delete
+        &enj_symtab__delete,
+        &enj_symtab__stage,
+        &enj_symtab__commit,
+        &enj_symtab__discard
     };
 
     static enj_elf_content_view dynsym =
@@ -1625,7 +2384,10 @@ int enj_elf__get_content_view(enj_elf_shdr* section, enj_elf_content_view** view
         &enj_symtab__pull,
         &enj_symtab__update,
         &enj_symtab__push,
-        &enj_symtab__delete
+        &enj_symtab__delete,
+        &enj_symtab__stage,
+        &enj_symtab__commit,
+        &enj_symtab__discard
     };
 
     static enj_elf_content_view nsect =
@@ -1648,6 +2410,46 @@ int enj_elf__get_content_view(enj_elf_shdr* section, enj_elf_content_view** view
         &enj_dynamic__delete
     };
 
+    static enj_elf_content_view hash =
+    {
+        ENJ_ELF_HASH,
+        SHT_HASH,
+        &enj_hash__pull,
+        &enj_hash__update,
+        &enj_hash__push,
+        &enj_hash__delete
+    };
+
+    static enj_elf_content_view gnu_hash =
+    {
+        ENJ_ELF_HASH,
+        SHT_GNU_HASH,
+        &enj_hash__pull,
+        &enj_hash__update,
+        &enj_hash__push,
+        &enj_hash__delete
+    };
+
+    static enj_elf_content_view rel =
+    {
+        ENJ_ELF_RELOC,
+        SHT_REL,
+        &enj_reloc__pull,
+        &enj_reloc__update,
+        &enj_reloc__push,
+        &enj_reloc__delete
+    };
+
+    static enj_elf_content_view rela =
+    {
+        ENJ_ELF_RELOC,
+        SHT_RELA,
+        &enj_reloc__pull,
+        &enj_reloc__update,
+        &enj_reloc__push,
+        &enj_reloc__delete
+    };
+
     size_t sh_type = ENJ_ELF_SHDR_GET(section, sh_type);
 
     switch (sh_type)
@@ -1667,6 +2469,22 @@ int enj_elf__get_content_view(enj_elf_shdr* section, enj_elf_content_view** view
         case SHT_DYNAMIC:
             *view = &dynamic;
             return 0;
+
+        case SHT_HASH:
+            *view = &hash;
+            return 0;
+
+        case SHT_GNU_HASH:
+            *view = &gnu_hash;
+            return 0;
+
+        case SHT_REL:
+            *view = &rel;
+            return 0;
+
+        case SHT_RELA:
+            *view = &rela;
+            return 0;
     }
 
     *view = 0;
@@ -23,12 +23,70 @@
 #include <stdio.h>
 #include <string.h>
 
-static enj_error int_error =
+// Fallback when an error cannot be allocated ; thread-local, as it gets
+//  written with the location of the error
+static _Thread_local enj_error int_error =
 {
     ENJ_ERR_INTERNAL,
     0
 };
 
+// Ring of code-only error slots, see enj_error_quiet()
+#define QUIET_SLOTS 8
+
+typedef struct
+{
+    enj_error* slot;
+    enj_error error;
+} _quiet_entry;
+
+static _Thread_local _quiet_entry quiet_ring[QUIET_SLOTS];
+static _Thread_local size_t quiet_next = 0;
+
+static enj_error* _quiet_error(enj_error** err)
+{
+    for (size_t i = 0; i < QUIET_SLOTS; ++i)
+    {
+        if (err == &quiet_ring[i].slot)
+            return &quiet_ring[i].error;
+    }
+
+    return 0;
+}
+
+static void _quiet_put(enj_error** err, enj_error* quiet, int code, int posix_errno,
+                       const char* function, size_t line, const char* file)
+{
+    quiet->code = code;
+    quiet->posix_errno = posix_errno;
+    quiet->wrap = 0;
+    quiet->function = function;
+    quiet->line = line;
+    quiet->file = file;
+
+    *err = quiet;
+}
+
+enj_error** enj_error_quiet()
+{
+    _quiet_entry* entry = &quiet_ring[quiet_next];
+    quiet_next = (quiet_next + 1) % QUIET_SLOTS;
+
+    entry->slot = 0;
+    return &entry->slot;
+}
+
+int enj_error_is_quiet(const enj_error* err)
+{
+    for (size_t i = 0; i < QUIET_SLOTS; ++i)
+    {
+        if (err == &quiet_ring[i].error)
+            return 1;
+    }
+
+    return 0;
+}
+
 enj_error* enj_error_create(int code)
 {
     enj_error* err = enj_malloc(sizeof(enj_error));
@@ -109,10 +167,10 @@ enj_error* enj_error_create_wrap(int code, enj_error* wrap)
 
 void enj_error_delete(enj_error* err)
 {
-    if (!err || err == &int_error)
+    if (!err || err == &int_error || enj_error_is_quiet(err))
         return;
 
-    enj_free(err->wrap);
+    enj_error_delete(err->wrap);
     enj_free(err);
 }
 
@@ -124,6 +182,13 @@ void enj_error__put(enj_error** err, int code, const char* function, size_t line
     if (*err)
         enj_error_delete(*err);
 
+    enj_error* quiet = _quiet_error(err);
+    if (quiet)
+    {
+        _quiet_put(err, quiet, code, 0, function, line, file);
+        return;
+    }
+
     *err = enj_error_create(code);
     if (*err)
     {
@@ -141,6 +206,13 @@ void enj_error__put_posix_errno(enj_error** err, int code, int posix_errno, cons
     if (*err)
         enj_error_delete(*err);
 
+    enj_error* quiet = _quiet_error(err);
+    if (quiet)
+    {
+        _quiet_put(err, quiet, code, posix_errno, function, line, file);
+        return;
+    }
+
     *err = enj_error_create_posix_errno(code, posix_errno);
     if (*err)
     {
@@ -158,6 +230,15 @@ void enj_error__wrap(enj_error** err, int code, enj_error* wrap, const char* fun
     if (*err && *err != wrap)
         enj_error_delete(*err);
 
+    // Only the outermost code is kept in code-only slots
+    enj_error* quiet = _quiet_error(err);
+    if (quiet)
+    {
+        enj_error_delete(wrap);
+        _quiet_put(err, quiet, code, 0, function, line, file);
+        return;
+    }
+
     *err = enj_error_create_wrap(code, wrap);
     if (*err)
     {
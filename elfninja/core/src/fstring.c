@@ -75,6 +75,15 @@ void enj_fstring_delete(enj_fstring* fstr)
     enj_free(fstr);
 }
 
+int enj_fstring_equal(const enj_fstring* lhs, const enj_fstring* rhs)
+{
+    if (!lhs || !rhs)
+        return lhs == rhs;
+
+    return lhs->hash == rhs->hash && lhs->length == rhs->length &&
+           !memcmp(lhs->string, rhs->string, lhs->length);
+}
+
 enj_fstring_hash_t enj_fstring_hash(const char* string)
 {
     if (!string)
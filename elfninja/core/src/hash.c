@@ -0,0 +1,833 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "elfninja/core/hash.h"
+#include "elfninja/core/malloc.h"
+#include "elfninja/core/blob.h"
+#include "elfninja/core/reloc.h"
+
+#include <string.h>
+
+// Bucket counts used for SysV tables, as picked by the GNU linker
+static const size_t _sysv_buckets[] =
+{
+    1, 3, 17, 37, 67, 97, 131, 197, 263, 521, 1031, 2053, 4099, 8209,
+    16411, 32771, 65537, 131101, 262147, 0
+};
+
+// Second bloom filter hash shift for regenerated GNU tables
+static const size_t _gnu_bloom_shift = 26;
+
+static const char* _symbol_name(enj_symbol* sym)
+{
+    return sym && sym->cached_name ? sym->cached_name->string : "";
+}
+
+static size_t _word_bits(enj_hash* hash)
+{
+    return hash->section->elf->bits == 64 ? 64 : 32;
+}
+
+static void _clear_tables(enj_hash* hash)
+{
+    enj_free(hash->buckets);
+    enj_free(hash->chains);
+    enj_free(hash->bloom);
+
+    hash->bucket_count = 0;
+    hash->buckets = 0;
+    hash->chain_count = 0;
+    hash->chains = 0;
+    hash->bloom_count = 0;
+    hash->bloom_shift = 0;
+    hash->bloom = 0;
+}
+
+uint32_t enj_hash_sysv(const char* name)
+{
+    uint32_t h = 0;
+    uint32_t g;
+
+    for (const unsigned char* p = (const unsigned char*) name; p && *p; ++p)
+    {
+        h = (h << 4) + *p;
+        if ((g = h & 0xF0000000))
+            h ^= g >> 24;
+        h &= ~g;
+    }
+
+    return h;
+}
+
+uint32_t enj_hash_gnu(const char* name)
+{
+    uint32_t h = 5381;
+
+    for (const unsigned char* p = (const unsigned char*) name; p && *p; ++p)
+        h = (h << 5) + h + *p;
+
+    return h;
+}
+
+enj_symbol* enj_hash_find_symbol(enj_hash* hash, const char* name, enj_error** err)
+{
+    if (!hash || !name)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return 0;
+    }
+
+    if (!hash->symbols && enj_hash__index(hash, err) < 0)
+        return 0;
+
+    if (!hash->bucket_count)
+        return 0;
+
+    if (hash->gnu)
+    {
+        uint32_t h = enj_hash_gnu(name);
+        size_t bits = _word_bits(hash);
+
+        // Reject most misses with the bloom filter
+        if (hash->bloom_count)
+        {
+            uint64_t word = hash->bloom[(h / bits) & (hash->bloom_count - 1)];
+            uint64_t mask = ((uint64_t) 1 << (h % bits)) |
+                            ((uint64_t) 1 << ((h >> hash->bloom_shift) % bits));
+
+            if ((word & mask) != mask)
+                return 0;
+        }
+
+        size_t i = hash->buckets[h % hash->bucket_count];
+        if (i < hash->symoffset)
+            return 0;
+
+        for (; i < hash->symbol_count && i - hash->symoffset < hash->chain_count; ++i)
+        {
+            uint32_t c = hash->chains[i - hash->symoffset];
+
+            if ((c | 1) == (h | 1) && !strcmp(_symbol_name(hash->symbols[i]), name))
+                return hash->symbols[i];
+
+            if (c & 1)
+                break;
+        }
+    }
+    else
+    {
+        uint32_t h = enj_hash_sysv(name);
+
+        // Bound the walk by the chain length, in case of a looping chain
+        size_t i = hash->buckets[h % hash->bucket_count];
+        for (size_t steps = 0; i != STN_UNDEF && i < hash->chain_count && steps < hash->chain_count; ++steps)
+        {
+            if (i < hash->symbol_count && !strcmp(_symbol_name(hash->symbols[i]), name))
+                return hash->symbols[i];
+
+            i = hash->chains[i];
+        }
+    }
+
+    return 0;
+}
+
+int enj_hash_is_stale(enj_hash* hash, enj_error** err)
+{
+    if (!hash)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    // Frozen objects were indexed once and for all by enj_elf_freeze
+    if (!hash->section->elf->frozen && enj_hash__index(hash, err) < 0)
+        return -1;
+
+    size_t count = hash->symbol_count;
+
+    if (!hash->bucket_count)
+        return count > 1;
+
+    if (hash->gnu)
+    {
+        if (hash->symoffset > count || hash->chain_count != count - hash->symoffset)
+            return 1;
+
+        size_t bits = _word_bits(hash);
+
+        // Each hashed symbol must live in the contiguous run its bucket points to,
+        //  and must pass the bloom filter
+        for (size_t i = hash->symoffset; i < count; ++i)
+        {
+            uint32_t h = enj_hash_gnu(_symbol_name(hash->symbols[i]));
+            uint32_t c = hash->chains[i - hash->symoffset];
+            size_t b = h % hash->bucket_count;
+
+            if ((c | 1) != (h | 1))
+                return 1;
+
+            int first = i == hash->symoffset ||
+                        enj_hash_gnu(_symbol_name(hash->symbols[i - 1])) % hash->bucket_count != b;
+            int last = i + 1 == count ||
+                       enj_hash_gnu(_symbol_name(hash->symbols[i + 1])) % hash->bucket_count != b;
+
+            if ((first && hash->buckets[b] != i) || (!last != !(c & 1)))
+                return 1;
+
+            if (hash->bloom_count)
+            {
+                uint64_t word = hash->bloom[(h / bits) & (hash->bloom_count - 1)];
+                uint64_t mask = ((uint64_t) 1 << (h % bits)) |
+                                ((uint64_t) 1 << ((h >> hash->bloom_shift) % bits));
+
+                if ((word & mask) != mask)
+                    return 1;
+            }
+        }
+    }
+    else
+    {
+        if (hash->chain_count != count)
+            return 1;
+
+        // Every symbol must be reachable from its bucket
+        for (size_t i = 1; i < count; ++i)
+        {
+            uint32_t h = enj_hash_sysv(_symbol_name(hash->symbols[i]));
+
+            size_t j = hash->buckets[h % hash->bucket_count];
+            for (size_t steps = 0; j != i && j != STN_UNDEF && j < count && steps < count; ++steps)
+                j = hash->chains[j];
+
+            if (j != i)
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int _gnu_groups(enj_hash* hash, uint32_t* hashes, size_t symoffset, size_t bucket_count, unsigned char* closed)
+{
+    memset(closed, 0, bucket_count);
+
+    size_t prev = bucket_count;
+    for (size_t i = symoffset; i < hash->symbol_count; ++i)
+    {
+        size_t b = hashes[i] % bucket_count;
+
+        if (b != prev)
+        {
+            if (closed[b])
+                return 0;
+
+            if (prev != bucket_count)
+                closed[prev] = 1;
+            prev = b;
+        }
+    }
+
+    return 1;
+}
+
+// Move entry i of a table indexed like the symbol table (version indices, extended
+//  section indices) to map[i]
+static int _permute_entries(enj_elf_shdr* section, size_t* map, size_t count, size_t entsize, enj_error** err)
+{
+    enj_elf* elf = section->elf;
+
+    if (!section->data || section->data->length < count * entsize)
+        return 0;
+
+    unsigned char* old = enj_malloc(count * entsize + 1);
+    unsigned char* new = enj_malloc(count * entsize + 1);
+    if (!old || !new)
+    {
+        enj_free(old);
+        enj_free(new);
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    int ret = enj_blob_read(elf->blob, section->data->start->pos, old, count * entsize, err);
+    if (ret == 0)
+    {
+        for (size_t i = 0; i < count; ++i)
+            memcpy(new + map[i] * entsize, old + i * entsize, entsize);
+
+        ret = enj_blob_write(elf->blob, section->data->start->pos, new, count * entsize, err);
+    }
+
+    enj_free(old);
+    enj_free(new);
+
+    return ret;
+}
+
+// Sort hashed symbols by bucket, as GNU tables need each bucket to be a contiguous run
+//  of the symbol table ; symbol indices are remapped in relocations, version indices and
+//  extended section indices, and the other hash tables of the symbol table are rebuilt
+static int _reorder_gnu(enj_hash* hash, uint32_t* hashes, size_t symoffset, size_t bucket_count, enj_error** err)
+{
+    enj_elf* elf = hash->section->elf;
+    enj_symtab* symtab = (enj_symtab*) hash->symtab->content;
+    size_t count = hash->symbol_count;
+
+    size_t* map = enj_malloc((count + 1) * sizeof(size_t));
+    size_t* starts = enj_malloc((bucket_count + 1) * sizeof(size_t));
+    uint32_t* sorted = enj_malloc((count + 1) * sizeof(uint32_t));
+    enj_symbol** symbols = enj_malloc((count + 1) * sizeof(enj_symbol*));
+    enj_blob_anchor** headers = enj_malloc((count + 1) * sizeof(enj_blob_anchor*));
+    if (!map || !starts || !sorted || !symbols || !headers)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        goto fail;
+    }
+
+    // Stable counting sort of the hashed symbols by bucket
+    for (size_t i = symoffset; i < count; ++i)
+        ++starts[hashes[i] % bucket_count];
+
+    for (size_t b = 0, next = symoffset; b < bucket_count; ++b)
+    {
+        size_t size = starts[b];
+        starts[b] = next;
+        next += size;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        map[i] = i < symoffset ? i : starts[hashes[i] % bucket_count]++;
+        sorted[map[i]] = hashes[i];
+        symbols[map[i]] = hash->symbols[i];
+        headers[i] = hash->symbols[i]->header;
+    }
+
+    memcpy(hashes + symoffset, sorted + symoffset, (count - symoffset) * sizeof(uint32_t));
+
+    // Symbols keep their contents, but take the header slot of their new index
+    for (size_t i = 0; i < count; ++i)
+    {
+        enj_symbol* sym = symbols[i];
+
+        sym->header = headers[i];
+        sym->index = i;
+        sym->prev = i ? symbols[i - 1] : 0;
+        sym->next = i + 1 < count ? symbols[i + 1] : 0;
+
+        if (i >= symoffset && enj_symbol_push(sym, err) < 0)
+            goto fail;
+    }
+
+    symtab->symbols = count ? symbols[0] : 0;
+    symtab->last_symbol = count ? symbols[count - 1] : 0;
+
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        size_t type = ENJ_ELF_SHDR_GET(section, sh_type);
+        int linked = ENJ_ELF_SHDR_GET(section, sh_link) == hash->symtab->index;
+
+        if (section->content_view && section->content_view->tag == ENJ_ELF_RELOC && section->content &&
+            ((enj_reloc*) section->content)->symtab == hash->symtab)
+        {
+            enj_reloc* reloc = (enj_reloc*) section->content;
+
+            for (size_t i = 0; i < reloc->count; ++i)
+            {
+                size_t sym = ENJ_RELOC_SYM(reloc, i);
+                if (sym < count)
+                    ENJ_RELOC_INFO(reloc, i, map[sym], ENJ_RELOC_TYPE(reloc, i));
+            }
+
+            // Relocation tables may have been pushed already
+            if (enj_reloc__push(section, err) < 0)
+                goto fail;
+        }
+        else if (linked && type == SHT_GNU_versym)
+        {
+            if (_permute_entries(section, map, count, sizeof(Elf32_Half), err) < 0)
+                goto fail;
+        }
+        else if (linked && type == SHT_SYMTAB_SHNDX)
+        {
+            if (_permute_entries(section, map, count, sizeof(Elf32_Word), err) < 0)
+                goto fail;
+        }
+    }
+
+    if (enj_hash__index(hash, err) < 0)
+        goto fail;
+
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        if (section != hash->section && section->content_view && section->content_view->tag == ENJ_ELF_HASH &&
+            section->content && ((enj_hash*) section->content)->symtab == hash->symtab &&
+            enj_hash__push(section, err) < 0)
+            goto fail;
+    }
+
+    enj_free(map);
+    enj_free(starts);
+    enj_free(sorted);
+    enj_free(symbols);
+    enj_free(headers);
+    return 0;
+
+fail:
+    enj_free(map);
+    enj_free(starts);
+    enj_free(sorted);
+    enj_free(symbols);
+    enj_free(headers);
+    return -1;
+}
+
+static int _rebuild_gnu(enj_hash* hash, enj_error** err)
+{
+    size_t count = hash->symbol_count;
+
+    // Keep the previous split between unhashed and hashed symbols when possible,
+    //  otherwise leave leading undefined symbols out of the table
+    size_t symoffset = hash->symoffset;
+    if (!hash->bucket_count)
+    {
+        symoffset = 1;
+        while (symoffset < count && ENJ_SYMBOL_GET(hash->symbols[symoffset], st_shndx) == SHN_UNDEF)
+            ++symoffset;
+    }
+    if (symoffset > count)
+        symoffset = count;
+
+    size_t hashed = count - symoffset;
+
+    uint32_t* hashes = enj_malloc((count + 1) * sizeof(uint32_t));
+    if (!hashes)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    for (size_t i = symoffset; i < count; ++i)
+        hashes[i] = enj_hash_gnu(_symbol_name(hash->symbols[i]));
+
+    // Keep the old table sizes while no symbol was added, so that the section keeps
+    //  its size ; otherwise use the usual sizing, with about 12 bloom bits per symbol
+    int keep = hash->bucket_count && hash->bloom_count && hashed <= hash->chain_count;
+    size_t bits = _word_bits(hash);
+
+    size_t bucket_count = keep ? hash->bucket_count : hashed / 4 ? hashed / 4 : 1;
+    size_t bloom_count = keep ? hash->bloom_count : 1;
+    while (!keep && bloom_count * bits < hashed * 12)
+        bloom_count <<= 1;
+
+    // Hashed symbols are left in place if they are already grouped by bucket
+    unsigned char* closed = enj_malloc(bucket_count);
+    if (!closed)
+    {
+        enj_free(hashes);
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    if (!_gnu_groups(hash, hashes, symoffset, bucket_count, closed) &&
+        _reorder_gnu(hash, hashes, symoffset, bucket_count, err) < 0)
+    {
+        enj_free(closed);
+        enj_free(hashes);
+        return -1;
+    }
+
+    enj_free(closed);
+
+    uint32_t* buckets = enj_malloc(bucket_count * sizeof(uint32_t));
+    uint32_t* chains = enj_malloc((hashed + 1) * sizeof(uint32_t));
+    uint64_t* bloom = enj_malloc(bloom_count * sizeof(uint64_t));
+    if (!buckets || !chains || !bloom)
+    {
+        enj_free(hashes);
+        enj_free(buckets);
+        enj_free(chains);
+        enj_free(bloom);
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    for (size_t i = symoffset; i < count; ++i)
+    {
+        uint32_t h = hashes[i];
+        size_t b = h % bucket_count;
+
+        if (i == symoffset || hashes[i - 1] % bucket_count != b)
+            buckets[b] = i;
+
+        chains[i - symoffset] = h & ~1;
+        if (i + 1 == count || hashes[i + 1] % bucket_count != b)
+            chains[i - symoffset] |= 1;
+
+        bloom[(h / bits) & (bloom_count - 1)] |= ((uint64_t) 1 << (h % bits)) |
+                                                 ((uint64_t) 1 << ((h >> _gnu_bloom_shift) % bits));
+    }
+
+    enj_free(hashes);
+    _clear_tables(hash);
+
+    hash->symoffset = symoffset;
+    hash->bucket_count = bucket_count;
+    hash->buckets = buckets;
+    hash->chain_count = hashed;
+    hash->chains = chains;
+    hash->bloom_count = bloom_count;
+    hash->bloom_shift = _gnu_bloom_shift;
+    hash->bloom = bloom;
+
+    return 0;
+}
+
+static int _rebuild_sysv(enj_hash* hash, enj_error** err)
+{
+    size_t count = hash->symbol_count;
+
+    size_t bucket_count = 1;
+    for (size_t i = 0; _sysv_buckets[i]; ++i)
+    {
+        bucket_count = _sysv_buckets[i];
+        if (!_sysv_buckets[i + 1] || count < _sysv_buckets[i + 1])
+            break;
+    }
+
+    uint32_t* buckets = enj_malloc(bucket_count * sizeof(uint32_t));
+    uint32_t* chains = enj_malloc((count + 1) * sizeof(uint32_t));
+    if (!buckets || !chains)
+    {
+        enj_free(buckets);
+        enj_free(chains);
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    // Symbol 0 is STN_UNDEF, and terminates chains
+    for (size_t i = 1; i < count; ++i)
+    {
+        size_t b = enj_hash_sysv(_symbol_name(hash->symbols[i])) % bucket_count;
+
+        chains[i] = buckets[b];
+        buckets[b] = i;
+    }
+
+    _clear_tables(hash);
+
+    hash->bucket_count = bucket_count;
+    hash->buckets = buckets;
+    hash->chain_count = count;
+    hash->chains = chains;
+
+    return 0;
+}
+
+int enj_hash_rebuild(enj_hash* hash, enj_error** err)
+{
+    if (!hash)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (enj_elf__check_frozen(hash->section->elf, err) < 0)
+        return -1;
+
+    if (enj_hash__index(hash, err) < 0)
+        return -1;
+
+    if (hash->gnu)
+        return _rebuild_gnu(hash, err);
+
+    return _rebuild_sysv(hash, err);
+}
+
+int enj_hash__index(enj_hash* hash, enj_error** err)
+{
+    if (!hash)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enj_symtab* symtab = hash->symtab ? (enj_symtab*) hash->symtab->content : 0;
+
+    size_t count = 0;
+    if (symtab)
+    {
+        for (enj_symbol* sym = symtab->symbols; sym; sym = sym->next)
+            ++count;
+    }
+
+    enj_symbol** symbols = enj_realloc(hash->symbols, (count + 1) * sizeof(enj_symbol*));
+    if (!symbols)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    hash->symbols = symbols;
+    hash->symbol_count = count;
+
+    // Symbols are kept in table order, so list position gives the index
+    if (symtab)
+    {
+        size_t i = 0;
+        for (enj_symbol* sym = symtab->symbols; sym; sym = sym->next)
+            symbols[i++] = sym;
+    }
+
+    return 0;
+}
+
+int enj_hash__pull(enj_elf_shdr* section, enj_error** err)
+{
+    if (!section || !section->elf || !section->elf->bits)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enj_elf* elf = section->elf;
+
+    if (section->content && enj_hash__delete(section, err) < 0)
+        return -1;
+
+    enj_hash* hash = enj_malloc(sizeof(enj_hash));
+    if (!hash)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    section->content = hash;
+    hash->section = section;
+    hash->gnu = ENJ_ELF_SHDR_GET(section, sh_type) == SHT_GNU_HASH;
+
+    // Get the linked symbol table, its contents may not be pulled yet
+    size_t symtabndx = ENJ_ELF_SHDR_GET(section, sh_link);
+    hash->symtab = enj_elf_find_shdr_by_index(elf, symtabndx, err);
+    if (*err)
+        return -1;
+
+    if (!section->data)
+        return 0;
+
+    // Read section parameters
+    size_t offset = section->data->start->pos;
+    size_t size = section->data->length;
+
+    uint32_t header[4];
+    size_t header_size = (hash->gnu ? 4 : 2) * sizeof(uint32_t);
+
+    // Leave malformed tables empty, they will be regenerated on push
+    if (size < header_size ||
+        enj_blob_read(elf->blob, offset, &header[0], header_size, err) < 0)
+        return *err ? -1 : 0;
+
+    size_t bucket_count = header[0];
+    size_t bloom_count = hash->gnu ? header[2] : 0;
+    size_t bloom_size = bloom_count * (_word_bits(hash) / 8);
+    size_t buckets_size = bucket_count * sizeof(uint32_t);
+
+    if (header_size + bloom_size + buckets_size > size ||
+        (bloom_count & (bloom_count - 1)) ||
+        (hash->gnu && header[3] >= 32))
+        return 0;
+
+    size_t chain_count = hash->gnu ? (size - header_size - bloom_size - buckets_size) / sizeof(uint32_t) : header[1];
+    if (header_size + bloom_size + buckets_size + chain_count * sizeof(uint32_t) > size)
+        return 0;
+
+    hash->buckets = enj_malloc(buckets_size + sizeof(uint32_t));
+    hash->chains = enj_malloc((chain_count + 1) * sizeof(uint32_t));
+    hash->bloom = enj_malloc((bloom_count + 1) * sizeof(uint64_t));
+    if (!hash->buckets || !hash->chains || !hash->bloom)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    hash->bucket_count = bucket_count;
+    hash->chain_count = chain_count;
+
+    size_t pos = offset + header_size;
+
+    if (hash->gnu)
+    {
+        hash->symoffset = header[1];
+        hash->bloom_count = bloom_count;
+        hash->bloom_shift = header[3];
+
+        for (size_t i = 0; i < bloom_count; ++i)
+        {
+            if (elf->bits == 64)
+            {
+                if (enj_blob_read(elf->blob, pos, &hash->bloom[i], sizeof(uint64_t), err) < 0)
+                    return -1;
+            }
+            else
+            {
+                uint32_t word;
+                if (enj_blob_read(elf->blob, pos, &word, sizeof(uint32_t), err) < 0)
+                    return -1;
+                hash->bloom[i] = word;
+            }
+
+            pos += _word_bits(hash) / 8;
+        }
+    }
+
+    if (enj_blob_read(elf->blob, pos, hash->buckets, buckets_size, err) < 0 ||
+        enj_blob_read(elf->blob, pos + buckets_size, hash->chains, chain_count * sizeof(uint32_t), err) < 0)
+        return -1;
+
+    return 0;
+}
+
+int enj_hash__update(enj_elf_shdr* section, enj_error** err)
+{
+    if (!section || !section->content)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enj_hash* hash = (enj_hash*) section->content;
+
+    // Drop the symbol index, the symbol table may have been pulled again
+    enj_free(hash->symbols);
+    hash->symbols = 0;
+    hash->symbol_count = 0;
+
+    return 0;
+}
+
+int enj_hash__push(enj_elf_shdr* section, enj_error** err)
+{
+    if (!section || !section->content || !section->elf)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enj_hash* hash = (enj_hash*) section->content;
+    enj_elf* elf = section->elf;
+
+    if (hash->symtab)
+    {
+        ENJ_ELF_SHDR_SET(section, sh_link, hash->symtab->index);
+    }
+    else
+    {
+        ENJ_ELF_SHDR_SET(section, sh_link, SHN_UNDEF);
+    }
+
+    // Only rewrite tables that no longer describe the symbol table, so that
+    //  untouched files are left byte for byte identical
+    int stale = enj_hash_is_stale(hash, err);
+    if (stale < 0)
+        return -1;
+
+    if (!stale || !section->data || !hash->symtab)
+        return 0;
+
+    if (enj_hash_rebuild(hash, err) < 0)
+        return -1;
+
+    // Serialize the new tables
+    size_t word_size = _word_bits(hash) / 8;
+    size_t header_size = (hash->gnu ? 4 : 2) * sizeof(uint32_t);
+    size_t size = header_size + hash->bloom_count * word_size +
+                  (hash->bucket_count + hash->chain_count) * sizeof(uint32_t);
+
+    unsigned char* buffer = enj_malloc(size);
+    if (!buffer)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    uint32_t* p = (uint32_t*) buffer;
+    *p++ = hash->bucket_count;
+
+    if (hash->gnu)
+    {
+        *p++ = hash->symoffset;
+        *p++ = hash->bloom_count;
+        *p++ = hash->bloom_shift;
+
+        unsigned char* q = (unsigned char*) p;
+        for (size_t i = 0; i < hash->bloom_count; ++i)
+        {
+            if (elf->bits == 64)
+            {
+                memcpy(q, &hash->bloom[i], sizeof(uint64_t));
+            }
+            else
+            {
+                uint32_t word = hash->bloom[i];
+                memcpy(q, &word, sizeof(uint32_t));
+            }
+
+            q += word_size;
+        }
+
+        p = (uint32_t*) q;
+    }
+    else
+    {
+        *p++ = hash->chain_count;
+    }
+
+    memcpy(p, hash->buckets, hash->bucket_count * sizeof(uint32_t));
+    memcpy(p + hash->bucket_count, hash->chains, hash->chain_count * sizeof(uint32_t));
+
+    if (enj_blob_resize_cursor(elf->blob, section->data, size, err) < 0 ||
+        enj_blob_write(elf->blob, section->data->start->pos, buffer, size, err) < 0)
+    {
+        enj_free(buffer);
+        return -1;
+    }
+
+    enj_free(buffer);
+
+    return 0;
+}
+
+int enj_hash__delete(enj_elf_shdr* section, enj_error** err)
+{
+    if (!section || !section->content)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enj_hash* hash = (enj_hash*) section->content;
+
+    _clear_tables(hash);
+    enj_free(hash->symbols);
+    enj_free(hash);
+
+    section->content = 0;
+
+    return 0;
+}
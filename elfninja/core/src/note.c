@@ -35,6 +35,9 @@ int enj_note_pull(enj_note* note, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(note->nsect->section->elf, err) < 0)
+        return -1;
+
     enj_elf* elf = note->nsect->section->elf;
 
     // Read note header
@@ -57,9 +60,9 @@ int enj_note_pull(enj_note* note, enj_error** err)
         note->name = 0;
     }
 
-    // Create name cursor (don't forget null byte)
+    // Create name cursor (n_namesz already counts the null byte)
     size_t name_off = ENJ_NOTE_SIZE(note);
-    size_t name_size = ENJ_NOTE_GET(note, n_namesz) + 1;
+    size_t name_size = ENJ_NOTE_GET(note, n_namesz);
 
     if (!(note->name = enj_blob_new_cursor(elf->blob, note->header->pos + name_off, name_size, err)))
         return -1;
@@ -74,7 +77,7 @@ int enj_note_pull(enj_note* note, enj_error** err)
 
     // Create desc cursor (don't forget alignment)
     size_t desc_size = ENJ_NOTE_GET(note, n_descsz);
-    size_t desc_off = ENJ_NOTE_ALIGN(note, name_off + name_size-1);
+    size_t desc_off = ENJ_NOTE_ALIGN(note, name_off + name_size);
 
     if (!(note->desc = enj_blob_new_cursor(elf->blob, note->header->pos + desc_off, desc_size, err)))
         return -1;
@@ -94,30 +97,42 @@ int enj_note_update(enj_note* note, enj_error** err)
         return -1;
     }
 
+    if (note->nsect->section->elf->frozen)
+        return 0;
+
     enj_elf* elf = note->nsect->section->elf;
 
-    // Clear cached symbol name
-    if (note->cached_name)
-    {
-        enj_fstring_delete(note->cached_name);
-        note->cached_name = 0;
-    }
+    // Clear cached symbol name, keeping it to tell whether it changed
+    enj_fstring* cached_name = note->cached_name;
+    note->cached_name = 0;
 
     // Cache symbol name (if available)
     if (note->name)
     {
-        char buffer[note->name->length];
+        char buffer[note->name->length + 1];
         if (enj_blob_read(elf->blob, note->name->start->pos, &buffer[0], note->name->length, err) < 0)
+        {
+            enj_fstring_delete(cached_name);
             return -1;
+        }
+        buffer[note->name->length] = '\0';
 
         note->cached_name = enj_fstring_create(&buffer[0], err);
         if (!note->cached_name)
+        {
+            enj_fstring_delete(cached_name);
             return -1;
+        }
     }
 
+    int changed = !enj_fstring_equal(cached_name, note->cached_name);
+    enj_fstring_delete(cached_name);
+
     size_t type = ENJ_NOTE_GET(note, n_type);
 
     // Update content view if the note type changed, or get one
+    enj_note_content_view* cached_view = note->content_view;
+
     if (!note->content_view || (note->content_view && note->content_view->target_type != type))
     {
         if (note->content_view && note->content_view->o_delete &&
@@ -133,16 +148,20 @@ int enj_note_update(enj_note* note, enj_error** err)
         if (note->content_view && note->content_view->o_pull &&
             (*note->content_view->o_pull)(note, err) < 0)
             return -1;
+
+        changed |= note->content_view != cached_view;
     }
     // Otherwise, just update the content
-    else
+    else if (note->content_view && note->content_view->o_update)
     {
-        if (note->content_view && note->content_view->o_update &&
-            (*note->content_view->o_update)(note, err) < 0)
+        int ret = (*note->content_view->o_update)(note, err);
+        if (ret < 0)
             return -1;
+
+        changed |= ret;
     }
 
-    return 0;
+    return changed;
 }
 
 int enj_note_push(enj_note* note, enj_error** err)
@@ -154,6 +173,9 @@ int enj_note_push(enj_note* note, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(note->nsect->section->elf, err) < 0)
+        return -1;
+
     enj_elf* elf = note->nsect->section->elf;
 
     // Push eventual note content
@@ -164,8 +186,7 @@ int enj_note_push(enj_note* note, enj_error** err)
     // Update name size
     if (note->name)
     {
-        size_t name_size = note->name->length ? note->name->length - 1 : 0;
-        ENJ_NOTE_SET(note, n_namesz, name_size);
+        ENJ_NOTE_SET(note, n_namesz, note->name->length);
     }
 
     //TODO: alignment of descriptor ??
@@ -353,14 +374,18 @@ int enj_nsect__update(enj_elf_shdr* section, enj_error** err)
     }
 
     enj_nsect* nsect = (enj_nsect*) section->content;
+    int changed = 0;
 
     for (enj_note* note = nsect->notes; note; note = note->next)
     {
-        if (enj_note_update(note, err) < 0)
+        int ret = enj_note_update(note, err);
+        if (ret < 0)
             return -1;
+
+        changed |= ret;
     }
 
-    return 0;
+    return changed;
 }
 
 int enj_nsect__push(enj_elf_shdr* section, enj_error** err)
@@ -20,6 +20,8 @@
 #include "elfninja/core/malloc.h"
 #include "elfninja/core/blob.h"
 
+#include <string.h>
+
 int enj_note_gnu_abi_tag__pull(enj_note* note, enj_error** err)
 {
     enj_note_gnu_abi_tag* tag = enj_malloc(sizeof(enj_note_gnu_abi_tag));
@@ -74,10 +76,13 @@ int enj_note_gnu_abi_tag__update(enj_note* note, enj_error** err)
 
     Elf32_Word word32;
     Elf64_Word word64;
+    int changed = 0;
 
     // Read in the fields
     for (size_t i = 0; i < num_fields; ++i)
     {
+        size_t cached = *fields[i];
+
         if (elf->bits == 64)
         {
             if (enj_blob_read(elf->blob, note->desc->start->pos + i * word_size, &word64, word_size, err) < 0)
@@ -98,9 +103,11 @@ int enj_note_gnu_abi_tag__update(enj_note* note, enj_error** err)
 
             *fields[i] = word32;
         }
+
+        changed |= cached != *fields[i];
     }
 
-    return 0;
+    return changed;
 }
 
 int enj_note_gnu_abi_tag__push(enj_note* note, enj_error** err)
@@ -212,17 +219,28 @@ int enj_note_gnu_build_id__update(enj_note* note, enj_error** err)
     enj_elf* elf = note->nsect->section->elf;
     enj_note_gnu_build_id* build_id = note->content;
 
-    if (build_id->bytes)
-        enj_free(build_id->bytes);
+    // Keep the cached bytes to tell whether they changed
+    unsigned char* cached = build_id->bytes;
+    size_t cached_length = build_id->length;
 
     build_id->length = note->desc->length;
     if (!(build_id->bytes = enj_malloc(build_id->length)))
+    {
+        enj_free(cached);
         return -1;
+    }
 
     if (enj_blob_read(elf->blob, note->desc->start->pos, build_id->bytes, note->desc->length, err) < 0)
+    {
+        enj_free(cached);
         return -1;
+    }
 
-    return 0;
+    int changed = !cached || cached_length != build_id->length ||
+                  memcmp(cached, build_id->bytes, build_id->length);
+    enj_free(cached);
+
+    return changed;
 }
 
 int enj_note_gnu_build_id__push(enj_note* note, enj_error** err)
@@ -240,10 +258,10 @@ int enj_note_gnu_build_id__push(enj_note* note, enj_error** err)
 
     if (build_id->bytes)
     {
-        size_t old_length = note->desc->length;
-
-        if (enj_blob_insert(elf->blob, note->desc->start->pos, build_id->bytes, build_id->length, err) < 0 ||
-            enj_blob_remove(elf->blob, note->desc->start->pos + build_id->length, old_length, err) < 0)
+        // Resize in place, inserting at the descriptor start would also
+        //  drag the end of the name cursor sitting right before it
+        if (enj_blob_resize_cursor(elf->blob, note->desc, build_id->length, err) < 0 ||
+            enj_blob_write(elf->blob, note->desc->start->pos, build_id->bytes, build_id->length, err) < 0)
         {
             return -1;
         }
@@ -0,0 +1,424 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+
+#include "elfninja/core/probe.h"
+
+#include <elf.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#define PROBE_MAX_LOADS 32
+#define PROBE_MAX_NOTES 8
+#define PROBE_CHUNK     16
+#define PROBE_STRTAB    4096
+#define PROBE_NOTES     4096
+
+typedef struct _probe_segment
+{
+    size_t offset;
+    size_t vaddr;
+    size_t filesz;
+    size_t align;
+} _probe_segment;
+
+// Read as much as possible of the requested range, returns the byte count
+static ssize_t _read(int fd, void* ptr, size_t length, size_t offset, enj_error** err)
+{
+    size_t count = 0;
+
+    while (count < length)
+    {
+        ssize_t ret = pread(fd, (unsigned char*) ptr + count, length - count, offset + count);
+
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            enj_error_put_posix_errno(err, ENJ_ERR_IO, errno);
+            return -1;
+        }
+
+        if (!ret)
+            break;
+
+        count += ret;
+    }
+
+    return count;
+}
+
+static void _get_segment(int bits, void const* raw, size_t* type, _probe_segment* segment)
+{
+    if (bits == 64)
+    {
+        Elf64_Phdr const* phdr = raw;
+
+        *type = phdr->p_type;
+        segment->offset = phdr->p_offset;
+        segment->vaddr = phdr->p_vaddr;
+        segment->filesz = phdr->p_filesz;
+        segment->align = phdr->p_align;
+    }
+    else
+    {
+        Elf32_Phdr const* phdr = raw;
+
+        *type = phdr->p_type;
+        segment->offset = phdr->p_offset;
+        segment->vaddr = phdr->p_vaddr;
+        segment->filesz = phdr->p_filesz;
+        segment->align = phdr->p_align;
+    }
+}
+
+// Look for the GNU build ID in a PT_NOTE segment
+static int _probe_build_id(int fd, _probe_segment* note, enj_probe_result* result, enj_error** err)
+{
+    unsigned char buffer[PROBE_NOTES];
+    size_t length = note->filesz < sizeof(buffer) ? note->filesz : sizeof(buffer);
+
+    ssize_t count = _read(fd, &buffer[0], length, note->offset, err);
+    if (count < 0)
+        return -1;
+
+    size_t align = note->align == 8 ? 8 : 4;
+    size_t pos = 0;
+
+    while (pos + sizeof(Elf64_Nhdr) <= (size_t) count)
+    {
+        Elf64_Nhdr nhdr;
+        memcpy(&nhdr, &buffer[pos], sizeof(Elf64_Nhdr));
+
+        size_t name_pos = pos + sizeof(Elf64_Nhdr);
+        size_t desc_pos = (name_pos + nhdr.n_namesz + align - 1) & ~(align - 1);
+        size_t next = (desc_pos + nhdr.n_descsz + align - 1) & ~(align - 1);
+
+        if (desc_pos + nhdr.n_descsz > (size_t) count)
+            break;
+
+        if (nhdr.n_type == NT_GNU_BUILD_ID && nhdr.n_namesz == 4 &&
+            !memcmp(&buffer[name_pos], "GNU", 4))
+        {
+            size_t size = nhdr.n_descsz;
+            if (size > ENJ_PROBE_BUILD_ID_SIZE)
+            {
+                size = ENJ_PROBE_BUILD_ID_SIZE;
+                result->truncated = 1;
+            }
+
+            memcpy(&result->build_id[0], &buffer[desc_pos], size);
+            result->build_id_length = size;
+            result->fields |= ENJ_PROBE_BUILD_ID;
+            break;
+        }
+
+        pos = next;
+    }
+
+    return 0;
+}
+
+// Copy a dynamic string, from the cached table if it holds it
+static int _probe_string(int fd, size_t strtab, size_t strsz, char const* cache, size_t cached,
+                         size_t name, char* out, enj_probe_result* result, enj_error** err)
+{
+    if (name >= strsz)
+        return 0;
+
+    size_t length = strsz - name < ENJ_PROBE_NAME_SIZE ? strsz - name : ENJ_PROBE_NAME_SIZE;
+
+    if (name + length <= cached)
+    {
+        memcpy(out, cache + name, length);
+    }
+    else
+    {
+        ssize_t count = _read(fd, out, length, strtab + name, err);
+        if (count < 0)
+            return -1;
+        length = count;
+    }
+
+    if (!memchr(out, '\0', length))
+    {
+        if (length == ENJ_PROBE_NAME_SIZE)
+            result->truncated = 1;
+        out[length ? length - 1 : 0] = '\0';
+    }
+
+    return 0;
+}
+
+// Fetch SONAME and DT_NEEDED entries from the PT_DYNAMIC segment
+static int _probe_dynamic(int fd, int bits, int fields, _probe_segment* dynamic,
+                          _probe_segment* loads, size_t load_count,
+                          enj_probe_result* result, enj_error** err)
+{
+    size_t entsize = bits == 64 ? sizeof(Elf64_Dyn) : sizeof(Elf32_Dyn);
+    size_t strtab_addr = 0;
+    size_t strsz = 0;
+    size_t soname = 0;
+    int has_strtab = 0;
+    int has_soname = 0;
+
+    size_t needed[ENJ_PROBE_MAX_NEEDED];
+    size_t needed_count = 0;
+
+    unsigned char buffer[PROBE_CHUNK * sizeof(Elf64_Dyn)];
+    int done = 0;
+
+    for (size_t pos = 0; pos < dynamic->filesz && !done; pos += PROBE_CHUNK * entsize)
+    {
+        size_t length = dynamic->filesz - pos < PROBE_CHUNK * entsize ? dynamic->filesz - pos : PROBE_CHUNK * entsize;
+
+        ssize_t count = _read(fd, &buffer[0], length, dynamic->offset + pos, err);
+        if (count < 0)
+            return -1;
+
+        for (size_t i = 0; i + entsize <= (size_t) count; i += entsize)
+        {
+            size_t tag;
+            size_t val;
+
+            if (bits == 64)
+            {
+                Elf64_Dyn dyn;
+                memcpy(&dyn, &buffer[i], sizeof(Elf64_Dyn));
+                tag = dyn.d_tag;
+                val = dyn.d_un.d_val;
+            }
+            else
+            {
+                Elf32_Dyn dyn;
+                memcpy(&dyn, &buffer[i], sizeof(Elf32_Dyn));
+                tag = dyn.d_tag;
+                val = dyn.d_un.d_val;
+            }
+
+            if (tag == DT_NULL)
+            {
+                done = 1;
+                break;
+            }
+
+            switch (tag)
+            {
+                case DT_STRTAB: strtab_addr = val; has_strtab = 1; break;
+                case DT_STRSZ:  strsz = val; break;
+                case DT_SONAME: soname = val; has_soname = 1; break;
+
+                case DT_NEEDED:
+                    if (needed_count < ENJ_PROBE_MAX_NEEDED)
+                        needed[needed_count++] = val;
+                    else
+                        result->truncated = 1;
+                    break;
+            }
+        }
+
+        if ((size_t) count < length)
+            break;
+    }
+
+    if (!has_strtab || !strsz)
+        return 0;
+
+    // DT_STRTAB holds an address, find its file offset
+    size_t strtab = 0;
+    int mapped = 0;
+
+    for (size_t i = 0; i < load_count && !mapped; ++i)
+    {
+        if (strtab_addr >= loads[i].vaddr && strtab_addr - loads[i].vaddr < loads[i].filesz)
+        {
+            strtab = loads[i].offset + (strtab_addr - loads[i].vaddr);
+            mapped = 1;
+        }
+    }
+
+    if (!mapped)
+        return 0;
+
+    // Small string tables are read at once
+    char cache[PROBE_STRTAB];
+    size_t cached = 0;
+
+    if (strsz <= sizeof(cache) && (needed_count > 1 || (needed_count && has_soname)))
+    {
+        ssize_t count = _read(fd, &cache[0], strsz, strtab, err);
+        if (count < 0)
+            return -1;
+        cached = count;
+    }
+
+    if ((fields & ENJ_PROBE_SONAME) && has_soname)
+    {
+        if (_probe_string(fd, strtab, strsz, &cache[0], cached, soname, &result->soname[0], result, err) < 0)
+            return -1;
+        result->fields |= ENJ_PROBE_SONAME;
+    }
+
+    if (fields & ENJ_PROBE_NEEDED)
+    {
+        for (size_t i = 0; i < needed_count; ++i)
+        {
+            if (_probe_string(fd, strtab, strsz, &cache[0], cached, needed[i],
+                              &result->needed[result->needed_count][0], result, err) < 0)
+                return -1;
+            ++result->needed_count;
+        }
+
+        result->fields |= ENJ_PROBE_NEEDED;
+    }
+
+    return 0;
+}
+
+// Read only the few bytes needed for the requested fields, without building
+//  the ELF model ; returns ENJ_ERR_BADHDR for non-ELF files
+int enj_elf_probe(int fd, int fields, enj_probe_result* result, enj_error** err)
+{
+    if (fd < 0 || !result)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    memset(result, 0, sizeof(enj_probe_result));
+
+    union
+    {
+        Elf32_Ehdr ehdr32;
+        Elf64_Ehdr ehdr64;
+    } ehdr;
+
+    ssize_t count = _read(fd, &ehdr, sizeof(ehdr), 0, err);
+    if (count < 0)
+        return -1;
+
+    unsigned char* ident = &ehdr.ehdr64.e_ident[0];
+
+    if ((size_t) count < EI_NIDENT ||
+        ident[EI_MAG0] != ELFMAG0 || ident[EI_MAG1] != ELFMAG1 ||
+        ident[EI_MAG2] != ELFMAG2 || ident[EI_MAG3] != ELFMAG3)
+    {
+        enj_error_put(err, ENJ_ERR_BADHDR);
+        return -1;
+    }
+
+    size_t phoff;
+    size_t phentsize;
+    size_t phnum;
+
+    if (ident[EI_CLASS] == ELFCLASS64 && (size_t) count >= sizeof(Elf64_Ehdr))
+    {
+        result->bits = 64;
+        result->type = ehdr.ehdr64.e_type;
+        result->machine = ehdr.ehdr64.e_machine;
+
+        phoff = ehdr.ehdr64.e_phoff;
+        phentsize = ehdr.ehdr64.e_phentsize;
+        phnum = ehdr.ehdr64.e_phnum;
+    }
+    else if (ident[EI_CLASS] == ELFCLASS32 && (size_t) count >= sizeof(Elf32_Ehdr))
+    {
+        result->bits = 32;
+        result->type = ehdr.ehdr32.e_type;
+        result->machine = ehdr.ehdr32.e_machine;
+
+        phoff = ehdr.ehdr32.e_phoff;
+        phentsize = ehdr.ehdr32.e_phentsize;
+        phnum = ehdr.ehdr32.e_phnum;
+    }
+    else
+    {
+        enj_error_put(err, ENJ_ERR_BADHDR);
+        return -1;
+    }
+
+    result->fields |= fields & (ENJ_PROBE_CLASS | ENJ_PROBE_MACHINE | ENJ_PROBE_TYPE);
+
+    if (!(fields & (ENJ_PROBE_BUILD_ID | ENJ_PROBE_SONAME | ENJ_PROBE_NEEDED)) || !phnum)
+        return 0;
+
+    if (phentsize != (result->bits == 64 ? sizeof(Elf64_Phdr) : sizeof(Elf32_Phdr)))
+    {
+        enj_error_put(err, ENJ_ERR_BAD_SIZE);
+        return -1;
+    }
+
+    // Collect the segments of interest from the program headers
+    _probe_segment loads[PROBE_MAX_LOADS];
+    _probe_segment notes[PROBE_MAX_NOTES];
+    _probe_segment dynamic;
+    size_t load_count = 0;
+    size_t note_count = 0;
+    int has_dynamic = 0;
+
+    unsigned char buffer[PROBE_CHUNK * sizeof(Elf64_Phdr)];
+
+    for (size_t i = 0; i < phnum; i += PROBE_CHUNK)
+    {
+        size_t entries = phnum - i < PROBE_CHUNK ? phnum - i : PROBE_CHUNK;
+
+        count = _read(fd, &buffer[0], entries * phentsize, phoff + i * phentsize, err);
+        if (count < 0)
+            return -1;
+
+        for (size_t j = 0; (j + 1) * phentsize <= (size_t) count; ++j)
+        {
+            size_t type;
+            _probe_segment segment;
+            _get_segment(result->bits, &buffer[j * phentsize], &type, &segment);
+
+            if (type == PT_LOAD && load_count < PROBE_MAX_LOADS)
+                loads[load_count++] = segment;
+            else if (type == PT_NOTE && note_count < PROBE_MAX_NOTES)
+                notes[note_count++] = segment;
+            else if (type == PT_DYNAMIC && !has_dynamic)
+            {
+                dynamic = segment;
+                has_dynamic = 1;
+            }
+        }
+
+        if ((size_t) count < entries * phentsize)
+            break;
+    }
+
+    if (fields & ENJ_PROBE_BUILD_ID)
+    {
+        for (size_t i = 0; i < note_count && !(result->fields & ENJ_PROBE_BUILD_ID); ++i)
+        {
+            if (_probe_build_id(fd, &notes[i], result, err) < 0)
+                return -1;
+        }
+    }
+
+    if ((fields & (ENJ_PROBE_SONAME | ENJ_PROBE_NEEDED)) && has_dynamic)
+    {
+        if (_probe_dynamic(fd, result->bits, fields, &dynamic, &loads[0], load_count, result, err) < 0)
+            return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,348 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "elfninja/core/reloc.h"
+#include "elfninja/core/malloc.h"
+#include "elfninja/core/blob.h"
+
+#include <string.h>
+
+static size_t _entry_size(enj_reloc* reloc)
+{
+    if (reloc->section->elf->bits == 64)
+        return reloc->rela ? sizeof(Elf64_Rela) : sizeof(Elf64_Rel);
+
+    return reloc->rela ? sizeof(Elf32_Rela) : sizeof(Elf32_Rel);
+}
+
+// Straight field by field copies, kept free of branches so that the
+//  compiler can vectorize them
+static void _decode64(enj_reloc* reloc, const unsigned char* src, size_t count)
+{
+    uint64_t* restrict offsets = reloc->offsets;
+    uint64_t* restrict infos = reloc->infos;
+    int64_t* restrict addends = reloc->addends;
+
+    if (reloc->rela)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Elf64_Rela r;
+            memcpy(&r, src + i * sizeof(Elf64_Rela), sizeof(Elf64_Rela));
+
+            offsets[i] = r.r_offset;
+            infos[i] = r.r_info;
+            addends[i] = r.r_addend;
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Elf64_Rel r;
+            memcpy(&r, src + i * sizeof(Elf64_Rel), sizeof(Elf64_Rel));
+
+            offsets[i] = r.r_offset;
+            infos[i] = r.r_info;
+            addends[i] = 0;
+        }
+    }
+}
+
+static void _decode32(enj_reloc* reloc, const unsigned char* src, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (reloc->rela)
+        {
+            Elf32_Rela r;
+            memcpy(&r, src + i * sizeof(Elf32_Rela), sizeof(Elf32_Rela));
+
+            reloc->offsets[i] = r.r_offset;
+            reloc->infos[i] = r.r_info;
+            reloc->addends[i] = r.r_addend;
+        }
+        else
+        {
+            Elf32_Rel r;
+            memcpy(&r, src + i * sizeof(Elf32_Rel), sizeof(Elf32_Rel));
+
+            reloc->offsets[i] = r.r_offset;
+            reloc->infos[i] = r.r_info;
+            reloc->addends[i] = 0;
+        }
+    }
+}
+
+static void _encode64(enj_reloc* reloc, unsigned char* dst)
+{
+    for (size_t i = 0; i < reloc->count; ++i)
+    {
+        if (reloc->rela)
+        {
+            Elf64_Rela r = { reloc->offsets[i], reloc->infos[i], reloc->addends[i] };
+            memcpy(dst + i * sizeof(Elf64_Rela), &r, sizeof(Elf64_Rela));
+        }
+        else
+        {
+            Elf64_Rel r = { reloc->offsets[i], reloc->infos[i] };
+            memcpy(dst + i * sizeof(Elf64_Rel), &r, sizeof(Elf64_Rel));
+        }
+    }
+}
+
+static void _encode32(enj_reloc* reloc, unsigned char* dst)
+{
+    for (size_t i = 0; i < reloc->count; ++i)
+    {
+        if (reloc->rela)
+        {
+            Elf32_Rela r = { reloc->offsets[i], reloc->infos[i], reloc->addends[i] };
+            memcpy(dst + i * sizeof(Elf32_Rela), &r, sizeof(Elf32_Rela));
+        }
+        else
+        {
+            Elf32_Rel r = { reloc->offsets[i], reloc->infos[i] };
+            memcpy(dst + i * sizeof(Elf32_Rel), &r, sizeof(Elf32_Rel));
+        }
+    }
+}
+
+int enj_reloc_reserve(enj_reloc* reloc, size_t count, enj_error** err)
+{
+    if (!reloc)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (enj_elf__check_frozen(reloc->section->elf, err) < 0)
+        return -1;
+
+    if (count <= reloc->capacity)
+        return 0;
+
+    uint64_t* offsets = enj_realloc(reloc->offsets, count * sizeof(uint64_t));
+    if (!offsets)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+    reloc->offsets = offsets;
+
+    uint64_t* infos = enj_realloc(reloc->infos, count * sizeof(uint64_t));
+    if (!infos)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+    reloc->infos = infos;
+
+    int64_t* addends = enj_realloc(reloc->addends, count * sizeof(int64_t));
+    if (!addends)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+    reloc->addends = addends;
+
+    reloc->capacity = count;
+
+    return 0;
+}
+
+int enj_reloc_shift(enj_reloc* reloc, uint64_t from, uint64_t to, int64_t delta, int flags, enj_error** err)
+{
+    if (!reloc || from > to)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (enj_elf__check_frozen(reloc->section->elf, err) < 0)
+        return -1;
+
+    uint64_t span = to - from;
+    size_t count = reloc->count;
+
+    // Unsigned wrap around makes the range check a single comparison
+    if (flags & ENJ_RELOC_SHIFT_OFFSETS)
+    {
+        uint64_t* restrict offsets = reloc->offsets;
+
+        for (size_t i = 0; i < count; ++i)
+            offsets[i] += (offsets[i] - from < span) ? (uint64_t) delta : 0;
+    }
+
+    if ((flags & ENJ_RELOC_SHIFT_ADDENDS) && reloc->rela)
+    {
+        int64_t* restrict addends = reloc->addends;
+
+        for (size_t i = 0; i < count; ++i)
+            addends[i] += ((uint64_t) addends[i] - from < span) ? delta : 0;
+    }
+
+    return 0;
+}
+
+int enj_reloc__pull(enj_elf_shdr* section, enj_error** err)
+{
+    if (!section || !section->elf || !section->elf->bits)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enj_elf* elf = section->elf;
+
+    if (section->content && enj_reloc__delete(section, err) < 0)
+        return -1;
+
+    enj_reloc* reloc = enj_malloc(sizeof(enj_reloc));
+    if (!reloc)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    section->content = reloc;
+    reloc->section = section;
+    reloc->rela = ENJ_ELF_SHDR_GET(section, sh_type) == SHT_RELA;
+
+    // Get the linked symbol table and target section, if provided
+    size_t symtabndx = ENJ_ELF_SHDR_GET(section, sh_link);
+    reloc->symtab = enj_elf_find_shdr_by_index(elf, symtabndx, err);
+    if (*err)
+        return -1;
+
+    size_t targetndx = ENJ_ELF_SHDR_GET(section, sh_info);
+    reloc->target = targetndx ? enj_elf_find_shdr_by_index(elf, targetndx, err) : 0;
+    if (*err)
+        return -1;
+
+    if (!section->data)
+        return 0;
+
+    // Read section parameters
+    size_t offset = section->data->start->pos;
+    size_t entsize = _entry_size(reloc);
+    size_t count = section->data->length / entsize;
+
+    if (offset + count * entsize > elf->blob->buffer_size)
+    {
+        enj_error_put(err, ENJ_ERR_BOUNDS);
+        return -1;
+    }
+
+    if (enj_reloc_reserve(reloc, count, err) < 0)
+        return -1;
+
+    // Decode all entries at once
+    if (elf->bits == 64)
+        _decode64(reloc, elf->blob->buffer + offset, count);
+    else
+        _decode32(reloc, elf->blob->buffer + offset, count);
+
+    reloc->count = count;
+
+    return 0;
+}
+
+int enj_reloc__update(enj_elf_shdr* section, enj_error** err)
+{
+    if (!section || !section->content)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    return 0;
+}
+
+int enj_reloc__push(enj_elf_shdr* section, enj_error** err)
+{
+    if (!section || !section->content || !section->elf)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enj_reloc* reloc = (enj_reloc*) section->content;
+    enj_elf* elf = section->elf;
+
+    if (reloc->symtab)
+    {
+        ENJ_ELF_SHDR_SET(section, sh_link, reloc->symtab->index);
+    }
+    else
+    {
+        ENJ_ELF_SHDR_SET(section, sh_link, SHN_UNDEF);
+    }
+
+    if (reloc->target)
+        ENJ_ELF_SHDR_SET(section, sh_info, reloc->target->index);
+
+    if (!section->data)
+        return 0;
+
+    // Adjust the section size to the entry count, and encode all entries at once
+    size_t size = reloc->count * _entry_size(reloc);
+
+    unsigned char* buffer = enj_malloc(size + 1);
+    if (!buffer)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    if (elf->bits == 64)
+        _encode64(reloc, buffer);
+    else
+        _encode32(reloc, buffer);
+
+    if (enj_blob_resize_cursor(elf->blob, section->data, size, err) < 0 ||
+        enj_blob_write(elf->blob, section->data->start->pos, buffer, size, err) < 0)
+    {
+        enj_free(buffer);
+        return -1;
+    }
+
+    enj_free(buffer);
+
+    return 0;
+}
+
+int enj_reloc__delete(enj_elf_shdr* section, enj_error** err)
+{
+    if (!section || !section->content)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enj_reloc* reloc = (enj_reloc*) section->content;
+
+    enj_free(reloc->offsets);
+    enj_free(reloc->infos);
+    enj_free(reloc->addends);
+    enj_free(reloc);
+
+    section->content = 0;
+
+    return 0;
+}
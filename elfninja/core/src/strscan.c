@@ -0,0 +1,111 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "elfninja/core/strscan.h"
+#include "elfninja/core/malloc.h"
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+size_t enj_strscan(const void* data, size_t length, enj_strspan** spans, enj_error** err)
+{
+    if (!data || !spans)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return (size_t) -1;
+    }
+
+    const unsigned char* bytes = data;
+    enj_strspan* list = 0;
+    size_t count = 0;
+    size_t capacity = 0;
+
+    for (size_t pos = 0; pos < length;)
+    {
+        if (count == capacity)
+        {
+            capacity = capacity ? 2 * capacity : 64;
+
+            enj_strspan* grown = enj_realloc(list, capacity * sizeof(enj_strspan));
+            if (!grown)
+            {
+                enj_free(list);
+                enj_error_put(err, ENJ_ERR_MALLOC);
+                return (size_t) -1;
+            }
+
+            list = grown;
+        }
+
+        enj_strspan* span = &list[count++];
+        span->offset = pos;
+
+        // Most strings are printable up to their null byte, so the printable
+        //   run usually ends the span without looking at any byte twice
+        size_t end = pos + enj_strscan_printable(bytes + pos, length - pos);
+        span->printable = end == length || !bytes[end];
+
+        if (end < length && bytes[end])
+        {
+            const unsigned char* nul = memchr(bytes + end, 0, length - end);
+            end = nul ? (size_t) (nul - bytes) : length;
+        }
+
+        span->length = end - pos;
+        span->terminated = end < length;
+
+        pos = end + 1;
+    }
+
+    *spans = list;
+    return count;
+}
+
+size_t enj_strscan_printable(const void* data, size_t length)
+{
+    const unsigned char* bytes = data;
+    size_t i = 0;
+
+    if (!bytes)
+        return 0;
+
+#ifdef __SSE2__
+    // Signed compares leave bytes >= 0x80 out of the printable range
+    const __m128i space = _mm_set1_epi8(0x1F);
+    const __m128i tilde = _mm_set1_epi8(0x7F);
+
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*) (bytes + i));
+        __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(v, space), _mm_cmplt_epi8(v, tilde));
+
+        unsigned int mask = ~_mm_movemask_epi8(printable) & 0xFFFF;
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+#endif
+
+    // Same as isprint() in the C locale
+    while (i < length && bytes[i] >= 0x20 && bytes[i] < 0x7F)
+        ++i;
+
+    return i;
+}
@@ -52,6 +52,9 @@ enj_symbol* enj_symtab_new_symbol(enj_symtab* symtab, const char* name, enj_erro
         return 0;
     }
 
+    if (enj_elf__check_frozen(symtab->section->elf, err) < 0)
+        return 0;
+
     enj_elf* elf = symtab->section->elf;
 
     // Allocate descriptor
@@ -160,6 +163,9 @@ int enj_symbol_pull(enj_symbol* sym, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(sym->symtab->section->elf, err) < 0)
+        return -1;
+
     enj_elf* elf = sym->symtab->section->elf;
 
     // Read symbol header
@@ -228,16 +234,17 @@ int enj_symbol_update(enj_symbol* sym, enj_error** err)
         return -1;
     }
 
+    if (sym->symtab->section->elf->frozen)
+        return 0;
+
     enj_elf* elf = sym->symtab->section->elf;
 
-    // Clear cached symbol name
-    if (sym->cached_name)
-    {
-        enj_fstring_delete(sym->cached_name);
-        sym->cached_name = 0;
-    }
+    // Clear cached symbol name, keeping it to tell whether it changed
+    enj_fstring* cached_name = sym->cached_name;
+    sym->cached_name = 0;
 
-    // Cache symbol name (if available)
+    // Cache symbol name (if available) ; names running past the end of the
+    //  file are expected and simply left uncached
     if (sym->name)
     {
         int name_ok = 1;
@@ -245,7 +252,7 @@ int enj_symbol_update(enj_symbol* sym, enj_error** err)
         char c;
         do
         {
-            if (enj_blob_read(elf->blob, sym->name->pos + name_len, &c, 1, err) < 0)
+            if (enj_blob_read(elf->blob, sym->name->pos + name_len, &c, 1, enj_error_quiet()) < 0)
             {
                 name_ok = 0;
                 break;
@@ -257,16 +264,19 @@ int enj_symbol_update(enj_symbol* sym, enj_error** err)
         if (name_ok)
         {
             char buffer[name_len];
-            if (enj_blob_read(elf->blob, sym->name->pos, &buffer[0], name_len, err) < 0)
-                return -1;
-
-            sym->cached_name = enj_fstring_create(&buffer[0], err);
-            if (!sym->cached_name)
+            if (enj_blob_read(elf->blob, sym->name->pos, &buffer[0], name_len, err) < 0 ||
+                !(sym->cached_name = enj_fstring_create(&buffer[0], err)))
+            {
+                enj_fstring_delete(cached_name);
                 return -1;
+            }
         }
     }
 
-    return 0;
+    int changed = !enj_fstring_equal(cached_name, sym->cached_name);
+    enj_fstring_delete(cached_name);
+
+    return changed;
 }
 
 int enj_symbol_push(enj_symbol* sym, enj_error** err)
@@ -278,6 +288,9 @@ int enj_symbol_push(enj_symbol* sym, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(sym->symtab->section->elf, err) < 0)
+        return -1;
+
     enj_elf* elf = sym->symtab->section->elf;
 
     // Update name index
@@ -296,7 +309,9 @@ int enj_symbol_push(enj_symbol* sym, enj_error** err)
         if (sh)
         {
             // Update symbol address and size
-            size_t addr = ENJ_ELF_SHDR_GET(sh, sh_addr) + (sym->target->start->pos - ENJ_ELF_SHDR_GET(sh, sh_offset));
+            // Section headers are pushed after contents, so use the section data position when known
+            size_t offset = sh->data ? sh->data->start->pos : ENJ_ELF_SHDR_GET(sh, sh_offset);
+            size_t addr = ENJ_ELF_SHDR_GET(sh, sh_addr) + (sym->target->start->pos - offset);
             ENJ_SYMBOL_SET(sym, st_value, addr);
             ENJ_SYMBOL_SET(sym, st_size, sym->target->length);
         }
@@ -326,6 +341,9 @@ int enj_symbol_rename(enj_symbol* sym, const char* name, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(sym->symtab->section->elf, err) < 0)
+        return -1;
+
     enj_elf* elf = sym->symtab->section->elf;
 
     if (!sym->symtab->strtab)
@@ -366,6 +384,9 @@ int enj_symbol_remove(enj_symbol* sym, int flags, enj_error** err)
         return -1;
     }
 
+    if (enj_elf__check_frozen(sym->symtab->section->elf, err) < 0)
+        return -1;
+
     enj_elf* elf = sym->symtab->section->elf;
 
     if (sym->name && sym->symtab->strtab)
@@ -508,6 +529,234 @@ int enj_symtab__pull(enj_elf_shdr* section, enj_error** err)
     return 0;
 }
 
+// Symbols parsed by a stage, waiting for their anchors
+typedef struct _symbol_stage
+{
+    enj_symbol* sym;
+
+    int has_target;
+    size_t target_offset;
+    size_t target_size;
+} _symbol_stage;
+
+typedef struct _symtab_stage
+{
+    size_t count;
+    _symbol_stage* entries;
+} _symtab_stage;
+
+int enj_symtab__stage(enj_elf_shdr* section, size_t part, size_t parts, void** stage, enj_error** err)
+{
+    if (!section || !section->elf || !section->elf->bits || !parts || part >= parts || !stage)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enj_elf* elf = section->elf;
+    enj_blob* blob = elf->blob;
+
+    enj_elf_shdr* strtab = enj_elf_find_shdr_by_index(elf, ENJ_ELF_SHDR_GET(section, sh_link), err);
+    if (*err)
+        return -1;
+
+    // Get the slice of the table handled by this stage
+    size_t offset = ENJ_ELF_SHDR_GET(section, sh_offset);
+    size_t entsize = ENJ_ELF_SHDR_GET(section, sh_entsize);
+    size_t size = ENJ_ELF_SHDR_GET(section, sh_size);
+    size_t count = entsize ? size / entsize : 0;
+
+    size_t first = count * part / parts;
+    size_t last = count * (part + 1) / parts;
+
+    _symtab_stage* st = enj_malloc(sizeof(_symtab_stage));
+    if (!st || (last > first && !(st->entries = enj_malloc((last - first) * sizeof(_symbol_stage)))))
+    {
+        enj_free(st);
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    *stage = st;
+
+    // Same as enj_symbol_pull, without creating anchors
+    for (size_t i = first; i < last; ++i)
+    {
+        _symbol_stage* entry = &st->entries[st->count];
+
+        enj_symbol* sym = enj_malloc(sizeof(enj_symbol));
+        if (!sym)
+        {
+            enj_error_put(err, ENJ_ERR_MALLOC);
+            return -1;
+        }
+
+        entry->sym = sym;
+        ++st->count;
+
+        sym->index = i;
+
+        size_t name, addr, sym_size, shndx, type;
+        if (elf->bits == 32)
+        {
+            if (enj_blob_read(blob, offset + i * entsize, &sym->sym32, sizeof(Elf32_Sym), err) < 0)
+                return -1;
+
+            name = sym->sym32.st_name;
+            addr = sym->sym32.st_value;
+            sym_size = sym->sym32.st_size;
+            shndx = sym->sym32.st_shndx;
+            type = ELF32_ST_TYPE(sym->sym32.st_info);
+        }
+        else
+        {
+            if (enj_blob_read(blob, offset + i * entsize, &sym->sym64, sizeof(Elf64_Sym), err) < 0)
+                return -1;
+
+            name = sym->sym64.st_name;
+            addr = sym->sym64.st_value;
+            sym_size = sym->sym64.st_size;
+            shndx = sym->sym64.st_shndx;
+            type = ELF64_ST_TYPE(sym->sym64.st_info);
+        }
+
+        // Cache the name, if it is terminated within the file
+        if (strtab)
+        {
+            size_t name_off = ENJ_ELF_SHDR_GET(strtab, sh_offset) + name;
+
+            const unsigned char* nul = 0;
+            if (name_off < blob->buffer_size)
+                nul = memchr(blob->buffer + name_off, '\0', blob->buffer_size - name_off);
+
+            if (nul)
+            {
+                size_t name_len = nul - (blob->buffer + name_off);
+                if (!(sym->cached_name = enj_fstring_create_n((const char*) blob->buffer + name_off, name_len, err)))
+                    return -1;
+            }
+        }
+
+        enj_elf_shdr* sh = enj_elf_find_shdr_by_index(elf, shndx, err);
+        if (*err)
+            return -1;
+
+        if (sh && (type == STT_OBJECT || type == STT_FUNC) && addr)
+        {
+            size_t target = ENJ_ELF_SHDR_GET(sh, sh_offset) + (addr - ENJ_ELF_SHDR_GET(sh, sh_addr));
+
+            if (target + sym_size <= blob->buffer_size)
+            {
+                entry->has_target = 1;
+                entry->target_offset = target;
+                entry->target_size = sym_size;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int enj_symtab__commit(enj_elf_shdr* section, void** stages, size_t parts, enj_error** err)
+{
+    if (!section || !section->elf || !section->elf->bits || (parts && !stages))
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        goto fail;
+    }
+
+    enj_elf* elf = section->elf;
+
+    if (section->content && enj_symtab__delete(section, err) < 0)
+        goto fail;
+
+    enj_symtab* symtab = enj_malloc(sizeof(enj_symtab));
+    if (!symtab)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        goto fail;
+    }
+
+    section->content = symtab;
+    symtab->section = section;
+    symtab->strtab = enj_elf_find_shdr_by_index(elf, ENJ_ELF_SHDR_GET(section, sh_link), err);
+    if (*err)
+        goto fail;
+
+    size_t offset = ENJ_ELF_SHDR_GET(section, sh_offset);
+    size_t entsize = ENJ_ELF_SHDR_GET(section, sh_entsize);
+
+    // Stages are in table order, create anchors as enj_symtab__pull would
+    for (size_t p = 0; p < parts; ++p)
+    {
+        _symtab_stage* st = (_symtab_stage*) stages[p];
+
+        for (size_t i = 0; st && i < st->count; ++i)
+        {
+            _symbol_stage* entry = &st->entries[i];
+            enj_symbol* sym = entry->sym;
+
+            entry->sym = 0;
+            sym->symtab = symtab;
+
+            int ok = (sym->header = enj_blob_new_anchor(elf->blob, offset + sym->index * entsize, err)) != 0;
+
+            if (ok && symtab->strtab)
+            {
+                size_t name_off = ENJ_ELF_SHDR_GET(symtab->strtab, sh_offset) + ENJ_SYMBOL_GET(sym, st_name);
+                ok = (sym->name = enj_blob_new_anchor(elf->blob, name_off, err)) != 0;
+            }
+
+            if (ok && entry->has_target)
+                ok = (sym->target = enj_blob_new_cursor(elf->blob, entry->target_offset, entry->target_size, err)) != 0;
+
+            if (!ok)
+            {
+                enj_symbol__delete(sym, 0);
+                goto fail;
+            }
+
+            sym->prev = symtab->last_symbol;
+            sym->next = 0;
+            if (sym->prev)
+                sym->prev->next = sym;
+            else
+                symtab->symbols = sym;
+            symtab->last_symbol = sym;
+        }
+    }
+
+    for (size_t p = 0; p < parts; ++p)
+        enj_symtab__discard(stages[p]);
+
+    return 0;
+
+fail:
+    for (size_t p = 0; stages && p < parts; ++p)
+        enj_symtab__discard(stages[p]);
+
+    return -1;
+}
+
+void enj_symtab__discard(void* stage)
+{
+    _symtab_stage* st = (_symtab_stage*) stage;
+    if (!st)
+        return;
+
+    for (size_t i = 0; i < st->count; ++i)
+    {
+        if (!st->entries[i].sym)
+            continue;
+
+        enj_fstring_delete(st->entries[i].sym->cached_name);
+        enj_free(st->entries[i].sym);
+    }
+
+    enj_free(st->entries);
+    enj_free(st);
+}
+
 int enj_symtab__update(enj_elf_shdr* section, enj_error** err)
 {
     if (!section || !section->content)
@@ -517,14 +766,18 @@ int enj_symtab__update(enj_elf_shdr* section, enj_error** err)
     }
 
     enj_symtab* symtab = (enj_symtab*) section->content;
+    int changed = 0;
 
     for (enj_symbol* sym = symtab->symbols; sym; sym = sym->next)
     {
-        if (enj_symbol_update(sym, err) < 0)
+        int ret = enj_symbol_update(sym, err);
+        if (ret < 0)
             return -1;
+
+        changed |= ret;
     }
 
-    return 0;
+    return changed;
 }
 
 int enj_symtab__push(enj_elf_shdr* section, enj_error** err)
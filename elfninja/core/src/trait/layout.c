@@ -19,6 +19,8 @@
 #include "elfninja/core/trait/layout.h"
 #include "elfninja/core/malloc.h"
 
+#include <stdlib.h>
+
 enj_trait_layout* enj_trait_layout_create(enj_elf* elf, enj_error** err)
 {
     if (!elf)
@@ -35,35 +37,249 @@ enj_trait_layout* enj_trait_layout_create(enj_elf* elf, enj_error** err)
     }
 
     lay->trait.arg = lay;
+    lay->trait.deps = ENJ_ELF_DEP_HEADER | ENJ_ELF_DEP_SECTIONS | ENJ_ELF_DEP_SEGMENTS | ENJ_ELF_DEP_BLOB;
     lay->trait.o_build = &enj_trait_layout__build;
+    lay->trait.o_patch = &enj_trait_layout__patch;
+
+    lay->listener.arg = lay;
+    lay->listener.o_edit = &enj_trait_layout__edit;
+
+    lay->dirty = 1;
 
     if (enj_elf_add_trait(elf, &lay->trait, err) < 0 ||
+        enj_blob_add_listener(elf->blob, &lay->listener, err) < 0 ||
         enj_trait_layout__build(lay, err) < 0)
     {
-        enj_free(lay);
+        enj_trait_layout_delete(lay);
         return 0;
     }
 
     return lay;
 }
 
+void enj_trait_layout__clear(enj_trait_layout* lay)
+{
+    for (size_t i = 0; i < lay->chunk_count; ++i)
+        enj_free(lay->index[i]);
+
+    enj_free(lay->index);
+
+    lay->index = 0;
+    lay->chunk_count = 0;
+    lay->index_capacity = 0;
+
+    lay->chunks = 0;
+    lay->last_chunk = 0;
+
+    for (size_t i = 0; i < lay->segment_count; ++i)
+        enj_free(lay->segments[i]);
+
+    enj_free(lay->segments);
+    enj_free(lay->membership);
+    enj_free(lay->loads);
+    enj_free(lay->section_keys);
+
+    lay->segments = 0;
+    lay->segment_count = 0;
+    lay->membership = 0;
+    lay->loads = 0;
+    lay->section_keys = 0;
+    lay->section_count = 0;
+}
+
 void enj_trait_layout_delete(enj_trait_layout* lay)
 {
     if (!lay)
         return;
 
-    for (enj_trait_layout_chunk* chunk = lay->chunks; chunk; )
+    enj_trait_layout__clear(lay);
+
+    if (lay->listener.blob)
+        enj_blob_remove_listener(lay->listener.blob, &lay->listener, 0);
+
+    if (lay->trait.elf)
+        enj_elf_trait_remove(&lay->trait, 0);
+
+    enj_free(lay);
+}
+
+enj_trait_layout_chunk* enj_trait_layout_find(enj_trait_layout* lay, size_t offset)
+{
+    if (!lay)
+        return 0;
+
+    // Find the last chunk starting at or before the offset
+    size_t lo = 0;
+    size_t hi = lay->chunk_count;
+
+    while (lo < hi)
     {
-        enj_trait_layout_chunk* next = chunk->next;
-        enj_free(chunk);
-        chunk = next;
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (lay->index[mid]->offset <= offset)
+            lo = mid + 1;
+        else
+            hi = mid;
     }
 
-    enj_elf_trait_remove(&lay->trait, 0);
-    enj_free(lay);
+    if (!lo)
+        return 0;
+
+    enj_trait_layout_chunk* chunk = lay->index[lo - 1];
+    if (offset >= chunk->offset + chunk->size)
+        return 0;
+
+    return chunk;
+}
+
+int enj_trait_layout_in_segment(enj_trait_layout* lay, enj_elf_phdr* segment, enj_elf_shdr* section)
+{
+    if (!lay || !lay->membership || !segment || !section ||
+        segment->index >= lay->segment_count || section->index >= lay->section_count)
+        return 0;
+
+    size_t bit = segment->index * lay->section_count + section->index;
+
+    return (lay->membership[bit / 8] >> (bit % 8)) & 1;
+}
+
+enj_elf_phdr* enj_trait_layout_load_segment(enj_trait_layout* lay, enj_elf_shdr* section)
+{
+    if (!lay || !lay->loads || !section || section->index >= lay->section_count)
+        return 0;
+
+    return lay->loads[section->index];
+}
+
+// Get the first offset not before the given one with offset = residue (mod period)
+static size_t _place(size_t offset, size_t period, size_t residue)
+{
+    return offset + (residue + period - offset % period) % period;
+}
+
+// Move a range past the segments it overlaps
+static size_t _skip_segments(enj_trait_layout* lay, size_t offset, size_t size, size_t period, size_t residue)
+{
+    for (int moved = 1; moved; )
+    {
+        moved = 0;
+
+        for (size_t i = 0; i < lay->segment_count; ++i)
+        {
+            enj_trait_layout_chunk* segment = lay->segments[i];
+
+            if (segment->size && offset < segment->offset + segment->size && segment->offset < offset + size)
+            {
+                offset = _place(segment->offset + segment->size, period, residue);
+                moved = 1;
+            }
+        }
+    }
+
+    return offset;
+}
+
+// Best-fit allocation in free chunks, eventually appending at the end of the file ;
+//  the allocated range is zeroed and reserved until the next rebuild
+size_t enj_trait_layout_alloc(enj_trait_layout* lay, size_t size, size_t align,
+                              enj_trait_layout_constraints const* constraints, enj_error** err)
+{
+    if (!lay || !lay->trait.elf || !size || (align & (align - 1)))
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return 0;
+    }
+
+    if (!align)
+        align = 1;
+
+    enj_blob* blob = lay->trait.elf->blob;
+    size_t min_offset = constraints ? constraints->min_offset : 0;
+    size_t max_offset = constraints && constraints->max_offset ? constraints->max_offset : (size_t) -1;
+    int flags = constraints ? constraints->flags : 0;
+
+    // Offsets are aligned, and eventually congruent to an address
+    size_t period = align;
+    size_t residue = 0;
+
+    if (constraints && constraints->addr_align > 1)
+    {
+        size_t addr_align = constraints->addr_align;
+
+        if ((addr_align & (addr_align - 1)) ||
+            constraints->addr % (addr_align < align ? addr_align : align))
+        {
+            enj_error_put(err, ENJ_ERR_ARGUMENT);
+            return 0;
+        }
+
+        if (addr_align > align)
+        {
+            period = addr_align;
+            residue = constraints->addr % addr_align;
+        }
+    }
+
+    enj_trait_layout_chunk* best = 0;
+    size_t best_offset = 0;
+
+    for (size_t i = 0; i < lay->chunk_count; ++i)
+    {
+        enj_trait_layout_chunk* chunk = lay->index[i];
+        if (chunk->type != ENJ_TRAIT_LAYOUT_FREE)
+            continue;
+
+        size_t begin = chunk->offset > min_offset ? chunk->offset : min_offset;
+        size_t end = chunk->offset + chunk->size < max_offset ? chunk->offset + chunk->size : max_offset;
+
+        begin = _place(begin, period, residue);
+        if (flags & ENJ_TRAIT_LAYOUT_NO_SEGMENT)
+            begin = _skip_segments(lay, begin, size, period, residue);
+
+        if (begin >= end || end - begin < size)
+            continue;
+
+        if (!best || chunk->size < best->size)
+        {
+            best = chunk;
+            best_offset = begin;
+        }
+    }
+
+    size_t offset = best_offset;
+
+    if (!best)
+    {
+        // Append at the end of the file
+        size_t end = blob->buffer_size > min_offset ? blob->buffer_size : min_offset;
+        offset = _place(end, period, residue);
+        if (flags & ENJ_TRAIT_LAYOUT_NO_SEGMENT)
+            offset = _skip_segments(lay, offset, size, period, residue);
+
+        if ((flags & ENJ_TRAIT_LAYOUT_NO_APPEND) || offset + size > max_offset)
+        {
+            enj_error_put(err, ENJ_ERR_TOO_BIG);
+            return 0;
+        }
+
+        if (enj_blob_pad(blob, blob->buffer_size, offset + size - blob->buffer_size, err) < 0)
+            return 0;
+    }
+    else if (enj_blob_set(blob, offset, 0, size, err) < 0)
+    {
+        return 0;
+    }
+
+    // Reserve the range
+    if (!enj_trait_layout__add_chunk(lay, offset, size, ENJ_TRAIT_LAYOUT_RESERVED, err) ||
+        enj_trait_layout__sort(lay, err) < 0 ||
+        enj_trait_layout__normalize(lay, err) < 0)
+        return 0;
+
+    return offset;
 }
 
-int enj_trait_layout__link_chunk(enj_trait_layout* lay, enj_trait_layout_chunk* chunk, enj_error** err)
+int enj_trait_layout__push_chunk(enj_trait_layout* lay, enj_trait_layout_chunk* chunk, enj_error** err)
 {
     if (!lay || !chunk)
     {
@@ -71,13 +287,22 @@ int enj_trait_layout__link_chunk(enj_trait_layout* lay, enj_trait_layout_chunk*
         return -1;
     }
 
-    chunk->prev = lay->last_chunk;
-    chunk->next = 0;
-    if (chunk->prev)
-        chunk->prev->next = chunk;
-    else
-        lay->chunks = chunk;
-    lay->last_chunk = chunk;
+    if (lay->chunk_count == lay->index_capacity)
+    {
+        size_t capacity = lay->index_capacity ? 2 * lay->index_capacity : 16;
+
+        enj_trait_layout_chunk** index = enj_realloc(lay->index, capacity * sizeof(enj_trait_layout_chunk*));
+        if (!index)
+        {
+            enj_error_put(err, ENJ_ERR_MALLOC);
+            return -1;
+        }
+
+        lay->index = index;
+        lay->index_capacity = capacity;
+    }
+
+    lay->index[lay->chunk_count++] = chunk;
 
     return 0;
 }
@@ -101,12 +326,32 @@ enj_trait_layout_chunk* enj_trait_layout__add_chunk(enj_trait_layout* lay, size_
     chunk->size = size;
     chunk->type = type;
 
-    if (enj_trait_layout__link_chunk(lay, chunk, err) < 0)
+    if (enj_trait_layout__push_chunk(lay, chunk, err) < 0)
+    {
+        enj_free(chunk);
         return 0;
+    }
 
     return chunk;
 }
 
+static int _compare_chunks(const void* a, const void* b)
+{
+    const enj_trait_layout_chunk* lhs = *(enj_trait_layout_chunk* const*) a;
+    const enj_trait_layout_chunk* rhs = *(enj_trait_layout_chunk* const*) b;
+
+    if (lhs->offset != rhs->offset)
+        return lhs->offset < rhs->offset ? -1 : 1;
+
+    if (lhs->type != rhs->type)
+        return lhs->type < rhs->type ? -1 : 1;
+
+    size_t lhs_index = lhs->section ? lhs->section->index : 0;
+    size_t rhs_index = rhs->section ? rhs->section->index : 0;
+
+    return lhs_index < rhs_index ? -1 : lhs_index > rhs_index;
+}
+
 int enj_trait_layout__sort(enj_trait_layout* lay, enj_error** err)
 {
     if (!lay)
@@ -115,59 +360,396 @@ int enj_trait_layout__sort(enj_trait_layout* lay, enj_error** err)
         return -1;
     }
 
-again:
-    for (enj_trait_layout_chunk* chunk = lay->chunks; chunk && chunk->next; chunk = chunk->next)
+    if (lay->chunk_count)
+        qsort(lay->index, lay->chunk_count, sizeof(enj_trait_layout_chunk*), &_compare_chunks);
+
+    return 0;
+}
+
+// Drop empty chunks, recompute free chunks from the gaps between the sorted
+//  remaining ones, then relink the chunk list in index order
+int enj_trait_layout__normalize(enj_trait_layout* lay, enj_error** err)
+{
+    if (!lay || !lay->trait.elf)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < lay->chunk_count; ++i)
     {
-        enj_trait_layout_chunk* other = chunk->next;
+        enj_trait_layout_chunk* chunk = lay->index[i];
 
-        if (chunk->offset > other->offset)
-        {
-            enj_trait_layout_chunk* pred = chunk->prev;
-            enj_trait_layout_chunk* succ = other->next;
+        if (!chunk->size || chunk->type == ENJ_TRAIT_LAYOUT_FREE)
+            enj_free(chunk);
+        else
+            lay->index[count++] = chunk;
+    }
 
-            chunk->prev = other;
-            chunk->next = succ;
+    enj_trait_layout_chunk** used = lay->index;
+    size_t used_count = count;
 
-            other->next = chunk;
-            other->prev = pred;
+    lay->index = 0;
+    lay->chunk_count = 0;
+    lay->index_capacity = 0;
 
-            if (pred)
-                pred->next = other;
-            else
-                lay->chunks = other;
+    size_t end = used_count ? used[0]->offset : 0;
 
-            if (succ)
-                succ->prev = chunk;
-            else
-                lay->last_chunk = chunk;
+    for (size_t i = 0; i < used_count; ++i)
+    {
+        enj_trait_layout_chunk* chunk = used[i];
 
-            goto again;
+        if (chunk->offset > end &&
+            !enj_trait_layout__add_chunk(lay, end, chunk->offset - end, ENJ_TRAIT_LAYOUT_FREE, err))
+            goto fail;
+
+        if (enj_trait_layout__push_chunk(lay, chunk, err) < 0)
+            goto fail;
+        used[i] = 0;
+
+        if (chunk->offset + chunk->size > end)
+            end = chunk->offset + chunk->size;
+    }
+
+    size_t buffer_size = lay->trait.elf->blob->buffer_size;
+    if (used_count && end < buffer_size &&
+        !enj_trait_layout__add_chunk(lay, end, buffer_size - end, ENJ_TRAIT_LAYOUT_FREE, err))
+        goto fail;
+
+    enj_free(used);
+
+    // Relink the list
+    lay->chunks = lay->chunk_count ? lay->index[0] : 0;
+    lay->last_chunk = lay->chunk_count ? lay->index[lay->chunk_count - 1] : 0;
+
+    for (size_t i = 0; i < lay->chunk_count; ++i)
+    {
+        lay->index[i]->prev = i ? lay->index[i - 1] : 0;
+        lay->index[i]->next = i + 1 < lay->chunk_count ? lay->index[i + 1] : 0;
+    }
+
+    return 0;
+
+fail:
+    for (size_t i = 0; i < used_count; ++i)
+        enj_free(used[i]);
+    enj_free(used);
+
+    lay->dirty = 1;
+    return -1;
+}
+
+// Look for a chunk matching exactly
+static int _has_chunk(enj_trait_layout* lay, size_t offset, size_t size, size_t type, enj_elf_shdr* section)
+{
+    size_t lo = 0;
+    size_t hi = lay->chunk_count;
+
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (lay->index[mid]->offset < offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for (size_t i = lo; i < lay->chunk_count && lay->index[i]->offset == offset; ++i)
+    {
+        enj_trait_layout_chunk* chunk = lay->index[i];
+
+        if (chunk->size == size && chunk->type == type && chunk->section == section)
+            return 1;
+    }
+
+    return 0;
+}
+
+// Look for the chunk of a segment, and check it against the program header
+static int _has_segment_chunk(enj_trait_layout* lay, enj_elf_phdr* segment)
+{
+    for (size_t i = 0; i < lay->segment_count; ++i)
+    {
+        enj_trait_layout_chunk* chunk = lay->segments[i];
+
+        if (chunk->segment == segment)
+        {
+            return chunk->offset == ENJ_ELF_PHDR_GET(segment, p_offset) &&
+                   chunk->size == ENJ_ELF_PHDR_GET(segment, p_filesz) &&
+                   chunk->addr == ENJ_ELF_PHDR_GET(segment, p_vaddr) &&
+                   chunk->mem_size == ENJ_ELF_PHDR_GET(segment, p_memsz);
         }
     }
 
     return 0;
 }
 
-int enj_trait_layout__build(void* arg, enj_error** err)
+static void _get_section_key(enj_elf_shdr* section, enj_trait_layout_section_key* key)
 {
-    enj_trait_layout* lay = (enj_trait_layout*) arg;
+    key->type = ENJ_ELF_SHDR_GET(section, sh_type);
+    key->flags = ENJ_ELF_SHDR_GET(section, sh_flags);
+    key->addr = ENJ_ELF_SHDR_GET(section, sh_addr);
+    key->size = ENJ_ELF_SHDR_GET(section, sh_size);
+}
+
+// Check the section header values the membership table was computed from,
+//  file offsets are already covered by the section chunks
+static int _has_section_key(enj_trait_layout* lay, enj_elf_shdr* section)
+{
+    enj_trait_layout_section_key key;
+    _get_section_key(section, &key);
+
+    enj_trait_layout_section_key* old = &lay->section_keys[section->index];
+
+    return key.type == old->type && key.flags == old->flags &&
+           key.addr == old->addr && key.size == old->size;
+}
+
+// Check that the chunks tracked from blob edits still match the ELF headers
+int enj_trait_layout__check(enj_trait_layout* lay)
+{
+    if (lay->dirty)
+        return 0;
+
+    enj_elf* elf = lay->trait.elf;
+    size_t expected = 0;
 
+    size_t ehsize = ENJ_ELF_EHDR_GET(elf, e_ehsize);
+    if (ehsize)
+    {
+        if (!_has_chunk(lay, 0, ehsize, ENJ_TRAIT_LAYOUT_EHDR, 0))
+            return 0;
+        ++expected;
+    }
+
+    size_t phnum = ENJ_ELF_EHDR_GET(elf, e_phnum);
+    if (phnum)
+    {
+        size_t phoff = ENJ_ELF_EHDR_GET(elf, e_phoff);
+        size_t phentsize = ENJ_ELF_EHDR_GET(elf, e_phentsize);
+
+        if (phentsize && !_has_chunk(lay, phoff, phentsize * phnum, ENJ_TRAIT_LAYOUT_PHDRS, 0))
+            return 0;
+        expected += !!phentsize;
+    }
+
+    size_t shnum = ENJ_ELF_EHDR_GET(elf, e_shnum);
+    if (shnum)
+    {
+        size_t shoff = ENJ_ELF_EHDR_GET(elf, e_shoff);
+        size_t shentsize = ENJ_ELF_EHDR_GET(elf, e_shentsize);
+
+        if (shentsize && !_has_chunk(lay, shoff, shentsize * shnum, ENJ_TRAIT_LAYOUT_SHDRS, 0))
+            return 0;
+        expected += !!shentsize;
+    }
+
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        size_t size = ENJ_ELF_SHDR_GET(section, sh_size);
+
+        if (ENJ_ELF_SHDR_GET(section, sh_type) == SHT_NOBITS || !size)
+            continue;
+
+        if (!_has_chunk(lay, ENJ_ELF_SHDR_GET(section, sh_offset), size, ENJ_TRAIT_LAYOUT_SECTION, section))
+            return 0;
+        ++expected;
+    }
+
+    size_t used = 0;
+    for (size_t i = 0; i < lay->chunk_count; ++i)
+        used += lay->index[i]->type != ENJ_TRAIT_LAYOUT_FREE;
+
+    if (used != expected)
+        return 0;
+
+    // Segment chunks and the membership table
+    size_t segment_count = 0;
+    for (enj_elf_phdr* segment = elf->segments; segment; segment = segment->next)
+    {
+        if (!_has_segment_chunk(lay, segment))
+            return 0;
+        ++segment_count;
+    }
+
+    if (segment_count != lay->segment_count)
+        return 0;
+
+    size_t section_count = 0;
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        if (section->index >= lay->section_count ||
+            !_has_section_key(lay, section))
+            return 0;
+        ++section_count;
+    }
+
+    return section_count == lay->section_count;
+}
+
+static int _compare_segment_chunks(const void* a, const void* b)
+{
+    const enj_trait_layout_chunk* lhs = *(enj_trait_layout_chunk* const*) a;
+    const enj_trait_layout_chunk* rhs = *(enj_trait_layout_chunk* const*) b;
+
+    if (lhs->offset != rhs->offset)
+        return lhs->offset < rhs->offset ? -1 : 1;
+
+    return lhs->segment->index < rhs->segment->index ? -1 : lhs->segment->index > rhs->segment->index;
+}
+
+// Same rules as binutils' ELF_SECTION_IN_SEGMENT : TLS sections only go in
+//  PT_TLS and loadable segments, .tbss only in PT_TLS, unallocated sections
+//  never in segments describing the memory image ; the section must then fit
+//  both in the file image and in the memory image of the segment
+static int _section_in_segment(enj_elf_shdr* section, enj_trait_layout_chunk* chunk)
+{
+    size_t p_type = ENJ_ELF_PHDR_GET(chunk->segment, p_type);
+    size_t type = ENJ_ELF_SHDR_GET(section, sh_type);
+    size_t flags = ENJ_ELF_SHDR_GET(section, sh_flags);
+    size_t size = ENJ_ELF_SHDR_GET(section, sh_size);
+
+    if (flags & SHF_TLS)
+    {
+        if (p_type != PT_TLS && p_type != PT_LOAD && p_type != PT_GNU_RELRO)
+            return 0;
+
+        if (type == SHT_NOBITS && p_type != PT_TLS)
+            return 0;
+    }
+    else if (p_type == PT_TLS)
+    {
+        return 0;
+    }
+
+    if (!(flags & SHF_ALLOC) &&
+        (p_type == PT_LOAD || p_type == PT_DYNAMIC || p_type == PT_GNU_EH_FRAME || p_type == PT_GNU_RELRO))
+        return 0;
+
+    if (type != SHT_NOBITS)
+    {
+        size_t offset = ENJ_ELF_SHDR_GET(section, sh_offset);
+
+        if (offset < chunk->offset || offset - chunk->offset > chunk->size ||
+            size > chunk->size - (offset - chunk->offset))
+            return 0;
+
+        // Empty sections at the very end of a segment are not part of it
+        if (!size && chunk->size && offset - chunk->offset == chunk->size)
+            return 0;
+    }
+
+    if (flags & SHF_ALLOC)
+    {
+        size_t addr = ENJ_ELF_SHDR_GET(section, sh_addr);
+
+        if (addr < chunk->addr || addr - chunk->addr > chunk->mem_size ||
+            size > chunk->mem_size - (addr - chunk->addr))
+            return 0;
+
+        if (!size && chunk->mem_size && addr - chunk->addr == chunk->mem_size)
+            return 0;
+    }
+
+    return 1;
+}
+
+// Compute the section <-> segment membership table
+int enj_trait_layout__map(enj_trait_layout* lay, enj_error** err)
+{
     if (!lay || !lay->trait.elf)
     {
         enj_error_put(err, ENJ_ERR_ARGUMENT);
         return -1;
     }
 
-    // Remove all chunks
-    for (enj_trait_layout_chunk* chunk = lay->chunks; chunk; )
+    enj_elf* elf = lay->trait.elf;
+
+    size_t section_count = 0;
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
     {
-        enj_trait_layout_chunk* next = chunk->next;
-        enj_free(chunk);
-        chunk = next;
+        if (section->index + 1 > section_count)
+            section_count = section->index + 1;
     }
 
-    lay->chunks = 0;
-    lay->last_chunk = 0;
+    enj_free(lay->membership);
+    enj_free(lay->loads);
+    enj_free(lay->section_keys);
+
+    lay->membership = 0;
+    lay->loads = 0;
+    lay->section_keys = 0;
+    lay->section_count = 0;
+
+    if (!section_count)
+        return 0;
+
+    size_t segment_count = 0;
+    for (size_t i = 0; i < lay->segment_count; ++i)
+    {
+        if (lay->segments[i]->segment->index + 1 > segment_count)
+            segment_count = lay->segments[i]->segment->index + 1;
+    }
+
+    // Segment indices are expected to be contiguous
+    if (segment_count != lay->segment_count)
+    {
+        enj_error_put(err, ENJ_ERR_BAD_INDEX);
+        return -1;
+    }
+
+    lay->membership = enj_malloc(segment_count * section_count / 8 + 1);
+    lay->loads = enj_malloc(section_count * sizeof(enj_elf_phdr*));
+    lay->section_keys = enj_malloc(section_count * sizeof(enj_trait_layout_section_key));
+
+    if (!lay->membership || !lay->loads || !lay->section_keys)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    lay->section_count = section_count;
+
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        _get_section_key(section, &lay->section_keys[section->index]);
+
+        // The null section is not part of any segment
+        if (!section->index)
+            continue;
+
+        for (size_t i = 0; i < lay->segment_count; ++i)
+        {
+            enj_trait_layout_chunk* chunk = lay->segments[i];
+
+            if (!_section_in_segment(section, chunk))
+                continue;
+
+            size_t bit = chunk->segment->index * section_count + section->index;
+            lay->membership[bit / 8] |= 1 << (bit % 8);
+
+            // Segments are sorted by offset, keep the first PT_LOAD
+            if (!lay->loads[section->index] && ENJ_ELF_PHDR_GET(chunk->segment, p_type) == PT_LOAD)
+                lay->loads[section->index] = chunk->segment;
+        }
+    }
+
+    return 0;
+}
+
+int enj_trait_layout__rebuild(enj_trait_layout* lay, enj_error** err)
+{
+    if (!lay || !lay->trait.elf)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    // Remove all chunks
+    enj_trait_layout__clear(lay);
+    lay->dirty = 1;
 
     enj_trait_layout_chunk* chunk;
 
@@ -194,7 +776,7 @@ int enj_trait_layout__build(void* arg, enj_error** err)
         return -1;
 
     // Process sections
-    for (enj_elf_shdr* section = lay->trait.elf->sections; section && lay->chunks; section = section->next)
+    for (enj_elf_shdr* section = lay->trait.elf->sections; section; section = section->next)
     {
         if (ENJ_ELF_SHDR_GET(section, sh_type) == SHT_NOBITS)
             continue;
@@ -211,46 +793,155 @@ int enj_trait_layout__build(void* arg, enj_error** err)
         chunk->section = section;
     }
 
-    if (enj_trait_layout__sort(lay, err) < 0)
-        return -1;
-
-    enj_trait_layout_chunk* last_chunk = lay->last_chunk;
+    // Segments are kept in their own index
+    size_t segment_count = 0;
+    for (enj_elf_phdr* segment = lay->trait.elf->segments; segment; segment = segment->next)
+        ++segment_count;
 
-    for (enj_trait_layout_chunk* chunk = lay->chunks; chunk && chunk->next && chunk != last_chunk; chunk = chunk->next)
+    if (segment_count && !(lay->segments = enj_malloc(segment_count * sizeof(enj_trait_layout_chunk*))))
     {
-        size_t end = chunk->offset + chunk->size;
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
 
-        if (end == chunk->next->offset)
+    for (enj_elf_phdr* segment = lay->trait.elf->segments; segment; segment = segment->next)
+    {
+        if (!(chunk = enj_malloc(sizeof(enj_trait_layout_chunk))))
         {
-            continue;
+            enj_error_put(err, ENJ_ERR_MALLOC);
+            return -1;
         }
-        else if (end < chunk->next->offset)
-        {
-            size_t gap_size = chunk->next->offset - end;
 
-            if (!enj_trait_layout__add_chunk(lay, end, gap_size, ENJ_TRAIT_LAYOUT_FREE, err))
-                return -1;
-        }
+        chunk->offset = ENJ_ELF_PHDR_GET(segment, p_offset);
+        chunk->size = ENJ_ELF_PHDR_GET(segment, p_filesz);
+        chunk->type = ENJ_TRAIT_LAYOUT_SEGMENT;
+        chunk->segment = segment;
+        chunk->addr = ENJ_ELF_PHDR_GET(segment, p_vaddr);
+        chunk->mem_size = ENJ_ELF_PHDR_GET(segment, p_memsz);
+
+        lay->segments[lay->segment_count++] = chunk;
     }
 
-    if (enj_trait_layout__sort(lay, err) < 0)
+    if (lay->segment_count)
+        qsort(lay->segments, lay->segment_count, sizeof(enj_trait_layout_chunk*), &_compare_segment_chunks);
+
+    if (enj_trait_layout__sort(lay, err) < 0 ||
+        enj_trait_layout__normalize(lay, err) < 0 ||
+        enj_trait_layout__map(lay, err) < 0)
         return -1;
 
-    if (lay->last_chunk)
+    lay->dirty = 0;
+
+    return 0;
+}
+
+int enj_trait_layout__build(void* arg, enj_error** err)
+{
+    enj_trait_layout* lay = (enj_trait_layout*) arg;
+
+    if (!lay || !lay->trait.elf)
     {
-        enj_trait_layout_chunk* chunk = lay->last_chunk;
-        size_t end = chunk->offset + chunk->size;
-        if (end < lay->trait.elf->blob->buffer_size)
-        {
-            size_t gap_size = lay->trait.elf->blob->buffer_size - end;
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
 
-            if (!enj_trait_layout__add_chunk(lay, end, gap_size, ENJ_TRAIT_LAYOUT_FREE, err))
-                return -1;
-        }
+    // Nothing to do if blob edits kept the chunks up to date
+    if (enj_trait_layout__check(lay))
+        return 0;
+
+    return enj_trait_layout__rebuild(lay, err);
+}
+
+static int _shift_chunk(enj_trait_layout_chunk* chunk, int edit, size_t start, size_t length)
+{
+    size_t begin = chunk->offset;
+    size_t end = chunk->offset + chunk->size;
+
+    switch (edit)
+    {
+        case ENJ_BLOB_EDIT_INSERT:
+            if (begin > start)
+                begin += length;
+            if (end >= start)
+                end += length;
+            break;
+
+        case ENJ_BLOB_EDIT_PAD:
+            if (begin >= start)
+                begin += length;
+            if (end > start)
+                end += length;
+            break;
+
+        case ENJ_BLOB_EDIT_REMOVE:
+            if (begin > start)
+                begin = begin < start + length ? start : begin - length;
+            if (end > start)
+                end = end < start + length ? start : end - length;
+            break;
+
+        default:
+            return -1;
     }
 
-    if (enj_trait_layout__sort(lay, err) < 0)
-        return -1;
+    chunk->offset = begin;
+    chunk->size = end - begin;
 
     return 0;
 }
+
+// Blob edits are already applied by the listener as they happen, only ask
+//  for a full build when one of them could not be tracked
+int enj_trait_layout__patch(void* arg, int edit, size_t start, size_t length, enj_error** err)
+{
+    enj_trait_layout* lay = (enj_trait_layout*) arg;
+
+    if (!lay)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    return lay->dirty;
+}
+
+int enj_trait_layout__edit(void* arg, int edit, size_t start, size_t length, enj_error** err)
+{
+    enj_trait_layout* lay = (enj_trait_layout*) arg;
+
+    if (!lay || !lay->trait.elf)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (lay->dirty)
+        return 0;
+
+    // Moves do not change the layout by themselves
+    if (edit == ENJ_BLOB_EDIT_MOVE)
+        return 0;
+
+    // Shift chunk bounds the same way blob anchors are shifted ; as these maps
+    //  are monotonic, the indices stay sorted
+    for (size_t i = 0; i < lay->chunk_count; ++i)
+    {
+        if (_shift_chunk(lay->index[i], edit, start, length) < 0)
+        {
+            lay->dirty = 1;
+            return 0;
+        }
+    }
+
+    // Membership only depends on relative positions, which are preserved
+    for (size_t i = 0; i < lay->segment_count; ++i)
+    {
+        if (_shift_chunk(lay->segments[i], edit, start, length) < 0)
+        {
+            lay->dirty = 1;
+            return 0;
+        }
+    }
+
+    return enj_trait_layout__normalize(lay, err);
+}
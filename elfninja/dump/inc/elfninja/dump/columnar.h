@@ -0,0 +1,59 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ELFNINJA_DUMP_COLUMNAR_H__
+#define __ELFNINJA_DUMP_COLUMNAR_H__
+
+#include "elfninja/core/error.h"
+#include "elfninja/core/elf.h"
+#include "elfninja/core/symtab.h"
+
+// Columnar files hold one typed array per field, for bulk loading into
+//   analytics stores. All integers are little-endian. A file starts with :
+//     char magic[8]       "ENJCOLS\0"
+//     u32 version         ENJD_COLUMNAR_VERSION
+//     u32 column_count
+//     u64 row_count
+//   followed by column_count descriptors of 48 bytes :
+//     char name[24]       null-padded
+//     u32 type            ENJD_COLUMN_*
+//     u32 width           bytes per value, 0 for BYTES
+//     u64 offset          from the start of the file, 8-byte aligned
+//     u64 length          in bytes
+//   and then the column data. OFFSETS columns hold row_count + 1 values,
+//   row i spanning [offsets[i], offsets[i + 1]) of the BYTES column right
+//   after them ; strings in there are not null-terminated.
+// Columns are listed in columnar.def.
+
+#define ENJD_COLUMNAR_MAGIC "ENJCOLS"
+#define ENJD_COLUMNAR_VERSION 1
+
+enum
+{
+    ENJD_COLUMN_U8 = 1,
+    ENJD_COLUMN_U16,
+    ENJD_COLUMN_U32,
+    ENJD_COLUMN_U64,
+    ENJD_COLUMN_OFFSETS,
+    ENJD_COLUMN_BYTES
+};
+
+int enjd_columnar_write_symbols(enj_symbol** symbols, size_t count, int fd, enj_error** err);
+int enjd_columnar_write_sections(enj_elf_shdr** sections, size_t count, int fd, enj_error** err);
+
+#endif // __ELFNINJA_DUMP_COLUMNAR_H__
@@ -16,6 +16,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "elfninja/dump/sink.h"
+#include "elfninja/dump/render.h"
 #include "elfninja/dump/formatter.h"
 #include "elfninja/dump/ehdr.h"
 #include "elfninja/dump/shdr.h"
@@ -25,3 +27,4 @@
 #include "elfninja/dump/dynamic_entry.h"
 #include "elfninja/dump/strings.h"
 #include "elfninja/dump/hex.h"
+#include "elfninja/dump/columnar.h"
@@ -21,8 +21,7 @@
 
 #include "elfninja/core/error.h"
 #include "elfninja/core/fstring.h"
-
-#include <stdio.h>
+#include "elfninja/dump/sink.h"
 
 #define ENJ_DUMP_FORMAT_ESCAPE_CHAR '`'
 #define ENJ_DUMP_FORMAT_MODIFIER_CHAR '!'
@@ -30,12 +29,40 @@
 struct enjd_formatter;
 struct enjd_formatter_elem;
 
-typedef int(*enjd_formatter_handler_t)(void*, void*, int fd, int width, char pad, enj_error**);
+// Value types of elements, used by record outputs to write integers as
+//   numbers (elements always render their value as text)
+enum
+{
+    ENJD_FIELD_STRING,
+    ENJD_FIELD_HEX,
+    ENJD_FIELD_DEC,
+    // Letters at fixed positions, blank when unset (as for short flags) ;
+    //   records leave the blanks out
+    ENJD_FIELD_LETTERS
+};
+
+// Output kinds of compiled programs ; columnar outputs are written from
+//   the ELF structures directly (see columnar.h), not by programs
+enum
+{
+    ENJD_OUTPUT_TEXT,
+    ENJD_OUTPUT_JSONL,
+    ENJD_OUTPUT_CSV,
+    ENJD_OUTPUT_COLUMNAR
+};
+
+typedef int(*enjd_formatter_handler_t)(void*, void*, enjd_sink* sink, int width, char pad, enj_error**);
+
+// Gives the value type of an element for a given record, for elements
+//   whose values are not all of the same type
+typedef int(*enjd_formatter_type_handler_t)(void*, void*);
 
 typedef struct enjd_formatter_elem {
     struct enjd_formatter* fmt;
 
     enj_fstring* name;
+    int type;
+    enjd_formatter_type_handler_t type_handler;
     enjd_formatter_handler_t handler;
     void* arg0;
 
@@ -57,11 +84,50 @@ enjd_formatter* enjd_formatter_create(enj_error** err);
 void enjd_formatter_delete(enjd_formatter* fmt);
 
 enjd_formatter_elem* enjd_formatter_new_elem(enjd_formatter* fmt, const char* name, enjd_formatter_handler_t handler, void* arg0, enj_error** err);
+enjd_formatter_elem* enjd_formatter_new_typed_elem(enjd_formatter* fmt, const char* name, int type, enjd_formatter_handler_t handler, void* arg0, enj_error** err);
 int enjd_formatter_remove_elem(enjd_formatter* fmt, enjd_formatter_elem* elem, enj_error** err);
 enjd_formatter_elem* enjd_formatter_find_elem(enjd_formatter* fmt, const char* name, enj_error** err);
 
-int enjd_formatter_run(enjd_formatter* fmt, const char* string, void* arg1, int fd, enj_error** err);
+// Format strings can be compiled once into programs, a flat list of
+//  literal spans and resolved element handlers, then run for each record.
+typedef struct enjd_program_op
+{
+    // Literal span (when there's no handler)
+    const char* literal;
+    size_t length;
+
+    // Element
+    const enjd_formatter_elem* elem;
+    enjd_formatter_handler_t handler;
+    void* arg0;
+    int width;
+    char pad;
+} enjd_program_op;
+
+typedef struct enjd_program
+{
+    enjd_formatter* fmt;
+    char* string;
+
+    enjd_program_op* ops;
+    size_t op_count;
+    size_t op_capacity;
+
+    // Record outputs render each value in scratch before quoting it
+    int output;
+    int header_done;
+    enjd_sink* scratch;
+} enjd_program;
+
+enjd_program* enjd_formatter_compile(enjd_formatter* fmt, const char* string, enj_error** err);
+
+// Programs writing one JSON object or CSV row per record, with the elements
+//   used in string (literals and widths are ignored), or all of them if
+//   string is null. CSV programs write a header row before the first record.
+enjd_program* enjd_formatter_compile_records(enjd_formatter* fmt, const char* string, int output, enj_error** err);
+void enjd_program_delete(enjd_program* prog);
+int enjd_program_run(enjd_program* prog, void* arg1, enjd_sink* sink, enj_error** err);
 
-void enjd_padded_fprintf(FILE* f, int width, char pad, const char* fmt, ...) __attribute__ ((format(printf, 4, 5)));
+int enjd_formatter_run(enjd_formatter* fmt, const char* string, void* arg1, enjd_sink* sink, enj_error** err);
 
 #endif // __ELFNINJA_DUMP_FORMATTER_H__
@@ -21,6 +21,7 @@
 
 #include "elfninja/core/error.h"
 #include "elfninja/core/elf.h"
+#include "elfninja/dump/sink.h"
 
 #include <sys/types.h>
 
@@ -40,6 +41,8 @@ typedef struct enjd_hex_dumper
 enjd_hex_dumper* enjd_hex_dumper_create(enj_error** err);
 void enjd_hex_dumper_delete(enjd_hex_dumper* hd);
 
+// Dump into a sink, the fd variant writing straight to a file descriptor
+int enjd_hex_dumper_run_sink(enjd_hex_dumper* hd, void const* data, size_t length, enjd_sink* sink, enj_error** err);
 int enjd_hex_dumper_run(enjd_hex_dumper* hd, void const* data, size_t length, int fd, enj_error** err);
 
 #endif // __ELFNINJA_DUMP_HEX_H__
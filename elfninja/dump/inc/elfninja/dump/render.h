@@ -0,0 +1,63 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ELFNINJA_DUMP_RENDER_H__
+#define __ELFNINJA_DUMP_RENDER_H__
+
+#include "elfninja/dump/sink.h"
+
+#include <stdint.h>
+
+// Allocation-free field rendering, directly into sink buffers : integers
+//   are converted using digit tables and padding is done by memset().
+// As for enjd_sink_padded_printf(), a negative width right-aligns the field.
+
+enum
+{
+    ENJD_NAMES_STT,
+    ENJD_NAMES_STB,
+    ENJD_NAMES_STV,
+    ENJD_NAMES_SHN,
+    ENJD_NAMES_SHT,
+    ENJD_NAMES_PT
+};
+
+typedef struct enjd_render_name
+{
+    int table;
+    uint64_t value;
+    const char* string;
+    size_t length;
+} enjd_render_name;
+
+const enjd_render_name* enjd_render_find_name(int table, uint64_t value);
+
+#define enjd_render_literal(sink, string) \
+    enjd_sink_write((sink), (string), sizeof(string) - 1)
+
+void enjd_render_string(enjd_sink* sink, const char* string, size_t length, int width, char pad);
+void enjd_render_hex(enjd_sink* sink, uint64_t value, int digits);
+void enjd_render_dec(enjd_sink* sink, int64_t value, int width, char pad);
+void enjd_render_udec(enjd_sink* sink, uint64_t value);
+int enjd_render_name_of(enjd_sink* sink, int table, uint64_t value, int width, char pad);
+
+// Quoted and escaped values for record outputs (JSON Lines and CSV)
+void enjd_render_json_string(enjd_sink* sink, const char* string, size_t length);
+void enjd_render_csv_string(enjd_sink* sink, const char* string, size_t length);
+
+#endif // __ELFNINJA_DUMP_RENDER_H__
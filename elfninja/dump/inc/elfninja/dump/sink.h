@@ -0,0 +1,62 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ELFNINJA_DUMP_SINK_H__
+#define __ELFNINJA_DUMP_SINK_H__
+
+#include "elfninja/core/error.h"
+
+#include <stddef.h>
+
+#define ENJD_SINK_BUFFER_SIZE (64 * 1024)
+
+// Output sinks buffer formatted text in userspace : fd sinks write their
+//  buffer out once it is full or when flushed, memory sinks grow it and keep
+//  everything for the caller (see buffer and length).
+// Writes do not report errors ; like stdio streams, the first failure is
+//  kept in the sink, later writes are dropped, and the error is handed over
+//  by enjd_sink_error() or enjd_sink_flush().
+typedef struct enjd_sink
+{
+    int fd;
+    char* buffer;
+    size_t length;
+    size_t capacity;
+
+    enj_error* error;
+} enjd_sink;
+
+enjd_sink* enjd_sink_create_fd(int fd, enj_error** err);
+enjd_sink* enjd_sink_create_memory(enj_error** err);
+void enjd_sink_delete(enjd_sink* sink);
+
+void enjd_sink_write(enjd_sink* sink, const void* data, size_t length);
+void enjd_sink_putc(enjd_sink* sink, char c);
+void enjd_sink_pad(enjd_sink* sink, char pad, size_t count);
+void enjd_sink_printf(enjd_sink* sink, const char* fmt, ...) __attribute__ ((format(printf, 2, 3)));
+void enjd_sink_padded_printf(enjd_sink* sink, int width, char pad, const char* fmt, ...) __attribute__ ((format(printf, 4, 5)));
+
+// Get room for length bytes at the end of the buffer ; the caller fills
+//   it and then adds what was written to the sink's length
+char* enjd_sink_reserve(enjd_sink* sink, size_t length);
+
+void enjd_sink_reset(enjd_sink* sink);
+int enjd_sink_error(enjd_sink* sink, enj_error** err);
+int enjd_sink_flush(enjd_sink* sink, enj_error** err);
+
+#endif // __ELFNINJA_DUMP_SINK_H__
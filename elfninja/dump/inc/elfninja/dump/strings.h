@@ -21,6 +21,7 @@
 
 #include "elfninja/core/error.h"
 #include "elfninja/core/elf.h"
+#include "elfninja/dump/sink.h"
 
 typedef struct enjd_strings_dumper
 {
@@ -33,6 +34,8 @@ typedef struct enjd_strings_dumper
 enjd_strings_dumper* enjd_strings_dumper_create(enj_error** err);
 void enjd_strings_dumper_delete(enjd_strings_dumper* sd);
 
+// Dump into a sink, the fd variant writing straight to a file descriptor
+int enjd_strings_dumper_run_sink(enjd_strings_dumper* sd, void const* data, size_t length, enjd_sink* sink, enj_error** err);
 int enjd_strings_dumper_run(enjd_strings_dumper* sd, void const* data, size_t length, int fd, enj_error** err);
 
 #endif // __ELFNINJA_DUMP_STRINGS_H__
@@ -0,0 +1,269 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "elfninja/dump/columnar.h"
+#include "elfninja/dump/sink.h"
+
+#include <string.h>
+#include <stdint.h>
+
+enum
+{
+    #define DEF_SYMBOL_COLUMN(name, ident, type) SYMBOL_COLUMN_ ## ident,
+    #include "elfninja/dump/columnar.def"
+};
+
+enum
+{
+    #define DEF_SECTION_COLUMN(name, ident, type) SECTION_COLUMN_ ## ident,
+    #include "elfninja/dump/columnar.def"
+};
+
+typedef struct _column
+{
+    const char* name;
+    int ident;
+    int type;
+} _column;
+
+static const _column _symbol_columns[] =
+{
+    #define DEF_SYMBOL_COLUMN(name, ident, type) { name, SYMBOL_COLUMN_ ## ident, ENJD_COLUMN_ ## type },
+    #include "elfninja/dump/columnar.def"
+};
+
+static const _column _section_columns[] =
+{
+    #define DEF_SECTION_COLUMN(name, ident, type) { name, SECTION_COLUMN_ ## ident, ENJD_COLUMN_ ## type },
+    #include "elfninja/dump/columnar.def"
+};
+
+// Accessors for the values of a row
+typedef uint64_t (*_value_getter)(const void* row, int ident);
+typedef const char* (*_name_getter)(const void* row, size_t* length);
+
+#define _HEADER_SIZE 24
+#define _DESCRIPTOR_SIZE 48
+
+static size_t _type_width(int type)
+{
+    switch (type)
+    {
+        case ENJD_COLUMN_U8:      return 1;
+        case ENJD_COLUMN_U16:     return 2;
+        case ENJD_COLUMN_U32:     return 4;
+        case ENJD_COLUMN_U64:     return 8;
+        case ENJD_COLUMN_OFFSETS: return 8;
+    }
+
+    return 0;
+}
+
+static void _put_le(char* out, uint64_t value, size_t width)
+{
+    for (size_t i = 0; i < width; ++i)
+        out[i] = (char) (value >> (8 * i));
+}
+
+static void _write_le(enjd_sink* sink, uint64_t value, size_t width)
+{
+    char* out = enjd_sink_reserve(sink, width);
+    if (!out)
+        return;
+
+    _put_le(out, value, width);
+    sink->length += width;
+}
+
+static int _write_columns(const _column* columns, size_t column_count, void* const* rows, size_t count,
+                          _value_getter get_value, _name_getter get_name, int fd, enj_error** err)
+{
+    size_t length;
+
+    // The name blob is the only column whose size is not known upfront
+    uint64_t names_length = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        get_name(rows[i], &length);
+        names_length += length;
+    }
+
+    enjd_sink* sink = enjd_sink_create_fd(fd, err);
+    if (!sink)
+        return -1;
+
+    char header[_HEADER_SIZE] = { 0 };
+    memcpy(&header[0], ENJD_COLUMNAR_MAGIC, sizeof(ENJD_COLUMNAR_MAGIC));
+    _put_le(&header[8], ENJD_COLUMNAR_VERSION, 4);
+    _put_le(&header[12], column_count, 4);
+    _put_le(&header[16], count, 8);
+    enjd_sink_write(sink, &header[0], sizeof(header));
+
+    // Column data is laid out right after the descriptors
+    uint64_t offset = _HEADER_SIZE + _DESCRIPTOR_SIZE * column_count;
+    for (size_t c = 0; c < column_count; ++c)
+    {
+        size_t width = _type_width(columns[c].type);
+        uint64_t column_length = columns[c].type == ENJD_COLUMN_BYTES ? names_length :
+                                 columns[c].type == ENJD_COLUMN_OFFSETS ? width * (count + 1) :
+                                 width * count;
+
+        char descriptor[_DESCRIPTOR_SIZE] = { 0 };
+        strncpy(&descriptor[0], columns[c].name, 24);
+        _put_le(&descriptor[24], columns[c].type, 4);
+        _put_le(&descriptor[28], columns[c].type == ENJD_COLUMN_BYTES ? 0 : width, 4);
+        _put_le(&descriptor[32], offset, 8);
+        _put_le(&descriptor[40], column_length, 8);
+        enjd_sink_write(sink, &descriptor[0], sizeof(descriptor));
+
+        offset += (column_length + 7) & ~(uint64_t) 7;
+    }
+
+    for (size_t c = 0; c < column_count && !sink->error; ++c)
+    {
+        size_t width = _type_width(columns[c].type);
+        uint64_t column_length = 0;
+
+        switch (columns[c].type)
+        {
+            case ENJD_COLUMN_BYTES:
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const char* name = get_name(rows[i], &length);
+                    enjd_sink_write(sink, name, length);
+                    column_length += length;
+                }
+                break;
+
+            case ENJD_COLUMN_OFFSETS:
+                _write_le(sink, 0, width);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    get_name(rows[i], &length);
+                    column_length += length;
+                    _write_le(sink, column_length, width);
+                }
+                column_length = width * (count + 1);
+                break;
+
+            default:
+                for (size_t i = 0; i < count; ++i)
+                    _write_le(sink, get_value(rows[i], columns[c].ident), width);
+                column_length = width * count;
+                break;
+        }
+
+        enjd_sink_pad(sink, '\0', ((column_length + 7) & ~(uint64_t) 7) - column_length);
+    }
+
+    int ret = enjd_sink_flush(sink, err);
+    enjd_sink_delete(sink);
+
+    return ret;
+}
+
+static uint64_t _symbol_value(const void* row, int ident)
+{
+    const enj_symbol* sym = row;
+
+    switch (ident)
+    {
+        case SYMBOL_COLUMN_TABLE: return sym->symtab->section->index;
+        case SYMBOL_COLUMN_INDEX: return sym->index;
+        case SYMBOL_COLUMN_VALUE: return ENJ_SYMBOL_GET(sym, st_value);
+        case SYMBOL_COLUMN_SIZE:  return ENJ_SYMBOL_GET(sym, st_size);
+        case SYMBOL_COLUMN_INFO:  return ENJ_SYMBOL_GET(sym, st_info);
+        case SYMBOL_COLUMN_OTHER: return ENJ_SYMBOL_GET(sym, st_other);
+        case SYMBOL_COLUMN_SHNDX: return ENJ_SYMBOL_GET(sym, st_shndx);
+    }
+
+    return 0;
+}
+
+static const char* _symbol_name(const void* row, size_t* length)
+{
+    const enj_symbol* sym = row;
+
+    if (!sym->cached_name)
+    {
+        *length = 0;
+        return "";
+    }
+
+    *length = sym->cached_name->length - 1;
+    return sym->cached_name->string;
+}
+
+static uint64_t _section_value(const void* row, int ident)
+{
+    const enj_elf_shdr* section = row;
+
+    switch (ident)
+    {
+        case SECTION_COLUMN_INDEX:     return section->index;
+        case SECTION_COLUMN_TYPE:      return ENJ_ELF_SHDR_GET(section, sh_type);
+        case SECTION_COLUMN_FLAGS:     return ENJ_ELF_SHDR_GET(section, sh_flags);
+        case SECTION_COLUMN_ADDR:      return ENJ_ELF_SHDR_GET(section, sh_addr);
+        case SECTION_COLUMN_OFFSET:    return ENJ_ELF_SHDR_GET(section, sh_offset);
+        case SECTION_COLUMN_SIZE:      return ENJ_ELF_SHDR_GET(section, sh_size);
+        case SECTION_COLUMN_LINK:      return ENJ_ELF_SHDR_GET(section, sh_link);
+        case SECTION_COLUMN_INFO:      return ENJ_ELF_SHDR_GET(section, sh_info);
+        case SECTION_COLUMN_ADDRALIGN: return ENJ_ELF_SHDR_GET(section, sh_addralign);
+        case SECTION_COLUMN_ENTSIZE:   return ENJ_ELF_SHDR_GET(section, sh_entsize);
+    }
+
+    return 0;
+}
+
+static const char* _section_name(const void* row, size_t* length)
+{
+    const enj_elf_shdr* section = row;
+
+    if (!section->cached_name)
+    {
+        *length = 0;
+        return "";
+    }
+
+    *length = section->cached_name->length - 1;
+    return section->cached_name->string;
+}
+
+int enjd_columnar_write_symbols(enj_symbol** symbols, size_t count, int fd, enj_error** err)
+{
+    if ((count && !symbols) || fd < 0)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    return _write_columns(&_symbol_columns[0], sizeof(_symbol_columns) / sizeof(_symbol_columns[0]),
+                          (void* const*) symbols, count, &_symbol_value, &_symbol_name, fd, err);
+}
+
+int enjd_columnar_write_sections(enj_elf_shdr** sections, size_t count, int fd, enj_error** err)
+{
+    if ((count && !sections) || fd < 0)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    return _write_columns(&_section_columns[0], sizeof(_section_columns) / sizeof(_section_columns[0]),
+                          (void* const*) sections, count, &_section_value, &_section_name, fd, err);
+}
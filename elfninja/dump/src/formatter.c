@@ -17,12 +17,11 @@
  */
 
 #include "elfninja/dump/formatter.h"
+#include "elfninja/dump/render.h"
 #include "elfninja/core/malloc.h"
 
 #include <string.h>
 #include <ctype.h>
-#include <unistd.h>
-#include <stdarg.h>
 
 enjd_formatter* enjd_formatter_create(enj_error** err)
 {
@@ -60,7 +59,12 @@ void enjd_formatter_delete(enjd_formatter* fmt)
 
 enjd_formatter_elem* enjd_formatter_new_elem(enjd_formatter* fmt, const char* name, enjd_formatter_handler_t handler, void* arg0, enj_error** err)
 {
-    if (!fmt || !name || !handler)
+    return enjd_formatter_new_typed_elem(fmt, name, ENJD_FIELD_STRING, handler, arg0, err);
+}
+
+enjd_formatter_elem* enjd_formatter_new_typed_elem(enjd_formatter* fmt, const char* name, int type, enjd_formatter_handler_t handler, void* arg0, enj_error** err)
+{
+    if (!fmt || !name || !handler || type < ENJD_FIELD_STRING || type > ENJD_FIELD_LETTERS)
     {
         enj_error_put(err, ENJ_ERR_ARGUMENT);
         return 0;
@@ -90,6 +94,8 @@ enjd_formatter_elem* enjd_formatter_new_elem(enjd_formatter* fmt, const char* na
     }
 
     elem->fmt = fmt;
+    elem->type = type;
+    elem->type_handler = 0;
     elem->handler = handler;
     elem->arg0 = arg0;
     elem->prev = fmt->last_elem;
@@ -151,31 +157,80 @@ enjd_formatter_elem* enjd_formatter_find_elem(enjd_formatter* fmt, const char* n
     return 0;
 }
 
-int enjd_formatter_run(enjd_formatter* fmt, const char* string, void* arg1, int fd, enj_error** err)
+// Append an operation to a program being compiled
+static enjd_program_op* _new_op(enjd_program* prog, enj_error** err)
+{
+    if (prog->op_count == prog->op_capacity)
+    {
+        size_t capacity = prog->op_capacity ? 2 * prog->op_capacity : 16;
+
+        enjd_program_op* ops = enj_realloc(prog->ops, capacity * sizeof(enjd_program_op));
+        if (!ops)
+        {
+            enj_error_put(err, ENJ_ERR_MALLOC);
+            return 0;
+        }
+
+        prog->ops = ops;
+        prog->op_capacity = capacity;
+    }
+
+    enjd_program_op* op = &prog->ops[prog->op_count++];
+    memset(op, 0, sizeof(enjd_program_op));
+
+    return op;
+}
+
+enjd_program* enjd_formatter_compile(enjd_formatter* fmt, const char* string, enj_error** err)
 {
-    if (!fmt || !string || fd <= 0)
+    if (!fmt || !string)
     {
         enj_error_put(err, ENJ_ERR_ARGUMENT);
-        return -1;
+        return 0;
     }
 
-    for (const char* p = string; p && *p; )
+    enjd_program* prog = enj_malloc(sizeof(enjd_program));
+    if (!prog)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return 0;
+    }
+
+    prog->fmt = fmt;
+    prog->ops = 0;
+    prog->op_count = 0;
+    prog->op_capacity = 0;
+    prog->output = ENJD_OUTPUT_TEXT;
+    prog->header_done = 0;
+    prog->scratch = 0;
+
+    // Literal spans point into our own copy of the format string
+    prog->string = enj_malloc(strlen(string) + 1);
+    if (!prog->string)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        goto fail;
+    }
+
+    strcpy(prog->string, string);
+
+    enjd_program_op* op;
+
+    for (const char* p = prog->string; p && *p; )
     {
         if (*p != ENJ_DUMP_FORMAT_ESCAPE_CHAR)
         {
-            int count;
+            // The whole literal span is a single operation
+            const char* s = p;
+            while (*s && *s != ENJ_DUMP_FORMAT_ESCAPE_CHAR)
+                ++s;
 
-        write_single_char:
-            count = write(fd, p++, 1);
+            if (!(op = _new_op(prog, err)))
+                goto fail;
 
-            if (count < 1)
-            {
-                if (count < 0)
-                    enj_error_put_posix_errno(err, ENJ_ERR_IO, count);
-                else
-                    enj_error_put(err, ENJ_ERR_IO);
-                return -1;
-            }
+            op->literal = p;
+            op->length = s - p;
+            p = s;
 
             continue;
         }
@@ -185,7 +240,14 @@ int enjd_formatter_run(enjd_formatter* fmt, const char* string, void* arg1, int
 
             // If the escape was itself escaped, just print it
             if (*p == fmt->escape0)
-                goto write_single_char;
+            {
+                if (!(op = _new_op(prog, err)))
+                    goto fail;
+
+                op->literal = p++;
+                op->length = 1;
+                continue;
+            }
 
             int mod_width = 0;
             char mod_pad = ' ';
@@ -200,7 +262,7 @@ int enjd_formatter_run(enjd_formatter* fmt, const char* string, void* arg1, int
                     if (*p != '-' && !isdigit(*p))
                     {
                         enj_error_put(err, ENJ_ERR_BAD_FMT);
-                        return -1;
+                        goto fail;
                     }
 
                     // Get evnentual sign (for right-aligned field)
@@ -230,7 +292,7 @@ int enjd_formatter_run(enjd_formatter* fmt, const char* string, void* arg1, int
                 if (!*p)
                 {
                     enj_error_put(err, ENJ_ERR_BAD_FMT);
-                    return -1;
+                    goto fail;
                 }
             }
 
@@ -247,7 +309,7 @@ int enjd_formatter_run(enjd_formatter* fmt, const char* string, void* arg1, int
             if (*s != fmt->escape1)
             {
                 enj_error_put(err, ENJ_ERR_BAD_FMT);
-                return -1;
+                goto fail;
             }
 
             // Get a clean version of the name, null-terminated
@@ -261,61 +323,247 @@ int enjd_formatter_run(enjd_formatter* fmt, const char* string, void* arg1, int
             {
                 enj_error_wrap(err, ENJ_ERR_NEXISTS, *err);
                 enj_error_wrap(err, ENJ_ERR_BAD_FMT, *err);
-                return -1;
+                goto fail;
             }
 
-            // Invoke the element's handler
-            if ((*elem->handler)(elem->arg0, arg1, fd, mod_width, mod_pad, err) < 0)
-                return -1;
+            // Resolve the element's handler once and for all
+            if (!(op = _new_op(prog, err)))
+                goto fail;
+
+            op->elem = elem;
+            op->handler = elem->handler;
+            op->arg0 = elem->arg0;
+            op->width = mod_width;
+            op->pad = mod_pad;
 
             p = ++s;
         }
     }
 
+    return prog;
+
+fail:
+    enjd_program_delete(prog);
+    return 0;
+}
+
+void enjd_program_delete(enjd_program* prog)
+{
+    if (!prog)
+        return;
+
+    enjd_sink_delete(prog->scratch);
+    enj_free(prog->ops);
+    enj_free(prog->string);
+    enj_free(prog);
+}
+
+enjd_program* enjd_formatter_compile_records(enjd_formatter* fmt, const char* string, int output, enj_error** err)
+{
+    if (!fmt || (output != ENJD_OUTPUT_JSONL && output != ENJD_OUTPUT_CSV))
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return 0;
+    }
+
+    // Without a format string, use an empty one and add all elements
+    enjd_program* prog = enjd_formatter_compile(fmt, string ? string : "", err);
+    if (!prog)
+        return 0;
+
+    prog->output = output;
+
+    if (string)
+    {
+        // Only keep elements
+        size_t count = 0;
+        for (size_t i = 0; i < prog->op_count; ++i)
+        {
+            if (prog->ops[i].handler)
+                prog->ops[count++] = prog->ops[i];
+        }
+
+        prog->op_count = count;
+    }
+    else
+    {
+        for (enjd_formatter_elem* elem = fmt->elems; elem; elem = elem->next)
+        {
+            enjd_program_op* op = _new_op(prog, err);
+            if (!op)
+                goto fail;
+
+            op->elem = elem;
+            op->handler = elem->handler;
+            op->arg0 = elem->arg0;
+            op->pad = ' ';
+        }
+    }
+
+    if (!(prog->scratch = enjd_sink_create_memory(err)))
+        goto fail;
+
+    return prog;
+
+fail:
+    enjd_program_delete(prog);
     return 0;
 }
 
-void enjd_padded_fprintf(FILE* f, int width, char pad, const char* fmt, ...)
+// Write a rendered value as a JSON or CSV field ; integers are converted
+//   to decimal numbers, anything else that was rendered for them (such as
+//   "<corrupt>") is kept as a string. Hex values may be followed by names
+//   after a space (as for flags), which records leave out, and letters
+//   are written without their blanks.
+static void _record_value(enjd_program* prog, int type, const char* value, size_t length, enjd_sink* sink)
 {
-    va_list ap;
-    va_start(ap, fmt);
+    int json = prog->output == ENJD_OUTPUT_JSONL;
+    char letters[64];
 
-    // Craft actual string
-    char buffer[512];
-    size_t len = vsnprintf(&buffer[0], sizeof(buffer), fmt, ap);
-    buffer[len] = '\0';
+    if (type == ENJD_FIELD_HEX && length)
+    {
+        uint64_t number = 0;
+        size_t i;
+        for (i = 0; i < length && i < 16 && isxdigit((unsigned char) value[i]); ++i)
+            number = (number << 4) | (isdigit((unsigned char) value[i]) ? value[i] - '0' : (toupper((unsigned char) value[i]) - 'A' + 10));
 
-    // Is the field right-aligned ?
-    int right = 0;
-    if (width < 0)
+        if (i && (i == length || value[i] == ' '))
+        {
+            enjd_render_udec(sink, number);
+            return;
+        }
+    }
+    else if (type == ENJD_FIELD_DEC && length)
     {
-        right = 1;
-        width = -width;
+        size_t i = value[0] == '-' ? 1 : 0;
+        size_t digits = i;
+        while (i < length && isdigit((unsigned char) value[i]))
+            ++i;
+
+        if (i == length && i > digits)
+        {
+            enjd_sink_write(sink, value, length);
+            return;
+        }
     }
+    else if (type == ENJD_FIELD_LETTERS)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < length && count < sizeof(letters); ++i)
+        {
+            if (value[i] != ' ')
+                letters[count++] = value[i];
+        }
 
-    // If no width was requested, or if the string exceeds the width
-    //   anyway, just print it
-    if (!width || len >= width)
+        value = letters;
+        length = count;
+    }
+
+    if (type != ENJD_FIELD_STRING && type != ENJD_FIELD_LETTERS && !length)
     {
-        fprintf(f, "%s", &buffer[0]);
+        if (json)
+            enjd_render_literal(sink, "null");
+        return;
     }
-    // Otherwise,
+
+    if (json)
+        enjd_render_json_string(sink, value, length);
     else
+        enjd_render_csv_string(sink, value, length);
+}
+
+static int _run_record(enjd_program* prog, void* arg1, enjd_sink* sink, enj_error** err)
+{
+    int json = prog->output == ENJD_OUTPUT_JSONL;
+
+    if (!json && !prog->header_done)
     {
-        // Get the needed pad length
-        int padlen = width - len;
+        for (size_t i = 0; i < prog->op_count; ++i)
+        {
+            if (i)
+                enjd_sink_putc(sink, ',');
 
-        // Pad for right-aligned fields
-        for (int i = 0; right && i < padlen; ++i)
-            fprintf(f, "%c", pad);
+            enjd_render_csv_string(sink, prog->ops[i].elem->name->string, prog->ops[i].elem->name->length - 1);
+        }
+
+        enjd_sink_putc(sink, '\n');
+        prog->header_done = 1;
+    }
 
-        // Actual field contents
-        fprintf(f, "%s", &buffer[0]);
+    if (json)
+        enjd_sink_putc(sink, '{');
 
-        // Pad for left-aligned fields
-        for (int i = 0; !right && i < padlen; ++i)
-            fprintf(f, "%c", pad);
+    for (size_t i = 0; i < prog->op_count; ++i)
+    {
+        enjd_program_op* op = &prog->ops[i];
+
+        if (i)
+            enjd_sink_putc(sink, ',');
+
+        if (json)
+        {
+            enjd_render_json_string(sink, op->elem->name->string, op->elem->name->length - 1);
+            enjd_sink_putc(sink, ':');
+        }
+
+        enjd_sink_reset(prog->scratch);
+        if ((*op->handler)(op->arg0, arg1, prog->scratch, 0, ' ', err) < 0 ||
+            enjd_sink_error(prog->scratch, err) < 0)
+            return -1;
+
+        int type = op->elem->type;
+        if (op->elem->type_handler)
+            type = (*op->elem->type_handler)(op->arg0, arg1);
+
+        _record_value(prog, type, prog->scratch->buffer, prog->scratch->length, sink);
+    }
+
+    if (json)
+        enjd_sink_putc(sink, '}');
+
+    enjd_sink_putc(sink, '\n');
+
+    return enjd_sink_error(sink, err);
+}
+
+int enjd_program_run(enjd_program* prog, void* arg1, enjd_sink* sink, enj_error** err)
+{
+    if (!prog || !sink)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (prog->output != ENJD_OUTPUT_TEXT)
+        return _run_record(prog, arg1, sink, err);
+
+    for (size_t i = 0; i < prog->op_count; ++i)
+    {
+        enjd_program_op* op = &prog->ops[i];
+
+        if (!op->handler)
+            enjd_sink_write(sink, op->literal, op->length);
+        else if ((*op->handler)(op->arg0, arg1, sink, op->width, op->pad, err) < 0)
+            return -1;
     }
 
-    va_end(ap);
+    return enjd_sink_error(sink, err);
+}
+
+int enjd_formatter_run(enjd_formatter* fmt, const char* string, void* arg1, enjd_sink* sink, enj_error** err)
+{
+    if (!fmt || !string || !sink)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enjd_program* prog = enjd_formatter_compile(fmt, string, err);
+    if (!prog)
+        return -1;
+
+    int ret = enjd_program_run(prog, arg1, sink, err);
+    enjd_program_delete(prog);
+
+    return ret;
 }
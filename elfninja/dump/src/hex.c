@@ -19,14 +19,117 @@
 #define _GNU_SOURCE
 
 #include "elfninja/dump/hex.h"
+#include "elfninja/dump/render.h"
 #include "elfninja/core/malloc.h"
 
-#include <stdio.h>
-#include <unistd.h>
-#include <errno.h>
-#include <ctype.h>
 #include <string.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ENJD_HEX_SSSE3
+#include <immintrin.h>
+#endif
+
+static const char _hex_digits[16] = "0123456789ABCDEF";
+
+// Row kernels : hex ones write each byte as "XX ", ascii ones write the bytes
+//   themselves with unprintable ones replaced. Both return the end of output.
+typedef char* (*_hex_kernel)(char* out, const unsigned char* data, size_t count);
+typedef char* (*_ascii_kernel)(char* out, const unsigned char* data, size_t count, char unprintable);
+
+static char* _hex_scalar(char* out, const unsigned char* data, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[0] = _hex_digits[data[i] >> 4];
+        out[1] = _hex_digits[data[i] & 0xF];
+        out[2] = ' ';
+        out += 3;
+    }
+
+    return out;
+}
+
+static char* _ascii_scalar(char* out, const unsigned char* data, size_t count, char unprintable)
+{
+    // Same as isprint() in the C locale
+    for (size_t i = 0; i < count; ++i)
+        out[i] = data[i] >= 0x20 && data[i] < 0x7F ? data[i] : unprintable;
+
+    return out + count;
+}
+
+#ifdef ENJD_HEX_SSSE3
+// Turn the 16 bytes in v into 32 hex digits, the first 8 bytes in lo and the
+//   last 8 ones in hi
+__attribute__ ((target("ssse3")))
+static inline void _hex_digits_ssse3(__m128i v, __m128i* lo, __m128i* hi)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i letters = _mm_set1_epi8('A' - '0' - 10);
+
+    __m128i high = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+    __m128i low = _mm_and_si128(v, nibble);
+
+    high = _mm_add_epi8(_mm_add_epi8(high, zero), _mm_and_si128(_mm_cmpgt_epi8(high, nine), letters));
+    low = _mm_add_epi8(_mm_add_epi8(low, zero), _mm_and_si128(_mm_cmpgt_epi8(low, nine), letters));
+
+    *lo = _mm_unpacklo_epi8(high, low);
+    *hi = _mm_unpackhi_epi8(high, low);
+}
+
+__attribute__ ((target("ssse3")))
+static char* _hex_ssse3(char* out, const unsigned char* data, size_t count)
+{
+    // Spread the 32 digits of a block over 48 bytes of "XX " fields, taking
+    //   them from the first (lo) or second (hi) half ; -128 yields zero
+    const __m128i lo_0 = _mm_setr_epi8(0, 1, -128, 2, 3, -128, 4, 5, -128, 6, 7, -128, 8, 9, -128, 10);
+    const __m128i lo_1 = _mm_setr_epi8(11, -128, 12, 13, -128, 14, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128);
+    const __m128i hi_1 = _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, 0, 1, -128, 2, 3, -128, 4, 5);
+    const __m128i hi_2 = _mm_setr_epi8(-128, 6, 7, -128, 8, 9, -128, 10, 11, -128, 12, 13, -128, 14, 15, -128);
+    const __m128i spaces_0 = _mm_setr_epi8(0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0);
+    const __m128i spaces_1 = _mm_setr_epi8(0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0);
+    const __m128i spaces_2 = _mm_setr_epi8(' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ');
+
+    for (; count >= 16; count -= 16, data += 16, out += 48)
+    {
+        __m128i lo, hi;
+        _hex_digits_ssse3(_mm_loadu_si128((const __m128i*) data), &lo, &hi);
+
+        __m128i out_0 = _mm_or_si128(_mm_shuffle_epi8(lo, lo_0), spaces_0);
+        __m128i out_1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(lo, lo_1), _mm_shuffle_epi8(hi, hi_1)), spaces_1);
+        __m128i out_2 = _mm_or_si128(_mm_shuffle_epi8(hi, hi_2), spaces_2);
+
+        _mm_storeu_si128((__m128i*) out, out_0);
+        _mm_storeu_si128((__m128i*) (out + 16), out_1);
+        _mm_storeu_si128((__m128i*) (out + 32), out_2);
+    }
+
+    return _hex_scalar(out, data, count);
+}
+
+__attribute__ ((target("ssse3")))
+static char* _ascii_ssse3(char* out, const unsigned char* data, size_t count, char unprintable)
+{
+    // Signed compares leave bytes >= 0x80 out of the printable range
+    const __m128i space = _mm_set1_epi8(0x1F);
+    const __m128i tilde = _mm_set1_epi8(0x7F);
+    const __m128i replacement = _mm_set1_epi8(unprintable);
+
+    for (; count >= 16; count -= 16, data += 16, out += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*) data);
+        __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(v, space), _mm_cmplt_epi8(v, tilde));
+
+        v = _mm_or_si128(_mm_and_si128(printable, v), _mm_andnot_si128(printable, replacement));
+        _mm_storeu_si128((__m128i*) out, v);
+    }
+
+    return _ascii_scalar(out, data, count, unprintable);
+}
+#endif // ENJD_HEX_SSSE3
+
 enjd_hex_dumper* enjd_hex_dumper_create(enj_error** err)
 {
     enjd_hex_dumper* hd = enj_malloc(sizeof(enjd_hex_dumper));
@@ -57,9 +160,22 @@ void enjd_hex_dumper_delete(enjd_hex_dumper* hd)
     enj_free(hd);
 }
 
-int enjd_hex_dumper_run(enjd_hex_dumper* hd, void const* data, size_t length, int fd, enj_error** err)
+// Write one field of stride bytes, read as a little-endian value
+static char* _hex_field(char* out, const unsigned char* data, size_t length, size_t stride)
 {
-    if (!hd || !data || fd <= 0)
+    for (size_t i = stride; i-- > 0;)
+    {
+        unsigned char c = i < length ? data[i] : 0;
+        *out++ = _hex_digits[c >> 4];
+        *out++ = _hex_digits[c & 0xF];
+    }
+
+    return out;
+}
+
+int enjd_hex_dumper_run_sink(enjd_hex_dumper* hd, void const* data, size_t length, enjd_sink* sink, enj_error** err)
+{
+    if (!hd || !data || !sink)
     {
         enj_error_put(err, ENJ_ERR_ARGUMENT);
         return -1;
@@ -73,79 +189,123 @@ int enjd_hex_dumper_run(enjd_hex_dumper* hd, void const* data, size_t length, in
         return -1;
     }
 
-    FILE* f = fdopen(dup(fd), "wb");
-    if (!f)
+    // Pick the row kernels for this CPU
+    _hex_kernel hex = &_hex_scalar;
+    _ascii_kernel ascii = &_ascii_scalar;
+#ifdef ENJD_HEX_SSSE3
+    if (__builtin_cpu_supports("ssse3"))
     {
-        enj_error_put_posix_errno(err, ENJ_ERR_IO, errno);
-        return -1;
+        hex = &_hex_ssse3;
+        ascii = &_ascii_ssse3;
     }
+#endif
 
+    const unsigned char* bytes = data;
     size_t start_pos = hd->from >= 0 ? hd->from : 0;
     size_t stop_len = hd->to >= 0 ? hd->to + 1 : length;
 
-    for (size_t pos = start_pos; pos < stop_len; pos += hd->grid)
+    for (size_t pos = start_pos; pos < stop_len && !sink->error; pos += hd->grid)
     {
+        size_t row_len = stop_len - pos < hd->grid ? stop_len - pos : hd->grid;
+
         // Print index if allowed
         if (!hd->no_indices)
         {
             if (hd->base_address)
-                fprintf(f, "%08lX: ", hd->base_address + pos);
+                enjd_render_hex(sink, hd->base_address + pos, 8);
             else
-                fprintf(f, "%04lX: ", pos);
+                enjd_render_hex(sink, pos, 4);
+
+            enjd_render_literal(sink, ": ");
         }
 
-        // Dump line contents as hex
+        // Dump line contents as hex ; every field is followed by a space
+        //   except the one at grid - 1, and missing fields are blanked only
+        //   when the ASCII column follows
         if (hd->show_hex)
         {
-            for (size_t i = 0; i < hd->grid; i += hd->stride)
-            {
-                // Get field position and size
-                size_t field_pos = pos + i;
-                size_t field_len = hd->stride;
+            size_t fields = (hd->grid + hd->stride - 1) / hd->stride;
+            char* out = enjd_sink_reserve(sink, fields * (2 * hd->stride + 1));
+            if (!out)
+                break;
 
-                // Stop if we're at the end
-                if (field_pos < stop_len)
+            char* end = out;
+            if (hd->stride == 1)
+            {
+                end = hex(end, bytes + pos, row_len);
+                if (hd->show_ascii)
                 {
-                    // Adjust the size of the field to avoid reading past the end of the buffer
-                    if (field_pos + field_len > stop_len)
-                        field_len = stop_len - field_pos;
-
-                    // Read the actual field contents
-                    size_t field = 0;
-                    memcpy(&field, data + field_pos, field_len);
-
-                    // And display it
-                    fprintf(f, "%0*lX%s", 2 * (int) hd->stride, field, i != hd->grid - 1 ? " " : "");
+                    memset(end, ' ', 3 * (hd->grid - row_len));
+                    end += 3 * (hd->grid - row_len);
                 }
-                else
+
+                if (row_len == hd->grid || hd->show_ascii)
+                    --end;
+            }
+            else
+            {
+                for (size_t i = 0; i < hd->grid; i += hd->stride)
                 {
-                    if (hd->show_ascii)
-                        fprintf(f, "%*s%s", 2 * (int) hd->stride, " ", i != hd->grid - 1 ? " " : "");
+                    // Fields may run past the row when grid is not a multiple
+                    //   of stride, but never past the end of the data
+                    if (i < row_len)
+                    {
+                        size_t left = stop_len - (pos + i);
+                        size_t field_len = left < hd->stride ? left : hd->stride;
+                        end = _hex_field(end, bytes + pos + i, field_len, hd->stride);
+                    }
+                    else if (hd->show_ascii)
+                    {
+                        memset(end, ' ', 2 * hd->stride);
+                        end += 2 * hd->stride;
+                    }
                     else
                         break;
+
+                    if (i != hd->grid - 1)
+                        *end++ = ' ';
                 }
             }
+
+            sink->length += end - out;
         }
 
         // Dump ASCII
         if (hd->show_ascii)
         {
             if (hd->show_hex)
-                fprintf(f, " | ");
+                enjd_render_literal(sink, " | ");
 
-            for (size_t i = 0; i < hd->grid && (pos + i) < stop_len; ++i)
-            {
-                char c = ((const char*) data)[pos + i];
-                if (!isprint(c))
-                    c = hd->unprintable_char;
+            char* out = enjd_sink_reserve(sink, row_len);
+            if (!out)
+                break;
 
-                fprintf(f, "%c", c);
-            }
+            sink->length += ascii(out, bytes + pos, row_len, hd->unprintable_char) - out;
         }
 
-        fprintf(f, "\n");
+        enjd_sink_putc(sink, '\n');
     }
 
-    fclose(f);
-    return 0;
+    return enjd_sink_error(sink, err);
+}
+
+int enjd_hex_dumper_run(enjd_hex_dumper* hd, void const* data, size_t length, int fd, enj_error** err)
+{
+    if (fd <= 0)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enjd_sink* sink = enjd_sink_create_fd(fd, err);
+    if (!sink)
+        return -1;
+
+    int ret = enjd_hex_dumper_run_sink(hd, data, length, sink, err);
+    if (ret == 0)
+        ret = enjd_sink_flush(sink, err);
+
+    enjd_sink_delete(sink);
+
+    return ret;
 }
@@ -29,12 +29,12 @@
 
 enum
 {
-    #define DEF_FIELD_GNU_ABI_TAG(name, ident, elf_field, attrs, descr) GNU_ABI_TAG_ ## ident,
-    #define DEF_FIELD_GNU_BUILD_ID(name, ident, elf_field, attrs, descr) GNU_BUILD_ID_ ## ident,
+    #define DEF_FIELD_GNU_ABI_TAG(name, ident, elf_field, type, attrs, descr) GNU_ABI_TAG_ ## ident,
+    #define DEF_FIELD_GNU_BUILD_ID(name, ident, elf_field, type, attrs, descr) GNU_BUILD_ID_ ## ident,
     #include "elfninja/dump/note_gnu.def"
 };
 
-static int _gnu_abi_tag_field(void* arg0, void* arg1, int fd, int width, char pad, enj_error** err)
+static int _gnu_abi_tag_field(void* arg0, void* arg1, enjd_sink* sink, int width, char pad, enj_error** err)
 {
     if (!arg1)
     {
@@ -42,13 +42,6 @@ static int _gnu_abi_tag_field(void* arg0, void* arg1, int fd, int width, char pa
         return -1;
     }
 
-    FILE* f = fdopen(dup(fd), "ab");
-    if (!f)
-    {
-        enj_error_put(err, ENJ_ERR_ARGUMENT);
-        return -1;
-    }
-
     size_t field = (size_t) arg0;
     enj_note* note = (enj_note*) arg1;
     enj_note_gnu_abi_tag* tag = (enj_note_gnu_abi_tag*) note->content;
@@ -65,34 +58,33 @@ static int _gnu_abi_tag_field(void* arg0, void* arg1, int fd, int width, char pa
         {
             switch (tag->os)
             {
-                case ELF_NOTE_OS_LINUX:    enjd_padded_fprintf(f, width, pad, "ELF_NOTE_OS_LINUX");    break;
-                case ELF_NOTE_OS_GNU:      enjd_padded_fprintf(f, width, pad, "ELF_NOTE_OS_GNU");      break;
-                case ELF_NOTE_OS_SOLARIS2: enjd_padded_fprintf(f, width, pad, "ELF_NOTE_OS_SOLARIS2"); break;
-                case ELF_NOTE_OS_FREEBSD:  enjd_padded_fprintf(f, width, pad, "ELF_NOTE_OS_FREEBSD");  break;
-                default: enjd_padded_fprintf(f, width, pad, "ELF_NOTE_OS_USER(%ld)", tag->os);
+                case ELF_NOTE_OS_LINUX:    enjd_sink_padded_printf(sink, width, pad, "ELF_NOTE_OS_LINUX");    break;
+                case ELF_NOTE_OS_GNU:      enjd_sink_padded_printf(sink, width, pad, "ELF_NOTE_OS_GNU");      break;
+                case ELF_NOTE_OS_SOLARIS2: enjd_sink_padded_printf(sink, width, pad, "ELF_NOTE_OS_SOLARIS2"); break;
+                case ELF_NOTE_OS_FREEBSD:  enjd_sink_padded_printf(sink, width, pad, "ELF_NOTE_OS_FREEBSD");  break;
+                default: enjd_sink_padded_printf(sink, width, pad, "ELF_NOTE_OS_USER(%ld)", tag->os);
             }
 
             break;
         }
 
         case GNU_ABI_TAG_ABI_MAJOR:
-            fprintf(f, "%ld", tag->abi_major);
+            enjd_sink_printf(sink, "%ld", tag->abi_major);
             break;
 
         case GNU_ABI_TAG_ABI_MINOR:
-            fprintf(f, "%ld", tag->abi_minor);
+            enjd_sink_printf(sink, "%ld", tag->abi_minor);
             break;
 
         case GNU_ABI_TAG_ABI_SUBMINOR:
-            fprintf(f, "%ld", tag->abi_subminor);
+            enjd_sink_printf(sink, "%ld", tag->abi_subminor);
             break;
     }
 
-    fclose(f);
     return 0;
 }
 
-static int _gnu_build_id_field(void* arg0, void* arg1, int fd, int width, char pad, enj_error** err)
+static int _gnu_build_id_field(void* arg0, void* arg1, enjd_sink* sink, int width, char pad, enj_error** err)
 {
     if (!arg1)
     {
@@ -100,13 +92,6 @@ static int _gnu_build_id_field(void* arg0, void* arg1, int fd, int width, char p
         return -1;
     }
 
-    FILE* f = fdopen(dup(fd), "ab");
-    if (!f)
-    {
-        enj_error_put(err, ENJ_ERR_ARGUMENT);
-        return -1;
-    }
-
     size_t field = (size_t) arg0;
     enj_note* note = (enj_note*) arg1;
     enj_note_gnu_build_id* build_id = (enj_note_gnu_build_id*) note->content;
@@ -128,12 +113,11 @@ static int _gnu_build_id_field(void* arg0, void* arg1, int fd, int width, char p
 
             hex[2 * build_id->length] = '\0';
 
-            enjd_padded_fprintf(f, width, pad, "%s", &hex[0]);
+            enjd_sink_padded_printf(sink, width, pad, "%s", &hex[0]);
             break;
         }
     }
 
-    fclose(f);
     return 0;
 }
 
@@ -143,8 +127,8 @@ enjd_formatter* enjd_note_gnu_abi_tag_formatter_create(enj_error** err)
     if (!fmt)
         return 0;
 
-    #define DEF_FIELD_GNU_ABI_TAG(name, ident, elf_field, attrs, descr) \
-        || !enjd_formatter_new_elem(fmt, name, &_gnu_abi_tag_field, (void*) GNU_ABI_TAG_ ## ident, err)
+    #define DEF_FIELD_GNU_ABI_TAG(name, ident, elf_field, type, attrs, descr) \
+        || !enjd_formatter_new_typed_elem(fmt, name, ENJD_FIELD_ ## type, &_gnu_abi_tag_field, (void*) GNU_ABI_TAG_ ## ident, err)
 
     if (0
         #include "elfninja/dump/note_gnu.def"
@@ -163,8 +147,8 @@ enjd_formatter* enjd_note_gnu_build_id_formatter_create(enj_error** err)
     if (!fmt)
         return 0;
 
-    #define DEF_FIELD_GNU_BUILD_ID(name, ident, elf_field, attrs, descr) \
-        || !enjd_formatter_new_elem(fmt, name, &_gnu_build_id_field, (void*) GNU_BUILD_ID_ ## ident, err)
+    #define DEF_FIELD_GNU_BUILD_ID(name, ident, elf_field, type, attrs, descr) \
+        || !enjd_formatter_new_typed_elem(fmt, name, ENJD_FIELD_ ## type, &_gnu_build_id_field, (void*) GNU_BUILD_ID_ ## ident, err)
 
     if (0
         #include "elfninja/dump/note_gnu.def"
@@ -19,6 +19,7 @@
 #define _GNU_SOURCE
 
 #include "elfninja/dump/shdr.h"
+#include "elfninja/dump/render.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -27,11 +28,11 @@
 
 enum
 {
-    #define DEF_FIELD(name, ident, elf_field, attrs, descr) PHDR_ ## ident,
+    #define DEF_FIELD(name, ident, elf_field, type, attrs, descr) PHDR_ ## ident,
     #include "elfninja/dump/phdr.def"
 };
 
-static int _phdr_field(void* arg0, void* arg1, int fd, int width, char pad, enj_error** err)
+static int _phdr_field(void* arg0, void* arg1, enjd_sink* sink, int width, char pad, enj_error** err)
 {
     if (!arg1)
     {
@@ -39,76 +40,54 @@ static int _phdr_field(void* arg0, void* arg1, int fd, int width, char pad, enj_
         return -1;
     }
 
-    FILE* f = fdopen(dup(fd), "ab");
-    if (!f)
-    {
-        enj_error_put(err, ENJ_ERR_ARGUMENT);
-        return -1;
-    }
-
     size_t field = (size_t) arg0;
     enj_elf_phdr* segment = (enj_elf_phdr*) arg1;
 
     switch (field)
     {
         case PHDR_INDEX:
-            enjd_padded_fprintf(f, width, pad, "%d", (int) segment->index);
+            enjd_render_dec(sink, (int) segment->index, width, pad);
             break;
 
         case PHDR_TYPE:
         {
             size_t value = ENJ_ELF_PHDR_GET(segment, p_type);
 
-            switch (value)
-            {
-                case PT_NULL:         enjd_padded_fprintf(f, width, pad, "PT_NULL");         break;
-                case PT_LOAD:         enjd_padded_fprintf(f, width, pad, "PT_LOAD");         break;
-                case PT_DYNAMIC:      enjd_padded_fprintf(f, width, pad, "PT_DYNAMIC");      break;
-                case PT_INTERP:       enjd_padded_fprintf(f, width, pad, "PT_INTERP");       break;
-                case PT_NOTE:         enjd_padded_fprintf(f, width, pad, "PT_NOTE");         break;
-                case PT_SHLIB:        enjd_padded_fprintf(f, width, pad, "PT_SHLIB");        break;
-                case PT_PHDR:         enjd_padded_fprintf(f, width, pad, "PT_PHDR");         break;
-                case PT_TLS:          enjd_padded_fprintf(f, width, pad, "PT_TLS");          break;
-                case PT_GNU_EH_FRAME: enjd_padded_fprintf(f, width, pad, "PT_GNU_EH_FRAME"); break;
-                case PT_GNU_STACK:    enjd_padded_fprintf(f, width, pad, "PT_GNU_STACK");    break;
-                case PT_GNU_RELRO:    enjd_padded_fprintf(f, width, pad, "PT_GNU_RELRO");    break;
-                case PT_SUNWBSS:      enjd_padded_fprintf(f, width, pad, "PT_SUNWBSS");      break;
-                case PT_SUNWSTACK:    enjd_padded_fprintf(f, width, pad, "PT_SUNWSTACK");    break;
-                default: enjd_padded_fprintf(f, width, pad, "PT_USER(%ld)", value); break;
-            }
+            if (enjd_render_name_of(sink, ENJD_NAMES_PT, value, width, pad) < 0)
+                enjd_sink_padded_printf(sink, width, pad, "PT_USER(%ld)", value);
 
             break;
         }
 
         case PHDR_OFFSET:
-            fprintf(f, "%0*lX", 2 * (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_offset)), ENJ_ELF_PHDR_GET(segment, p_offset));
+            enjd_render_hex(sink, ENJ_ELF_PHDR_GET(segment, p_offset), 2 * (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_offset)));
             break;
 
         case PHDR_VADDR:
-            fprintf(f, "%0*lX", 2 * (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_vaddr)), ENJ_ELF_PHDR_GET(segment, p_vaddr));
+            enjd_render_hex(sink, ENJ_ELF_PHDR_GET(segment, p_vaddr), 2 * (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_vaddr)));
             break;
 
         case PHDR_PADDR:
-            fprintf(f, "%0*lX", 2 * (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_paddr)), ENJ_ELF_PHDR_GET(segment, p_paddr));
+            enjd_render_hex(sink, ENJ_ELF_PHDR_GET(segment, p_paddr), 2 * (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_paddr)));
             break;
 
         case PHDR_FILESZ:
-            fprintf(f, "%0*lX", 2 * (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_filesz)), ENJ_ELF_PHDR_GET(segment, p_filesz));
+            enjd_render_hex(sink, ENJ_ELF_PHDR_GET(segment, p_filesz), 2 * (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_filesz)));
             break;
 
         case PHDR_MEMSZ:
-            fprintf(f, "%0*lX", 2 * (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_memsz)), ENJ_ELF_PHDR_GET(segment, p_memsz));
+            enjd_render_hex(sink, ENJ_ELF_PHDR_GET(segment, p_memsz), 2 * (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_memsz)));
             break;
 
         case PHDR_FLAGS:
         {
             size_t value = ENJ_ELF_PHDR_GET(segment, p_flags);
 
-            fprintf(f, "%0*lX", (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_flags)), value);
+            enjd_render_hex(sink, value, (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_flags)));
 
-            if (value & PF_X) fprintf(f, " PF_X");
-            if (value & PF_W) fprintf(f, " PF_W");
-            if (value & PF_R) fprintf(f, " PF_R");
+            if (value & PF_X) enjd_render_literal(sink, " PF_X");
+            if (value & PF_W) enjd_render_literal(sink, " PF_W");
+            if (value & PF_R) enjd_render_literal(sink, " PF_R");
 
             break;
         }
@@ -123,16 +102,15 @@ static int _phdr_field(void* arg0, void* arg1, int fd, int width, char pad, enj_
             if (value & PF_W) str[1] = 'W';
             if (value & PF_R) str[2] = 'R';
 
-            fprintf(f, "%s", &str[0]);
+            enjd_sink_write(sink, &str[0], sizeof(str) - 1);
             break;
         }
 
         case PHDR_ALIGN:
-            fprintf(f, "%0*lX", (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_align)), ENJ_ELF_PHDR_GET(segment, p_align));
+            enjd_render_hex(sink, ENJ_ELF_PHDR_GET(segment, p_align), (int) sizeof(ENJ_ELF_PHDR_GET(segment, p_align)));
             break;
     }
 
-    fclose(f);
     return 0;
 }
 
@@ -142,8 +120,8 @@ enjd_formatter* enjd_phdr_formatter_create(enj_error** err)
     if (!fmt)
         return 0;
 
-    #define DEF_FIELD(name, ident, elf_field, attrs, descr) \
-        || !enjd_formatter_new_elem(fmt, name, &_phdr_field, (void*) PHDR_ ## ident, err)
+    #define DEF_FIELD(name, ident, elf_field, type, attrs, descr) \
+        || !enjd_formatter_new_typed_elem(fmt, name, ENJD_FIELD_ ## type, &_phdr_field, (void*) PHDR_ ## ident, err)
 
     if (0
         #include "elfninja/dump/phdr.def"
@@ -0,0 +1,325 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "elfninja/dump/render.h"
+
+#include <string.h>
+#include <elf.h>
+
+static const enjd_render_name _names[] =
+{
+    #define DEF_NAME(table, name) { ENJD_NAMES_ ## table, (name), #name, sizeof(#name) - 1 },
+    #include "elfninja/dump/render.def"
+};
+
+static const char _hex_digits[16] = "0123456789ABCDEF";
+
+static const char _dec_pairs[200] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// JSON escape for each byte : 0 if none is needed, 'u' for \u00XX ; names are
+//   arbitrary bytes, so bytes past ASCII ('x') are only copied as they are within
+//   valid UTF-8 sequences, and escaped as \u00XX otherwise
+static const char _json_escapes[256] =
+{
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    ['"'] = '"',
+    ['\\'] = '\\',
+    [0x80] =
+    'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x',
+    'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x',
+    'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x',
+    'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x',
+    'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x',
+    'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x',
+    'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x',
+    'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x'
+};
+
+// Length of the valid UTF-8 sequence starting a string, 0 if there is none
+//  (overlong forms, surrogates and code points past U+10FFFF are invalid)
+static size_t _utf8_length(const unsigned char* bytes, size_t length)
+{
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    size_t count;
+
+    if (bytes[0] >= 0xC2 && bytes[0] <= 0xDF)
+        count = 2;
+    else if (bytes[0] >= 0xE0 && bytes[0] <= 0xEF)
+    {
+        count = 3;
+        low = bytes[0] == 0xE0 ? 0xA0 : low;
+        high = bytes[0] == 0xED ? 0x9F : high;
+    }
+    else if (bytes[0] >= 0xF0 && bytes[0] <= 0xF4)
+    {
+        count = 4;
+        low = bytes[0] == 0xF0 ? 0x90 : low;
+        high = bytes[0] == 0xF4 ? 0x8F : high;
+    }
+    else
+        return 0;
+
+    if (count > length || bytes[1] < low || bytes[1] > high)
+        return 0;
+
+    for (size_t i = 2; i < count; ++i)
+    {
+        if ((bytes[i] & 0xC0) != 0x80)
+            return 0;
+    }
+
+    return count;
+}
+
+// Characters that force quoting a CSV field
+static const char _csv_specials[256] =
+{
+    [','] = 1,
+    ['"'] = 1,
+    ['\n'] = 1,
+    ['\r'] = 1
+};
+
+const enjd_render_name* enjd_render_find_name(int table, uint64_t value)
+{
+    size_t low = 0;
+    size_t high = sizeof(_names) / sizeof(_names[0]);
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        const enjd_render_name* name = &_names[mid];
+
+        if (name->table == table && name->value == value)
+            return name;
+
+        if (name->table < table || (name->table == table && name->value < value))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return 0;
+}
+
+void enjd_render_string(enjd_sink* sink, const char* string, size_t length, int width, char pad)
+{
+    if (!sink || !string)
+        return;
+
+    // Is the field right-aligned ?
+    int right = 0;
+    if (width < 0)
+    {
+        right = 1;
+        width = -width;
+    }
+
+    size_t padlen = length < (size_t) width ? width - length : 0;
+
+    char* out = enjd_sink_reserve(sink, length + padlen);
+    if (!out)
+        return;
+
+    if (right)
+    {
+        memset(out, pad, padlen);
+        memcpy(out + padlen, string, length);
+    }
+    else
+    {
+        memcpy(out, string, length);
+        memset(out + length, pad, padlen);
+    }
+
+    sink->length += length + padlen;
+}
+
+void enjd_render_hex(enjd_sink* sink, uint64_t value, int digits)
+{
+    if (!sink)
+        return;
+
+    // Values wider than the requested digits are printed in full
+    int needed = 1;
+    for (uint64_t v = value >> 4; v; v >>= 4)
+        ++needed;
+
+    if (digits < needed)
+        digits = needed;
+
+    char* out = enjd_sink_reserve(sink, digits);
+    if (!out)
+        return;
+
+    for (int i = digits - 1; i >= 0; --i)
+    {
+        out[i] = _hex_digits[value & 0xF];
+        value >>= 4;
+    }
+
+    sink->length += digits;
+}
+
+// Write the digits of value right-aligned before end, returns the first one
+static char* _dec_digits(char* end, uint64_t v)
+{
+    char* p = end;
+
+    // Two digits at a time
+    while (v >= 100)
+    {
+        p -= 2;
+        memcpy(p, &_dec_pairs[2 * (v % 100)], 2);
+        v /= 100;
+    }
+
+    if (v >= 10)
+    {
+        p -= 2;
+        memcpy(p, &_dec_pairs[2 * v], 2);
+    }
+    else
+        *--p = '0' + v;
+
+    return p;
+}
+
+void enjd_render_dec(enjd_sink* sink, int64_t value, int width, char pad)
+{
+    char buffer[24];
+    char* p = _dec_digits(&buffer[sizeof(buffer)], value < 0 ? -(uint64_t) value : (uint64_t) value);
+
+    if (value < 0)
+        *--p = '-';
+
+    enjd_render_string(sink, p, &buffer[sizeof(buffer)] - p, width, pad);
+}
+
+void enjd_render_udec(enjd_sink* sink, uint64_t value)
+{
+    char buffer[24];
+    char* p = _dec_digits(&buffer[sizeof(buffer)], value);
+
+    enjd_sink_write(sink, p, &buffer[sizeof(buffer)] - p);
+}
+
+int enjd_render_name_of(enjd_sink* sink, int table, uint64_t value, int width, char pad)
+{
+    const enjd_render_name* name = enjd_render_find_name(table, value);
+    if (!name)
+        return -1;
+
+    enjd_render_string(sink, name->string, name->length, width, pad);
+    return 0;
+}
+
+void enjd_render_json_string(enjd_sink* sink, const char* string, size_t length)
+{
+    if (!sink || !string)
+        return;
+
+    const unsigned char* bytes = (const unsigned char*) string;
+
+    enjd_sink_putc(sink, '"');
+
+    for (size_t pos = 0; pos < length;)
+    {
+        // Copy the longest run that needs no escaping at once, valid UTF-8 included
+        size_t run = pos;
+        for (;;)
+        {
+            while (run < length && !_json_escapes[bytes[run]])
+                ++run;
+
+            size_t utf8 = 0;
+            if (run < length && _json_escapes[bytes[run]] == 'x')
+                utf8 = _utf8_length(bytes + run, length - run);
+
+            if (!utf8)
+                break;
+
+            run += utf8;
+        }
+
+        enjd_sink_write(sink, string + pos, run - pos);
+        if (run == length)
+            break;
+
+        unsigned char c = bytes[run];
+        if (_json_escapes[c] == 'u' || _json_escapes[c] == 'x')
+        {
+            char escape[6] = { '\\', 'u', '0', '0', _hex_digits[c >> 4], _hex_digits[c & 0xF] };
+            enjd_sink_write(sink, &escape[0], sizeof(escape));
+        }
+        else
+        {
+            char escape[2] = { '\\', _json_escapes[c] };
+            enjd_sink_write(sink, &escape[0], sizeof(escape));
+        }
+
+        pos = run + 1;
+    }
+
+    enjd_sink_putc(sink, '"');
+}
+
+void enjd_render_csv_string(enjd_sink* sink, const char* string, size_t length)
+{
+    if (!sink || !string)
+        return;
+
+    // Only quote fields that need it, doubling embedded quotes
+    size_t pos = 0;
+    while (pos < length && !_csv_specials[(unsigned char) string[pos]])
+        ++pos;
+
+    if (pos == length)
+    {
+        enjd_sink_write(sink, string, length);
+        return;
+    }
+
+    enjd_sink_putc(sink, '"');
+
+    for (pos = 0; pos < length;)
+    {
+        const char* quote = memchr(string + pos, '"', length - pos);
+        size_t run = quote ? (size_t) (quote - string) + 1 : length;
+
+        enjd_sink_write(sink, string + pos, run - pos);
+        if (quote)
+            enjd_sink_putc(sink, '"');
+
+        pos = run;
+    }
+
+    enjd_sink_putc(sink, '"');
+}
@@ -0,0 +1,318 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "elfninja/dump/sink.h"
+#include "elfninja/core/malloc.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+
+static enjd_sink* _create(int fd, enj_error** err)
+{
+    enjd_sink* sink = enj_malloc(sizeof(enjd_sink));
+    if (!sink)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return 0;
+    }
+
+    sink->buffer = enj_malloc(ENJD_SINK_BUFFER_SIZE);
+    if (!sink->buffer)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        enj_free(sink);
+        return 0;
+    }
+
+    sink->fd = fd;
+    sink->length = 0;
+    sink->capacity = ENJD_SINK_BUFFER_SIZE;
+    sink->error = 0;
+
+    return sink;
+}
+
+enjd_sink* enjd_sink_create_fd(int fd, enj_error** err)
+{
+    if (fd < 0)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return 0;
+    }
+
+    return _create(fd, err);
+}
+
+enjd_sink* enjd_sink_create_memory(enj_error** err)
+{
+    return _create(-1, err);
+}
+
+void enjd_sink_delete(enjd_sink* sink)
+{
+    if (!sink)
+        return;
+
+    enj_error_delete(sink->error);
+    enj_free(sink->buffer);
+    enj_free(sink);
+}
+
+// Write data out to the sink's fd
+static int _write_all(enjd_sink* sink, const char* data, size_t length)
+{
+    size_t done = 0;
+
+    while (done < length)
+    {
+        ssize_t count = write(sink->fd, data + done, length - done);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            enj_error_put_posix_errno(&sink->error, ENJ_ERR_IO, errno);
+            return -1;
+        }
+        else if (!count)
+        {
+            enj_error_put(&sink->error, ENJ_ERR_IO);
+            return -1;
+        }
+
+        done += count;
+    }
+
+    return 0;
+}
+
+// Write the buffered bytes to the sink's fd
+static int _drain(enjd_sink* sink)
+{
+    if (_write_all(sink, sink->buffer, sink->length) < 0)
+        return -1;
+
+    sink->length = 0;
+    return 0;
+}
+
+// Make room for at least length more bytes
+static int _reserve(enjd_sink* sink, size_t length)
+{
+    if (sink->error)
+        return -1;
+
+    if (sink->capacity - sink->length >= length)
+        return 0;
+
+    if (sink->fd >= 0)
+    {
+        if (_drain(sink) < 0)
+            return -1;
+
+        if (sink->capacity >= length)
+            return 0;
+    }
+
+    size_t capacity = sink->capacity;
+    while (capacity - sink->length < length)
+        capacity *= 2;
+
+    char* buffer = enj_realloc(sink->buffer, capacity);
+    if (!buffer)
+    {
+        enj_error_put(&sink->error, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    sink->buffer = buffer;
+    sink->capacity = capacity;
+
+    return 0;
+}
+
+void enjd_sink_write(enjd_sink* sink, const void* data, size_t length)
+{
+    if (!sink || !length)
+        return;
+
+    // Writes larger than the buffer skip it on fd sinks
+    if (sink->fd >= 0 && length >= sink->capacity)
+    {
+        if (!sink->error && _drain(sink) == 0)
+            _write_all(sink, data, length);
+
+        return;
+    }
+
+    if (_reserve(sink, length) < 0)
+        return;
+
+    memcpy(sink->buffer + sink->length, data, length);
+    sink->length += length;
+}
+
+void enjd_sink_putc(enjd_sink* sink, char c)
+{
+    if (!sink)
+        return;
+
+    if (sink->length < sink->capacity && !sink->error)
+        sink->buffer[sink->length++] = c;
+    else if (_reserve(sink, 1) == 0)
+        sink->buffer[sink->length++] = c;
+}
+
+void enjd_sink_pad(enjd_sink* sink, char pad, size_t count)
+{
+    if (!sink || !count)
+        return;
+
+    if (_reserve(sink, count) < 0)
+        return;
+
+    memset(sink->buffer + sink->length, pad, count);
+    sink->length += count;
+}
+
+static void _vprintf(enjd_sink* sink, int width, char pad, const char* fmt, va_list ap)
+{
+    if (!sink || !fmt)
+        return;
+
+    // Is the field right-aligned ?
+    int right = 0;
+    if (width < 0)
+    {
+        right = 1;
+        width = -width;
+    }
+
+    if (_reserve(sink, width) < 0)
+        return;
+
+    // Format in place when the result fits the free space
+    va_list aq;
+    va_copy(aq, ap);
+    size_t room = sink->capacity - sink->length;
+    int len = vsnprintf(sink->buffer + sink->length, room, fmt, aq);
+    va_end(aq);
+
+    if (len < 0)
+    {
+        enj_error_put(&sink->error, ENJ_ERR_BAD_FMT);
+        return;
+    }
+
+    // Otherwise make room and format again ; the field is then wider
+    //   than the requested width anyway
+    if ((size_t) len >= room)
+    {
+        if (_reserve(sink, len + 1) < 0)
+            return;
+
+        vsnprintf(sink->buffer + sink->length, len + 1, fmt, ap);
+    }
+
+    // If no width was requested, or if the string exceeds the width
+    //   anyway, keep it as is
+    if (len >= width)
+    {
+        sink->length += len;
+        return;
+    }
+
+    size_t padlen = width - len;
+    char* field = sink->buffer + sink->length;
+
+    if (right)
+    {
+        memmove(field + padlen, field, len);
+        memset(field, pad, padlen);
+    }
+    else
+        memset(field + len, pad, padlen);
+
+    sink->length += width;
+}
+
+void enjd_sink_printf(enjd_sink* sink, const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    _vprintf(sink, 0, ' ', fmt, ap);
+    va_end(ap);
+}
+
+void enjd_sink_padded_printf(enjd_sink* sink, int width, char pad, const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    _vprintf(sink, width, pad, fmt, ap);
+    va_end(ap);
+}
+
+char* enjd_sink_reserve(enjd_sink* sink, size_t length)
+{
+    if (!sink || _reserve(sink, length) < 0)
+        return 0;
+
+    return sink->buffer + sink->length;
+}
+
+void enjd_sink_reset(enjd_sink* sink)
+{
+    if (!sink)
+        return;
+
+    sink->length = 0;
+}
+
+int enjd_sink_error(enjd_sink* sink, enj_error** err)
+{
+    if (!sink)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (!sink->error)
+        return 0;
+
+    enj_error_wrap(err, ENJ_ERR_IO, sink->error);
+    sink->error = 0;
+
+    return -1;
+}
+
+int enjd_sink_flush(enjd_sink* sink, enj_error** err)
+{
+    if (!sink)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    if (!sink->error && sink->fd >= 0)
+        _drain(sink);
+
+    return enjd_sink_error(sink, err);
+}
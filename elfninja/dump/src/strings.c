@@ -19,12 +19,9 @@
 #define _GNU_SOURCE
 
 #include "elfninja/dump/strings.h"
+#include "elfninja/dump/render.h"
 #include "elfninja/core/malloc.h"
-
-#include <stdio.h>
-#include <unistd.h>
-#include <errno.h>
-#include <ctype.h>
+#include "elfninja/core/strscan.h"
 
 enjd_strings_dumper* enjd_strings_dumper_create(enj_error** err)
 {
@@ -51,53 +48,82 @@ void enjd_strings_dumper_delete(enjd_strings_dumper* sd)
     enj_free(sd);
 }
 
-int enjd_strings_dumper_run(enjd_strings_dumper* sd, void const* data, size_t length, int fd, enj_error** err)
+int enjd_strings_dumper_run_sink(enjd_strings_dumper* sd, void const* data, size_t length, enjd_sink* sink, enj_error** err)
 {
-    if (!sd || !data || fd <= 0)
+    if (!sd || !data || !sink)
     {
         enj_error_put(err, ENJ_ERR_ARGUMENT);
         return -1;
     }
 
-    FILE* f = fdopen(dup(fd), "wb");
-    if (!f)
-    {
-        enj_error_put_posix_errno(err, ENJ_ERR_IO, errno);
+    enj_strspan* spans = 0;
+    size_t count = enj_strscan(data, length, &spans, err);
+    if (count == (size_t) -1)
         return -1;
-    }
 
     const char* str_data = (const char*) data;
 
-    for (size_t index = 0; index < length;)
+    for (size_t i = 0; i < count && !sink->error; ++i)
     {
-        const char* str = str_data + index;
-        size_t string_len = 0;
-        for (size_t i = index; str_data[i] && i < length; ++i)
-            ++string_len;
+        enj_strspan* span = &spans[i];
+        const char* str = str_data + span->offset;
 
-        if (!sd->show_empty && !string_len)
-        {
-            ++index;
+        if (!sd->show_empty && !span->length)
             continue;
-        }
 
         if (!sd->no_indices)
-            fprintf(f, "%04lX: ", index);
+        {
+            enjd_render_hex(sink, span->offset, 4);
+            enjd_render_literal(sink, ": ");
+        }
 
         if (sd->use_quotes)
-            fprintf(f, "\"");
+            enjd_sink_putc(sink, '"');
 
-        for (size_t i = 0; i < string_len; ++i)
+        // Copy printable runs as a whole, replacing the bytes between them
+        if (span->printable)
+            enjd_sink_write(sink, str, span->length);
+        else
         {
-            char c = str[i];
-            fprintf(f, "%c", isprint(c) ? c : sd->unprintable_char);
+            for (size_t pos = 0; pos < span->length;)
+            {
+                size_t run = enj_strscan_printable(str + pos, span->length - pos);
+                enjd_sink_write(sink, str + pos, run);
+                pos += run;
+
+                for (; pos < span->length && !enj_strscan_printable(str + pos, 1); ++pos)
+                    enjd_sink_putc(sink, sd->unprintable_char);
+            }
         }
 
-        index += string_len + 1;
+        if (sd->use_quotes)
+            enjd_sink_putc(sink, '"');
 
-        fprintf(f, "%s\n", sd->use_quotes ? "\"" : "");
+        enjd_sink_putc(sink, '\n');
     }
 
-    fclose(f);
-    return 0;
+    enj_free(spans);
+
+    return enjd_sink_error(sink, err);
+}
+
+int enjd_strings_dumper_run(enjd_strings_dumper* sd, void const* data, size_t length, int fd, enj_error** err)
+{
+    if (fd <= 0)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enjd_sink* sink = enjd_sink_create_fd(fd, err);
+    if (!sink)
+        return -1;
+
+    int ret = enjd_strings_dumper_run_sink(sd, data, length, sink, err);
+    if (ret == 0)
+        ret = enjd_sink_flush(sink, err);
+
+    enjd_sink_delete(sink);
+
+    return ret;
 }
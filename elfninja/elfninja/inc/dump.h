@@ -21,6 +21,8 @@
 
 #include "elfninja/core/core.h"
 #include "elfninja/input/input.h"
+#include "elfninja/dump/sink.h"
+#include "elfninja/dump/formatter.h"
 
 #include "plugin.h"
 
@@ -29,10 +31,24 @@ typedef struct enjp_dump_tool
 	enji_cmdline* cmd;
 	enj_elf* elf;
 
+	// Buffered standard output, flushed after each command
+	enjd_sink* out;
+
 	int allow_flourish;
 	int allow_spacers;
+
+	// ENJD_OUTPUT_TEXT, or records for --output=jsonl|csv|columnar=<path>
+	int output;
+	const char* columnar_path;
+
+	// Threads available to this command for its own jobs (see --jobs)
+	size_t jobs;
 } enjp_dump_tool;
 
+// Command flags
+#define ENJP_DUMP_COLUMNAR 0x1
+#define ENJP_DUMP_STDOUT   0x2 // Writes to stdout by itself, never buffered
+
 typedef struct enjp_dump_command
 {
     const char* name;
@@ -40,6 +56,7 @@ typedef struct enjp_dump_command
 
     int(*help)();
     int(*run)(enjp_dump_tool*, enji_cmdline_argument*, enj_error**);
+    int flags;
 
     struct enjp_dump_command* next;
     struct enjp_dump_command* prev;
@@ -48,6 +65,14 @@ typedef struct enjp_dump_command
 ENJP_PLUGIN_API enjp_dump_command* enjp_dump_commands();
 ENJP_PLUGIN_API enjp_dump_command* enjp_dump_resolve_command(const char* name, enj_error** err);
 ENJP_PLUGIN_API int enjp_dump_register_command(enjp_dump_command* cmd, enj_error** err);
+// Run count independent jobs and append their output to d->out in order.
+// With d->jobs > 1 each job runs on a worker thread with a copy of d whose
+//   out is a memory sink of its own ; otherwise jobs run in place on d. The
+//   first failing job stops the others and its output is the last emitted.
+typedef int(*enjp_dump_job)(enjp_dump_tool* d, size_t index, void* arg, enj_error** err);
+ENJP_PLUGIN_API int enjp_dump_run_jobs(enjp_dump_tool* d, size_t count, enjp_dump_job job, void* arg, enj_error** err);
+
+ENJP_PLUGIN_API enjd_program* enjp_dump_compile(enjp_dump_tool* d, enjd_formatter* fmt, const char* fmt_string, const char* default_string, enj_error** err);
 
 int enjp_dump_help(enji_cmdline* cmd);
 int enjp_dump_run(enji_cmdline* cmd);
@@ -0,0 +1,132 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+
+#include "tool.h"
+#include "log.h"
+
+#include "elfninja/core/core.h"
+#include "elfninja/input/input.h"
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+static const char* _help_msg =
+"Usage : elfninja compact <file>\n"
+"Remove dead bytes from the file : gaps between sections and headers, data no\n"
+"longer referenced by any header, and unused section names.\n"
+"Loadable segments are only moved by multiples of their alignment, so that\n"
+"p_offset = p_vaddr (mod p_align) still holds ; contents of segments are kept as is.\n"
+;
+
+int enjp_compact_help(enji_cmdline* cmd)
+{
+    printf("%s", _help_msg);
+
+    return 0;
+}
+
+int enjp_compact_run(enji_cmdline* cmd)
+{
+    if (!cmd)
+        return -1;
+
+    enj_error* err = 0;
+
+    // Get file name from command line
+    enji_cmdline_argument* file = enji_cmdline_find_argument_by_index(cmd, 0, 0);
+    if (!file)
+        enjp_fatal(0, "No file specified. Try 'elfninja help compact'");
+
+    // Try to open the file
+    int fd = open(file->name->string, O_RDWR);
+    if (fd <= 0)
+        enjp_fatal(0, "Unable to open '%s' for writing", file->name->string);
+
+    // Create the ELF object
+    enj_elf* elf = enj_elf_create_fd(fd, &err);
+    if (!elf)
+    {
+        enjp_error(&err, "Unable to read file '%s' as ELF", file->name->string);
+        close(fd);
+        return -1;
+    }
+
+    size_t saved = 0;
+    if (enj_elf_compact(elf, &saved, &err) < 0)
+    {
+        enjp_error(&err, "Unable to compact file");
+        goto fail;
+    }
+
+    if (enj_elf_push(elf, &err) < 0)
+    {
+        enjp_error(&err, "Unable to push changes to ELF");
+        goto fail;
+    }
+
+    // Write back, and truncate the file to its new size
+    off_t off = lseek(fd, 0, SEEK_SET);
+    if (off < 0)
+    {
+        enj_error_put_posix_errno(&err, ENJ_ERR_IO, errno);
+        enjp_error(&err, "Unable to write back changes to file");
+        goto fail;
+    }
+
+    ssize_t count = write(fd, elf->blob->buffer, elf->blob->buffer_size);
+    if (count < 0 || (size_t) count != elf->blob->buffer_size ||
+        ftruncate(fd, elf->blob->buffer_size) < 0)
+    {
+        enj_error_put_posix_errno(&err, ENJ_ERR_IO, errno);
+        enjp_error(&err, "Unable to write back changes to file");
+        goto fail;
+    }
+
+    enjp_message("Removed %ld dead bytes", saved);
+
+    enj_elf_delete(elf);
+    close(fd);
+    return 0;
+
+fail:
+    enj_elf_delete(elf);
+    close(fd);
+    return -1;
+}
+
+static enjp_tool _this_tool =
+{
+    "compact",
+    "Remove dead bytes from an ELF file",
+    &enjp_compact_help,
+    &enjp_compact_run
+};
+
+static __attribute__((constructor(111))) void _register()
+{
+    enj_error* err = 0;
+
+    if (enjp_tool_register(&_this_tool, &err) < 0)
+        enjp_fatal(&err, "Unable to register tool 'compact'");
+}
@@ -99,7 +99,7 @@ int enjp_data_read_input(enjp_data_tool* d, enji_cmdline_argument* arg, const ch
         return -1;
     }
 
-    if (err || d->file_offset > d->elf->blob->buffer_size)
+    if (d->file_offset > d->elf->blob->buffer_size)
     {
         enjp_error(err, "Invalid start offset");
         return -1;
@@ -50,6 +50,26 @@ int enjp_data_insert_run(enjp_data_tool* d, enji_cmdline_argument* arg, enj_erro
 
     enjp_message("Inserting %ld bytes at file offset 0x%08lX", d->effective_length, d->file_offset);
 
+    // In relocatable objects, relocation offsets are relative to their target section,
+    //  so find out which section the data goes into
+    enj_elf_shdr* target = 0;
+    if (ENJ_ELF_EHDR_GET(d->elf, e_type) == ET_REL)
+    {
+        for (enj_elf_shdr* section = d->elf->sections; section; section = section->next)
+        {
+            if (section->data && section->data->length &&
+                d->file_offset >= section->data->start->pos &&
+                d->file_offset < section->data->end->pos)
+            {
+                target = section;
+                break;
+            }
+        }
+    }
+
+    size_t target_offset = target ? d->file_offset - target->data->start->pos : 0;
+    size_t inserted = 0;
+
     for (size_t i = 0; i < d->count; ++i)
     {
         size_t off = d->file_offset + i * d->length;
@@ -63,6 +83,28 @@ int enjp_data_insert_run(enjp_data_tool* d, enji_cmdline_argument* arg, enj_erro
             enjp_error(err, "Unable to insert data into blob");
             return -1;
         }
+
+        inserted += length;
+    }
+
+    // Shift the relocations applying past the insertion point
+    if (target)
+    {
+        for (enj_elf_shdr* section = d->elf->sections; section; section = section->next)
+        {
+            if (!section->content_view || section->content_view->tag != ENJ_ELF_RELOC || !section->content)
+                continue;
+
+            enj_reloc* reloc = (enj_reloc*) section->content;
+            if (reloc->target != target)
+                continue;
+
+            if (enj_reloc_shift(reloc, target_offset, UINT64_MAX, inserted, ENJ_RELOC_SHIFT_OFFSETS, err) < 0)
+            {
+                enjp_error(err, "Unable to shift relocations in section %ld", section->index);
+                return -1;
+            }
+        }
     }
 
     if (!enji_cmdline_find_option(d->cmd, "no-update", ENJI_CMDLINE_TOOL, arg, 0))
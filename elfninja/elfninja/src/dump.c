@@ -15,6 +15,7 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#define _GNU_SOURCE
 
 #include "dump.h"
 #include "tool.h"
@@ -27,6 +28,8 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
 
 static enjp_dump_command* _commands = 0;
 static enjp_dump_command* _last_command = 0;
@@ -78,6 +81,198 @@ int enjp_dump_register_command(enjp_dump_command* cmd, enj_error** err)
     return 0;
 }
 
+enjd_program* enjp_dump_compile(enjp_dump_tool* d, enjd_formatter* fmt, const char* fmt_string, const char* default_string, enj_error** err)
+{
+    if (!d || !fmt || !fmt_string)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return 0;
+    }
+
+    if (d->output == ENJD_OUTPUT_TEXT)
+        return enjd_formatter_compile(fmt, fmt_string, err);
+
+    // Records hold every field unless the user picked some
+    return enjd_formatter_compile_records(fmt, fmt_string != default_string ? fmt_string : 0, d->output, err);
+}
+
+// State of one job run by enjp_dump_run_jobs
+typedef struct _dump_slot
+{
+    enjp_dump_tool tool;
+    int ret;
+    int done;
+    enj_error* err;
+} _dump_slot;
+
+typedef struct _dump_pool
+{
+    enjp_dump_job job;
+    void* arg;
+
+    _dump_slot* slots;
+    size_t count;
+
+    // Next job to start, and set once a job failed so that later ones
+    //   are skipped
+    atomic_size_t next;
+    atomic_int stop;
+
+    // Signals finished jobs to the thread emitting their output
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} _dump_pool;
+
+static void* _dump_worker(void* arg)
+{
+    _dump_pool* pool = (_dump_pool*) arg;
+
+    for (;;)
+    {
+        size_t index = atomic_fetch_add(&pool->next, 1);
+        if (index >= pool->count)
+            break;
+
+        // Jobs claimed after a failure come after the failed one and are
+        //   never emitted
+        _dump_slot* slot = &pool->slots[index];
+        if (!atomic_load(&pool->stop))
+        {
+            slot->ret = (*pool->job)(&slot->tool, index, pool->arg, &slot->err);
+            if (slot->ret == 0)
+                slot->ret = enjd_sink_error(slot->tool.out, &slot->err);
+
+            if (slot->ret < 0)
+                atomic_store(&pool->stop, 1);
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        slot->done = 1;
+        pthread_cond_broadcast(&pool->cond);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return 0;
+}
+
+int enjp_dump_run_jobs(enjp_dump_tool* d, size_t count, enjp_dump_job job, void* arg, enj_error** err)
+{
+    if (!d || !job)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    // Nothing to share, run in place
+    if (d->jobs <= 1 || count <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if ((*job)(d, i, arg, err) < 0)
+                return -1;
+        }
+
+        return 0;
+    }
+
+    size_t threads = d->jobs < count ? d->jobs : count;
+
+    _dump_pool pool;
+    pool.job = job;
+    pool.arg = arg;
+    pool.count = count;
+    atomic_init(&pool.next, 0);
+    atomic_init(&pool.stop, 0);
+
+    pool.slots = enj_malloc(count * sizeof(_dump_slot));
+    pthread_t* workers = enj_malloc(threads * sizeof(pthread_t));
+    if (!pool.slots || !workers)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        enj_free(pool.slots);
+        enj_free(workers);
+        return -1;
+    }
+
+    int ret = -1;
+    size_t slot_count = 0;
+    for (; slot_count < count; ++slot_count)
+    {
+        _dump_slot* slot = &pool.slots[slot_count];
+
+        // Jobs do not start jobs of their own
+        slot->tool = *d;
+        slot->tool.jobs = 1;
+        slot->ret = 0;
+        slot->done = 0;
+        slot->err = 0;
+
+        if (!(slot->tool.out = enjd_sink_create_memory(err)))
+            goto cleanup;
+    }
+
+    pthread_mutex_init(&pool.lock, 0);
+    pthread_cond_init(&pool.cond, 0);
+
+    size_t started = 0;
+    for (; started < threads; ++started)
+    {
+        if (pthread_create(&workers[started], 0, &_dump_worker, &pool))
+            break;
+    }
+
+    // Without any worker, the jobs still have to run
+    if (!started)
+        _dump_worker(&pool);
+
+    // Emit the outputs in order as soon as they are complete
+    ret = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        _dump_slot* slot = &pool.slots[i];
+
+        pthread_mutex_lock(&pool.lock);
+        while (!slot->done)
+            pthread_cond_wait(&pool.cond, &pool.lock);
+        pthread_mutex_unlock(&pool.lock);
+
+        enjd_sink_write(d->out, slot->tool.out->buffer, slot->tool.out->length);
+        enjd_sink_delete(slot->tool.out);
+        slot->tool.out = 0;
+
+        if (slot->ret < 0)
+        {
+            atomic_store(&pool.stop, 1);
+
+            if (err)
+            {
+                *err = slot->err;
+                slot->err = 0;
+            }
+
+            ret = -1;
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < started; ++i)
+        pthread_join(workers[i], 0);
+
+    pthread_cond_destroy(&pool.cond);
+    pthread_mutex_destroy(&pool.lock);
+
+cleanup:
+    for (size_t i = 0; i < slot_count; ++i)
+    {
+        enjd_sink_delete(pool.slots[i].tool.out);
+        enj_error_delete(pool.slots[i].err);
+    }
+
+    enj_free(pool.slots);
+    enj_free(workers);
+    return ret;
+}
+
 static const char* _help_msg =
 "The 'dump' tool allows viewing the content of an ELF file in a formatted\n"
 "fashion. Commands can be sequentially specified in order to select which\n"
@@ -104,15 +299,20 @@ static const char* _help_msg =
 "--no-flourish       Do not output flourish.\n"
 "--no-spacers        Do not output spacers.\n"
 "--no-headers        Do not use headers for table entries listing.\n"
+"--output=<kind>     Output kind : text (default), jsonl, csv or\n"
+"                    columnar=<path>.\n"
+"--jobs=<count>      Number of threads to use (defaults to the number of\n"
+"                    CPUs).\n"
 "\n"
 ".:: Flourish and spacers ::.\n"
 "\n"
-"The 'dump' tool will execute sequentially all the provided commands and\n"
-"send their output to stdout. To allow better visibility, flourish and\n"
-"spacers are added. Flourish are short titles that separate groups of dumps,\n"
-"for example in a symbol dump flourish will be added when the section changes.\n"
-"Spacers are simply new lines inserted in between consecutive comments. For\n"
-"example, the command 'elfninja dump /bin/ls ehdr ehdr' will output :\n"
+"The 'dump' tool will execute all the provided commands and send their\n"
+"output to stdout, in the order of the command line. To allow better\n"
+"visibility, flourish and spacers are added. Flourish are short titles that\n"
+"separate groups of dumps, for example in a symbol dump flourish will be added\n"
+"when the section changes. Spacers are simply new lines inserted in between\n"
+"consecutive comments. For example, the command\n"
+"'elfninja dump /bin/ls ehdr ehdr' will output :\n"
 "> .:: ELF File Header ::.      <--+-- flourish\n"
 ">                              <--+\n"
 "> class      = ELFCLASS64\n"
@@ -137,6 +337,30 @@ static const char* _help_msg =
 "--no-headers option.\n"
 "Please note that headers will be disabled when a user format is provided.\n"
 "\n"
+".:: Record outputs ::.\n"
+"\n"
+"Commands listing ELF structures (ehdr, shdr, phdr, symbols, dynamic and\n"
+"notes) can write one record per entry instead of formatted text, using\n"
+"--output=jsonl for JSON Lines (one JSON object per line) or --output=csv\n"
+"for comma-separated values with a header row. Integer fields are written as\n"
+"decimal numbers and strings are escaped as needed. Records hold all the\n"
+"fields of the command, or only the ones used in a user format. Flourish,\n"
+"spacers and headers are disabled for record outputs.\n"
+"\n"
+"The symbols and shdr commands also support --output=columnar=<path>, which\n"
+"writes binary column files for bulk loading : one little-endian array per\n"
+"field plus a blob of names, taken from the ELF structures without any\n"
+"formatting. The layout is described in elfninja/dump/columnar.h. Each\n"
+"command holds a whole file, so commands must use different paths.\n"
+"\n"
+".:: Jobs ::.\n"
+"\n"
+"Commands run at the same time on up to --jobs threads, and so do the\n"
+"sections dumped by a single 'symbols' or 'hex' command. Each job renders its\n"
+"output in memory, which is then written out in the order of the command line,\n"
+"so that the output does not depend on the number of jobs. Use --jobs=1 to run\n"
+"everything in turn and stream the output without buffering it.\n"
+"\n"
 ".:: Format strings ::.\n"
 "\n"
 "Internally, the 'dump' tool uses libelfninja_dump, which is a library that\n"
@@ -195,6 +419,108 @@ int enjp_dump_help(enji_cmdline* cmd)
     return 0;
 }
 
+// A command to run, with the common options it was given
+typedef struct _dump_item
+{
+    enjp_dump_tool tool;
+    enjp_dump_command* command;
+    enji_cmdline_argument* arg;
+} _dump_item;
+
+// Resolve a command and process its common options
+static int _prepare(_dump_item* item, enjp_dump_tool* d, enji_cmdline_argument* arg)
+{
+    enji_cmdline* cmd = d->cmd;
+
+    item->tool = *d;
+    item->arg = arg;
+
+    // Get common options
+    item->tool.allow_flourish = 1;
+    if (enji_cmdline_find_option(cmd, "no-flourish", ENJI_CMDLINE_TOOL | ENJI_CMDLINE_ORPHAN, arg, 0))
+        item->tool.allow_flourish = 0;
+
+    item->tool.allow_spacers = 1;
+    if (enji_cmdline_find_option(cmd, "no-spacers", ENJI_CMDLINE_TOOL | ENJI_CMDLINE_ORPHAN, arg, 0))
+        item->tool.allow_spacers = 0;
+
+    item->tool.output = ENJD_OUTPUT_TEXT;
+    item->tool.columnar_path = 0;
+    enji_cmdline_option* opt = enji_cmdline_find_option(cmd, "output", ENJI_CMDLINE_TOOL | ENJI_CMDLINE_ORPHAN, arg, 0);
+    if (opt)
+    {
+        if (!opt->value)
+        {
+            enjp_error(0, "Option 'output' expects a value");
+            return -1;
+        }
+
+        if (!strcmp(opt->value, "jsonl"))
+            item->tool.output = ENJD_OUTPUT_JSONL;
+        else if (!strcmp(opt->value, "csv"))
+            item->tool.output = ENJD_OUTPUT_CSV;
+        else if (!strncmp(opt->value, "columnar=", 9) && opt->value[9])
+        {
+            item->tool.output = ENJD_OUTPUT_COLUMNAR;
+            item->tool.columnar_path = opt->value + 9;
+        }
+        else if (strcmp(opt->value, "text"))
+        {
+            enjp_error(0, "Unknown output kind '%s'", opt->value);
+            return -1;
+        }
+
+        // Records are not decorated
+        if (item->tool.output != ENJD_OUTPUT_TEXT)
+        {
+            item->tool.allow_flourish = 0;
+            item->tool.allow_spacers = 0;
+        }
+    }
+
+    item->command = enjp_dump_resolve_command(arg->name->string, 0);
+    if (!item->command)
+    {
+        enjp_error(0, "No such command '%s'", arg->name->string);
+        return -1;
+    }
+
+    if (item->tool.output == ENJD_OUTPUT_COLUMNAR && !(item->command->flags & ENJP_DUMP_COLUMNAR))
+    {
+        enjp_error(0, "Command '%s' does not support columnar output", item->command->name);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int _run_command(enjp_dump_tool* d, size_t index, void* arg, enj_error** err)
+{
+    _dump_item* item = &((_dump_item*) arg)[index];
+
+    // Output and threads are the ones of the job
+    enjp_dump_tool tool = item->tool;
+    tool.out = d->out;
+    tool.jobs = d->jobs;
+
+    if ((*item->command->run)(&tool, item->arg, err) < 0)
+    {
+        enjp_error(err, "Unable to run command '%s'", item->command->name);
+        return -1;
+    }
+
+    if (tool.allow_spacers && item->arg->next)
+        enjd_sink_putc(tool.out, '\n');
+
+    if (enjd_sink_flush(tool.out, err) < 0)
+    {
+        enjp_error(err, "Unable to write output of command '%s'", item->command->name);
+        return -1;
+    }
+
+    return 0;
+}
+
 int enjp_dump_run(enji_cmdline* cmd)
 {
     if (!cmd)
@@ -214,11 +540,40 @@ int enjp_dump_run(enji_cmdline* cmd)
     if (enji_cmdline_rebase_options(cmd, file, &err) < 0)
         enjp_fatal(&err, "Unable to rebase cmdline options");
 
+    // Commands and large symbol tables are processed using all CPUs
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    d.jobs = cpus > 0 ? cpus : 1;
+
+    enji_cmdline_option* opt = enji_cmdline_find_option(cmd, "jobs", ENJI_CMDLINE_TOOL, 0, 0);
+    if (opt)
+    {
+        if (!opt->value)
+        {
+            enjp_error(0, "Option 'jobs' expects a value");
+            return -1;
+        }
+
+        d.jobs = enji_parse_number(opt->value, &err);
+        if (err)
+        {
+            enjp_error(&err, "Invalid value for option 'jobs'");
+            return -1;
+        }
+
+        if (!d.jobs)
+        {
+            enjp_error(0, "Option 'jobs' expects a non-zero value");
+            return -1;
+        }
+    }
+
     // Try to open the file
     int fd = open(file->name->string, O_RDONLY);
     if (fd <= 0)
         enjp_fatal(0, "Unable to open '%s'", file->name->string);
 
+    enj_elf_set_pull_threads(d.jobs);
+
     // Create the ELF object
     d.elf = enj_elf_create_fd(fd, &err);
     if (!d.elf)
@@ -228,6 +583,15 @@ int enjp_dump_run(enji_cmdline* cmd)
         return -1;
     }
 
+    // Dump commands only read the file, and may do so from several threads
+    if (enj_elf_freeze(d.elf, &err) < 0)
+    {
+        enjp_error(&err, "Unable to freeze ELF object");
+        enj_elf_delete(d.elf);
+        close(fd);
+        return -1;
+    }
+
     // Check if there's a subsequent argument
     if (!file->next)
     {
@@ -237,46 +601,97 @@ int enjp_dump_run(enji_cmdline* cmd)
         return -1;
     }
 
-    // Process all arguments sequentially as commands
-    for (enji_cmdline_argument* arg = file->next; arg; arg = arg->next)
+    // Commands format their output into a large buffer
+    d.out = enjd_sink_create_fd(1, &err);
+    if (!d.out)
     {
-        // Get common options
-        d.allow_flourish = 1;
-        if (enji_cmdline_find_option(cmd, "no-flourish", ENJI_CMDLINE_TOOL | ENJI_CMDLINE_ORPHAN, arg, 0))
-            d.allow_flourish = 0;
+        enjp_error(&err, "Unable to create output buffer");
+        enj_elf_delete(d.elf);
+        close(fd);
+        return -1;
+    }
 
-        d.allow_spacers = 1;
-        if (enji_cmdline_find_option(cmd, "no-spacers", ENJI_CMDLINE_TOOL | ENJI_CMDLINE_ORPHAN, arg, 0))
-            d.allow_spacers = 0;
+    size_t count = 0;
+    for (enji_cmdline_argument* arg = file->next; arg; arg = arg->next)
+        ++count;
 
-        enjp_dump_command* cmd = enjp_dump_resolve_command(arg->name->string, 0);
-        if (!cmd)
-        {
-            enjp_error(0, "No such command '%s'", arg->name->string);
-            goto fail;
-        }
+    _dump_item* items = enj_malloc(count * sizeof(_dump_item));
+    if (!items)
+    {
+        enj_error_put(&err, ENJ_ERR_MALLOC);
+        enjp_error(&err, "Unable to allocate commands");
+        enjd_sink_delete(d.out);
+        enj_elf_delete(d.elf);
+        close(fd);
+        return -1;
+    }
 
-        if ((*cmd->run)(&d, arg, &err) < 0)
+    // Prepare all commands ; those before an invalid one still run, as
+    //   they would have one after the other
+    int ret = 0;
+    size_t ready = 0;
+    int in_place = 0;
+    for (enji_cmdline_argument* arg = file->next; arg; arg = arg->next)
+    {
+        if (_prepare(&items[ready], &d, arg) < 0)
         {
-            enjp_error(&err, "Unable to run command '%s'", cmd->name);
-            goto fail;
+            ret = -1;
+            break;
         }
 
-        if (d.allow_spacers && arg->next)
+        // Columnar files are truncated by the command writing them
+        const char* path = items[ready].tool.columnar_path;
+        for (size_t i = 0; path && i < ready; ++i)
         {
-            printf("\n");
-            fflush(stdout);
+            if (items[i].tool.columnar_path && !strcmp(items[i].tool.columnar_path, path))
+            {
+                enjp_error(0, "Columnar output '%s' is already written by command '%s'", path, items[i].command->name);
+                ret = -1;
+                break;
+            }
         }
+
+        if (ret < 0)
+            break;
+
+        if ((items[ready].command->flags & ENJP_DUMP_STDOUT) || path)
+            in_place = 1;
+
+        ++ready;
     }
 
-    enj_elf_delete(d.elf);
-    close(fd);
-    return 0;
+    // Commands writing to stdout or to files by themselves have to run one after
+    //   the other ; otherwise they render on their own and are emitted in order
+    int run;
+    if (in_place)
+    {
+        run = 0;
+        for (size_t i = 0; i < ready && run == 0; ++i)
+            run = _run_command(&d, i, items, &err);
+    }
+    else
+        run = enjp_dump_run_jobs(&d, ready, &_run_command, items, &err);
+
+    if (run < 0)
+    {
+        if (err)
+            enjp_error(&err, "Unable to run commands");
+
+        ret = -1;
+    }
+
+    // Still show what was formatted before any failure
+    if (enjd_sink_flush(d.out, &err) < 0)
+    {
+        enjp_error(&err, "Unable to write output");
+        ret = -1;
+    }
 
-fail:
+    enj_free(items);
+    enjd_sink_delete(d.out);
     enj_elf_delete(d.elf);
     close(fd);
-    return -1;
+    return ret;
 }
 
 static enjp_tool _this_tool =
@@ -15,6 +15,7 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#define _GNU_SOURCE
 
 #include "dump.h"
 #include "tool.h"
@@ -29,15 +30,77 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <sys/sendfile.h>
 
 int enjp_dump_bin_help()
 {
     return 0;
 }
 
+// Write length bytes of the file from start on. While the blob still holds
+//   the file as it was read, the kernel copies them from the file itself :
+//   copy_file_range between regular files, sendfile otherwise (pipes,
+//   sockets, terminals...). Whatever is left goes through write().
+static int _write_range(int out_fd, enj_elf* elf, size_t start, size_t length, enj_error** err)
+{
+    if (elf->source_fd > 0 && !elf->blob->dirty)
+    {
+        loff_t offset = start;
+        while (length)
+        {
+            ssize_t count = copy_file_range(elf->source_fd, &offset, out_fd, 0, length, 0);
+            if (count < 0 && errno == EINTR)
+                continue;
+            else if (count <= 0)
+                break;
+
+            length -= count;
+        }
+
+        off_t send_offset = offset;
+        while (length)
+        {
+            ssize_t count = sendfile(out_fd, elf->source_fd, &send_offset, length);
+            if (count < 0 && errno == EINTR)
+                continue;
+            else if (count <= 0)
+                break;
+
+            length -= count;
+        }
+
+        start = send_offset;
+    }
+
+    const unsigned char* buffer = elf->blob->buffer + start;
+    while (length)
+    {
+        ssize_t count = write(out_fd, buffer, length);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            enj_error_put_posix_errno(err, ENJ_ERR_IO, errno);
+            return -1;
+        }
+        else if (!count)
+        {
+            enj_error_put(err, ENJ_ERR_IO);
+            return -1;
+        }
+
+        buffer += count;
+        length -= count;
+    }
+
+    return 0;
+}
+
 int enjp_dump_bin_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error** err)
 {
     const char* pattern = arg->value;
+    enji_pattern* sections_pattern = 0;
 
     int file_fd = 0;
     ssize_t from = -1;
@@ -109,12 +172,11 @@ int enjp_dump_bin_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error**
         }
     }
 
-    void* buffer = 0;
+    size_t start = 0;
     size_t buffer_size = 0;
 
     if (!pattern)
     {
-        buffer = d->elf->blob->buffer;
         buffer_size = d->elf->blob->buffer_size;
 
         if (to >= 0)
@@ -131,7 +193,7 @@ int enjp_dump_bin_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error**
                 enj_error_put(err, ENJ_ERR_BAD_OFFSET);
             else
             {
-                buffer += from;
+                start += from;
                 buffer_size -= from;
             }
         }
@@ -143,18 +205,21 @@ int enjp_dump_bin_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error**
         }
 
         enjp_message("Dumping %ld bytes from file", buffer_size);
-        size_t count = write(file_fd, buffer, buffer_size);
-        if (count != buffer_size)
+        if (_write_range(file_fd, d->elf, start, buffer_size, err) < 0)
         {
-            if (count < 0)
-                enj_error_put_posix_errno(err, ENJ_ERR_IO, count);
-
             enjp_error(err, "Failed to write to file");
             goto fail;
         }
     }
     else
     {
+        // Compile the eventual input pattern once for all sections
+        if (pattern && !(sections_pattern = enji_pattern_compile(pattern, ENJI_PATTERN_SECTIONS, err)))
+        {
+            enjp_error(err, "Invalid section pattern");
+            goto fail;
+        }
+
         // Now process the sections
         for (enj_elf_shdr* section = d->elf->sections; section; section = section->next)
         {
@@ -166,17 +231,8 @@ int enjp_dump_bin_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error**
                     continue;
 
                 // Ignore sections that do not match the pattern
-                int match;
-                if ((match = enji_pattern_match(section, pattern, err)) <= 0)
-                {
-                    if (match < 0)
-                    {
-                        enjp_error(err, "Invalid section pattern");
-                        goto fail;
-                    }
-
+                if (!enji_pattern_match_section(sections_pattern, section))
                     continue;
-                }
             }
 
             // If the section does not have any content, it may be malformed
@@ -197,7 +253,7 @@ int enjp_dump_bin_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error**
                 continue;
             }
 
-            buffer =  section->elf->blob->buffer + section->data->start->pos;
+            start = section->data->start->pos;
             buffer_size = section->data->length;
 
             if (to >= 0)
@@ -214,7 +270,7 @@ int enjp_dump_bin_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error**
                     enj_error_put(err, ENJ_ERR_BAD_OFFSET);
                 else
                 {
-                    buffer += from;
+                    start += from;
                     buffer_size -= from;
                 }
             }
@@ -227,12 +283,8 @@ int enjp_dump_bin_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error**
 
             enjp_message("Dumping %ld bytes from section #%ld (%s)", buffer_size, section->index, section->cached_name ? section->cached_name->string : "");
 
-            size_t count = write(file_fd, buffer, buffer_size);
-            if (count != buffer_size)
+            if (_write_range(file_fd, d->elf, start, buffer_size, err) < 0)
             {
-                if (count < 0)
-                    enj_error_put_posix_errno(err, ENJ_ERR_IO, count);
-
                 enjp_error(err, "write failed");
                 goto fail;
             }
@@ -241,9 +293,11 @@ int enjp_dump_bin_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error**
 
 
     close(file_fd);
+    enji_pattern_delete(sections_pattern);
     return 0;
 
 fail:
+    enji_pattern_delete(sections_pattern);
     close(file_fd);
     return -1;
 }
@@ -253,7 +307,8 @@ static enjp_dump_command _this_cmd =
     "bin",
     "Extract raw section content",
     &enjp_dump_bin_help,
-    &enjp_dump_bin_run
+    &enjp_dump_bin_run,
+    ENJP_DUMP_STDOUT
 };
 
 static __attribute__((constructor(206))) void _register()
@@ -45,6 +45,7 @@ int enjp_dump_dynamic_help()
 int enjp_dump_dynamic_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error** err)
 {
     const char* pattern = arg->value;
+    enji_pattern* sections_pattern = 0;
     const char* fmt_string = _dynamic_entry_fmt_string;
 
     // Process options for this command
@@ -68,15 +69,31 @@ int enjp_dump_dynamic_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_err
         return -1;
     }
 
+    // Compile the format once for all entries
+    enjd_program* prog = enjp_dump_compile(d, fmt, fmt_string, _dynamic_entry_fmt_string, err);
+    if (!prog)
+    {
+        enjp_error(err, "Invalid format string");
+        enjd_formatter_delete(fmt);
+        return -1;
+    }
+
     // Use headers if the default format is used and the user is OK with it
     int allow_headers = 1;
     if (enji_cmdline_find_option(d->cmd, "no-headers", ENJI_CMDLINE_TOOL | ENJI_CMDLINE_ORPHAN, arg, 0) ||
-        fmt_string != _dynamic_entry_fmt_string)
+        fmt_string != _dynamic_entry_fmt_string || d->output != ENJD_OUTPUT_TEXT)
         allow_headers = 0;
 
     // To manage spacers
     int first_one = 1;
 
+    // Compile the eventual input pattern once for all sections
+    if (pattern && !(sections_pattern = enji_pattern_compile(pattern, ENJI_PATTERN_SECTIONS, err)))
+    {
+        enjp_error(err, "Invalid section pattern");
+        goto fail;
+    }
+
     // Now process the sections
     for (enj_elf_shdr* section = d->elf->sections; section; section = section->next)
     {
@@ -88,17 +105,8 @@ int enjp_dump_dynamic_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_err
                 continue;
 
             // Ignore sections that do not match the pattern
-            int match;
-            if ((match = enji_pattern_match(section, pattern, err)) <= 0)
-            {
-                if (match < 0)
-                {
-                    enjp_error(err, "Invalid section pattern");
-                    goto fail;
-                }
-
+            if (!enji_pattern_match_section(sections_pattern, section))
                 continue;
-            }
         }
 
         // Only process symbol sections
@@ -123,27 +131,24 @@ int enjp_dump_dynamic_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_err
 
         if (!first_one && d->allow_spacers)
         {
-            printf("\n");
-            fflush(stdout);
+            enjd_sink_printf(d->out, "\n");
         }
 
         if (d->allow_flourish)
         {
-            printf(".:: Dynamic entries for section #%ld (%s) ::.\n\n", section->index, section->cached_name ? section->cached_name->string : "");
-            fflush(stdout);
+            enjd_sink_printf(d->out, ".:: Dynamic entries for section #%ld (%s) ::.\n\n", section->index, section->cached_name ? section->cached_name->string : "");
         }
 
         if (allow_headers)
         {
-            printf("%s", d->elf->bits == 64 ? _dynamic_entry_header64 : _dynamic_entry_header32);
-            fflush(stdout);
+            enjd_sink_printf(d->out, "%s", d->elf->bits == 64 ? _dynamic_entry_header64 : _dynamic_entry_header32);
         }
 
         enj_dynamic* dynamic = (enj_dynamic*) section->content;
         for (enj_dynamic_entry* dyn = dynamic->entries; dyn; dyn = dyn->next)
         {
-            // Run the formatter
-            if (enjd_formatter_run(fmt, fmt_string, (void*) dyn, 1, err) < 0)
+            // Run the compiled format
+            if (enjd_program_run(prog, (void*) dyn, d->out, err) < 0)
             {
                 enjp_error(err, "Unable to run formatter");
                 goto fail;
@@ -153,10 +158,14 @@ int enjp_dump_dynamic_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_err
         first_one = 0;
     }
 
+    enjd_program_delete(prog);
     enjd_formatter_delete(fmt);
+    enji_pattern_delete(sections_pattern);
     return 0;
 
 fail:
+    enji_pattern_delete(sections_pattern);
+    enjd_program_delete(prog);
     enjd_formatter_delete(fmt);
     return -1;
 }
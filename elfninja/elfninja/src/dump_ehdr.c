@@ -75,8 +75,7 @@ int enjp_dump_ehdr_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error*
 
     if (d->allow_flourish)
     {
-        printf(".:: ELF File Header ::.\n\n");
-        fflush(stdout);
+        enjd_sink_printf(d->out, ".:: ELF File Header ::.\n\n");
     }
 
     // Create the formatter object, run it on the format
@@ -87,13 +86,23 @@ int enjp_dump_ehdr_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error*
         return -1;
     }
 
-    if (enjd_formatter_run(fmt, fmt_string, (void*) d->elf, 1, err) < 0)
+    enjd_program* prog = enjp_dump_compile(d, fmt, fmt_string, _ehdr_fmt_string, err);
+    if (!prog)
+    {
+        enjp_error(err, "Invalid format string");
+        enjd_formatter_delete(fmt);
+        return -1;
+    }
+
+    if (enjd_program_run(prog, (void*) d->elf, d->out, err) < 0)
     {
         enjp_error(err, "Unable to run formatter");
+        enjd_program_delete(prog);
         enjd_formatter_delete(fmt);
         return -1;
     }
 
+    enjd_program_delete(prog);
     enjd_formatter_delete(fmt);
     return 0;
 }
@@ -31,9 +31,47 @@ int enjp_dump_hex_help()
     return 0;
 }
 
+// Sections dumped by a single hex command, one job each
+typedef struct _hex_job
+{
+    enjd_hex_dumper* hd;
+    enj_elf_shdr** sections;
+} _hex_job;
+
+static int _hex_section(enjp_dump_tool* d, size_t index, void* arg, enj_error** err)
+{
+    _hex_job* job = (_hex_job*) arg;
+    enj_elf_shdr* section = job->sections[index];
+
+    if (index && d->allow_spacers)
+    {
+        enjd_sink_printf(d->out, "\n");
+    }
+
+    if (d->allow_flourish)
+    {
+        enjd_sink_printf(d->out, ".:: Hex dump for section #%ld (%s) ::.\n\n", section->index, section->cached_name ? section->cached_name->string : "");
+    }
+
+    if (enjd_hex_dumper_run_sink(job->hd, section->elf->blob->buffer + section->data->start->pos, section->data->length, d->out, err) < 0)
+    {
+        enjp_error(err, "Unable to run dumper");
+        return -1;
+    }
+
+    return 0;
+}
+
 int enjp_dump_hex_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error** err)
 {
     const char* pattern = arg->value;
+    enji_pattern* sections_pattern = 0;
+
+    if (d->output != ENJD_OUTPUT_TEXT)
+    {
+        enjp_error(0, "Command 'hex' only supports text output");
+        return -1;
+    }
 
     // Create the hex dumper object
     enjd_hex_dumper* hd = enjd_hex_dumper_create(err);
@@ -43,6 +81,10 @@ int enjp_dump_hex_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error**
         return -1;
     }
 
+    _hex_job job;
+    job.hd = hd;
+    job.sections = 0;
+
     // Process options for this command
     enji_cmdline_option* opt;
     if ((opt = enji_cmdline_find_option(d->cmd, "stride", ENJI_CMDLINE_TOOL, arg, 0)))
@@ -135,44 +177,47 @@ int enjp_dump_hex_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error**
     {
         if (d->allow_flourish)
         {
-            printf(".:: Hex dump for whole file ::.\n\n");
-            fflush(stdout);
+            enjd_sink_printf(d->out, ".:: Hex dump for whole file ::.\n\n");
         }
 
-        if (enjd_hex_dumper_run(hd, d->elf->blob->buffer, d->elf->blob->buffer_size, 1, err) < 0)
+        if (enjd_hex_dumper_run_sink(hd, d->elf->blob->buffer, d->elf->blob->buffer_size, d->out, err) < 0)
         {
             enjp_error(err, "Unable to run dumper");
-            return -1;
+            goto fail;
         }
     }
     else
     {
-        // To manage spacers
-        int first_one = 1;
+        size_t section_count = 0;
+        for (enj_elf_shdr* section = d->elf->sections; section; section = section->next)
+            ++section_count;
 
-        // Now process the sections
+        job.sections = enj_malloc((section_count + 1) * sizeof(enj_elf_shdr*));
+        if (!job.sections)
+        {
+            enj_error_put(err, ENJ_ERR_MALLOC);
+            enjp_error(err, "Unable to gather sections");
+            goto fail;
+        }
+
+        // Compile the eventual input pattern once for all sections
+        if (pattern && !(sections_pattern = enji_pattern_compile(pattern, ENJI_PATTERN_SECTIONS, err)))
+        {
+            enjp_error(err, "Invalid section pattern");
+            goto fail;
+        }
+
+        // Pick the sections to dump, they are then dumped as separate jobs
+        size_t job_count = 0;
         for (enj_elf_shdr* section = d->elf->sections; section; section = section->next)
         {
-            // Process the eventual input pattern
-            if (pattern)
-            {
-                // Ignore unnamed sections
-                if (!section->cached_name)
-                    continue;
-
-                // Ignore sections that do not match the pattern
-                int match;
-                if ((match = enji_pattern_match(section, pattern, err)) <= 0)
-                {
-                    if (match < 0)
-                    {
-                        enjp_error(err, "Invalid section pattern");
-                        goto fail;
-                    }
-
-                    continue;
-                }
-            }
+            // Ignore unnamed sections
+            if (!section->cached_name)
+                continue;
+
+            // Ignore sections that do not match the pattern
+            if (!enji_pattern_match_section(sections_pattern, section))
+                continue;
 
             // If the section does not have any content, it may be malformed
             if (!section->data)
@@ -186,38 +231,25 @@ int enjp_dump_hex_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error**
             // Ignore empty sections
             if (!section->data->length)
             {
-                if (pattern)
-                    enjp_warning(0, "Section #%ld (%s) is empty, ignoring", section->index, section->cached_name ? section->cached_name->string : "");
-
+                enjp_warning(0, "Section #%ld (%s) is empty, ignoring", section->index, section->cached_name ? section->cached_name->string : "");
                 continue;
             }
 
-            if (!first_one && d->allow_spacers)
-            {
-                printf("\n");
-                fflush(stdout);
-            }
-
-            if (d->allow_flourish)
-            {
-                printf(".:: Hex dump for section #%ld (%s) ::.\n\n", section->index, section->cached_name ? section->cached_name->string : "");
-                fflush(stdout);
-            }
-
-            if (enjd_hex_dumper_run(hd, section->elf->blob->buffer + section->data->start->pos, section->data->length, 1, err) < 0)
-            {
-                enjp_error(err, "Unable to run dumper");
-                return -1;
-            }
-
-            first_one = 0;
+            job.sections[job_count++] = section;
         }
+
+        if (enjp_dump_run_jobs(d, job_count, &_hex_section, &job, err) < 0)
+            goto fail;
     }
 
+    enj_free(job.sections);
     enjd_hex_dumper_delete(hd);
+    enji_pattern_delete(sections_pattern);
     return 0;
 
 fail:
+    enji_pattern_delete(sections_pattern);
+    enj_free(job.sections);
     enjd_hex_dumper_delete(hd);
     return -1;
 }
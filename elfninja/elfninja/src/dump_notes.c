@@ -69,6 +69,9 @@ int enjp_dump_notes_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error
     // To manage spacers
     int first_one = 1;
 
+    // CSV outputs only repeat their header when the note type changes
+    const enj_note_content_view* last_view = 0;
+
     // Now process the sections
     for (enj_elf_shdr* section = d->elf->sections; section; section = section->next)
     {
@@ -115,15 +118,12 @@ int enjp_dump_notes_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error
 
         if (!first_one && d->allow_spacers)
         {
-            // Don't forget to flush as libelfninja_dump uses dup()
-            printf("\n");
-            fflush(stdout);
+            enjd_sink_printf(d->out, "\n");
         }
 
         if (d->allow_flourish)
         {
-            printf(".:: Notes for section #%ld (%s) ::.\n\n", section->index, section->cached_name ? section->cached_name->string : "");
-            fflush(stdout);
+            enjd_sink_printf(d->out, ".:: Notes for section #%ld (%s) ::.\n\n", section->index, section->cached_name ? section->cached_name->string : "");
         }
 
         enj_nsect* nsect = (enj_nsect*) section->content;
@@ -140,7 +140,7 @@ int enjp_dump_notes_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error
 
             // Print the header if needed
             if (!enji_cmdline_find_option(d->cmd, "no-headers", ENJI_CMDLINE_TOOL | ENJI_CMDLINE_ORPHAN, arg, 0) &&
-                !fmt_string)
+                !fmt_string && d->output == ENJD_OUTPUT_TEXT)
             {
                 const char* header = 0;
 
@@ -157,8 +157,7 @@ int enjp_dump_notes_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error
 
                 if (header)
                 {
-                    printf("%s", header);
-                    fflush(stdout);
+                    enjd_sink_printf(d->out, "%s", header);
                 }
             }
 
@@ -183,13 +182,27 @@ int enjp_dump_notes_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error
             }
 
             // Run the formatter
-            if (enjd_formatter_run(fmt, note_fmt_string, (void*) note, 1, err) < 0)
+            enjd_program* prog = enjp_dump_compile(d, fmt, note_fmt_string, fmt_string ? 0 : note_fmt_string, err);
+            if (!prog)
+            {
+                enjp_error(err, "Invalid format string");
+                enjd_formatter_delete(fmt);
+                return -1;
+            }
+
+            if (note->content_view == last_view)
+                prog->header_done = 1;
+            last_view = note->content_view;
+
+            if (enjd_program_run(prog, (void*) note, d->out, err) < 0)
             {
                 enjp_error(err, "Unable to run formatter");
+                enjd_program_delete(prog);
                 enjd_formatter_delete(fmt);
                 return -1;
             }
 
+            enjd_program_delete(prog);
             enjd_formatter_delete(fmt);
         }
 
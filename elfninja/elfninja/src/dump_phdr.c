@@ -67,8 +67,7 @@ int enjp_dump_phdr_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error*
 
     if (d->allow_flourish)
     {
-        printf(".:: ELF Program Headers ::.\n\n");
-        fflush(stdout);
+        enjd_sink_printf(d->out, ".:: ELF Program Headers ::.\n\n");
     }
 
     // Create the dump formatter associated with program headers
@@ -79,31 +78,40 @@ int enjp_dump_phdr_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error*
         return -1;
     }
 
+    // Compile the format once for all entries
+    enjd_program* prog = enjp_dump_compile(d, fmt, fmt_string, _phdr_fmt_string, err);
+    if (!prog)
+    {
+        enjp_error(err, "Invalid format string");
+        enjd_formatter_delete(fmt);
+        return -1;
+    }
+
     // Print out a header if the format is the default one and if the user has
     //   nothing to say about it
     if (!enji_cmdline_find_option(d->cmd, "no-headers", ENJI_CMDLINE_TOOL | ENJI_CMDLINE_ORPHAN, arg, 0) &&
-        fmt_string == _phdr_fmt_string)
+        fmt_string == _phdr_fmt_string && d->output == ENJD_OUTPUT_TEXT)
     {
-        // Don't forget to flush as libelfninja_dump uses dup()
-        printf("%s", d->elf->bits == 64 ? _phdr_header64 : _phdr_header32);
-        fflush(stdout);
+        enjd_sink_printf(d->out, "%s", d->elf->bits == 64 ? _phdr_header64 : _phdr_header32);
     }
 
     // Now process the segments
     for (enj_elf_phdr* segment = d->elf->segments; segment; segment = segment->next)
     {
         // Dump the segment contents
-        if (enjd_formatter_run(fmt, fmt_string, (void*) segment, 1, err) < 0)
+        if (enjd_program_run(prog, (void*) segment, d->out, err) < 0)
         {
             enjp_error(err, "Unable to run formatter");
             goto fail;
         }
     }
 
+    enjd_program_delete(prog);
     enjd_formatter_delete(fmt);
     return 0;
 
 fail:
+    enjd_program_delete(prog);
     enjd_formatter_delete(fmt);
     return -1;
 }
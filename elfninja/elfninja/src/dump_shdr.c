@@ -25,6 +25,8 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
+#include <fcntl.h>
+#include <errno.h>
 
 static const char* _shdr_header32 =
     "Index Name                 Type            Address          Offset           Size             Flag ES Lnk Info\n"
@@ -42,6 +44,28 @@ int enjp_dump_shdr_help()
     return 0;
 }
 
+// Write the gathered sections to the columnar output file
+static int _write_columnar(enjp_dump_tool* d, enj_elf_shdr** rows, size_t row_count, enj_error** err)
+{
+    int fd = open(d->columnar_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        enj_error_put_posix_errno(err, ENJ_ERR_IO, errno);
+        enjp_error(err, "Unable to open '%s'", d->columnar_path);
+        return -1;
+    }
+
+    if (enjd_columnar_write_sections(rows, row_count, fd, err) < 0)
+    {
+        enjp_error(err, "Unable to write '%s'", d->columnar_path);
+        close(fd);
+        return -1;
+    }
+
+    close(fd);
+    return 0;
+}
+
 int enjp_dump_shdr_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error** err)
 {
     if (!d || !d->cmd || !arg || !d->elf)
@@ -51,6 +75,7 @@ int enjp_dump_shdr_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error*
     }
 
     const char* pattern = arg->value;
+    enji_pattern* sections_pattern = 0;
     const char* fmt_string = _shdr_fmt_string;
 
     // Process options for this command
@@ -68,10 +93,14 @@ int enjp_dump_shdr_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error*
 
     if (d->allow_flourish)
     {
-        printf(".:: ELF Section Headers ::.\n\n");
-        fflush(stdout);
+        enjd_sink_printf(d->out, ".:: ELF Section Headers ::.\n\n");
     }
 
+    // Sections gathered for columnar outputs
+    enj_elf_shdr** rows = 0;
+    size_t row_count = 0;
+    size_t row_capacity = 0;
+
     // Create the dump formatter associated with section headers
     enjd_formatter* fmt = enjd_shdr_formatter_create(err);
     if (!fmt)
@@ -80,14 +109,29 @@ int enjp_dump_shdr_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error*
         return -1;
     }
 
+    // Compile the format once for all entries ; columnar outputs take the
+    //   sections as they are and have nothing to format
+    enjd_program* prog = 0;
+    if (d->output != ENJD_OUTPUT_COLUMNAR && !(prog = enjp_dump_compile(d, fmt, fmt_string, _shdr_fmt_string, err)))
+    {
+        enjp_error(err, "Invalid format string");
+        enjd_formatter_delete(fmt);
+        return -1;
+    }
+
     // Print out a header if the format is the default one and if the user has
     //   nothing to say about it
     if (!enji_cmdline_find_option(d->cmd, "no-headers", ENJI_CMDLINE_TOOL | ENJI_CMDLINE_ORPHAN, arg, 0) &&
-        fmt_string == _shdr_fmt_string)
+        fmt_string == _shdr_fmt_string && d->output == ENJD_OUTPUT_TEXT)
     {
-        // Don't forget to flush as libelfninja_dump uses dup()
-        printf("%s", d->elf->bits == 64 ? _shdr_header64 : _shdr_header32);
-        fflush(stdout);
+        enjd_sink_printf(d->out, "%s", d->elf->bits == 64 ? _shdr_header64 : _shdr_header32);
+    }
+
+    // Compile the eventual input pattern once for all sections
+    if (pattern && !(sections_pattern = enji_pattern_compile(pattern, ENJI_PATTERN_SECTIONS, err)))
+    {
+        enjp_error(err, "Invalid section pattern");
+        goto fail;
     }
 
     // Now process the sections
@@ -101,31 +145,53 @@ int enjp_dump_shdr_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error*
                 continue;
 
             // Ignore sections that do not match the pattern
-            int match;
-            if ((match = enji_pattern_match(section, pattern, err)) <= 0)
+            if (!enji_pattern_match_section(sections_pattern, section))
+                continue;
+        }
+
+        if (d->output == ENJD_OUTPUT_COLUMNAR)
+        {
+            if (row_count == row_capacity)
             {
-                if (match < 0)
+                size_t capacity = row_capacity ? 2 * row_capacity : 64;
+
+                enj_elf_shdr** grown = enj_realloc(rows, capacity * sizeof(enj_elf_shdr*));
+                if (!grown)
                 {
-                    enjp_error(err, "Invalid section pattern");
+                    enj_error_put(err, ENJ_ERR_MALLOC);
+                    enjp_error(err, "Unable to gather sections");
                     goto fail;
                 }
 
-                continue;
+                rows = grown;
+                row_capacity = capacity;
             }
+
+            rows[row_count++] = section;
+            continue;
         }
 
         // Dump the section contents
-        if (enjd_formatter_run(fmt, fmt_string, (void*) section, 1, err) < 0)
+        if (enjd_program_run(prog, (void*) section, d->out, err) < 0)
         {
             enjp_error(err, "Unable to run formatter");
             goto fail;
         }
     }
 
+    if (d->output == ENJD_OUTPUT_COLUMNAR && _write_columnar(d, rows, row_count, err) < 0)
+        goto fail;
+
+    enj_free(rows);
+    enjd_program_delete(prog);
     enjd_formatter_delete(fmt);
+    enji_pattern_delete(sections_pattern);
     return 0;
 
 fail:
+    enji_pattern_delete(sections_pattern);
+    enj_free(rows);
+    enjd_program_delete(prog);
     enjd_formatter_delete(fmt);
     return -1;
 }
@@ -135,7 +201,8 @@ static enjp_dump_command _this_cmd =
     "shdr",
     "Dump ELF section headers",
     &enjp_dump_shdr_help,
-    &enjp_dump_shdr_run
+    &enjp_dump_shdr_run,
+    ENJP_DUMP_COLUMNAR
 };
 
 static __attribute__((constructor(201))) void _register()
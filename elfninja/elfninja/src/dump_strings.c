@@ -34,6 +34,13 @@ int enjp_dump_strings_help()
 int enjp_dump_strings_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error** err)
 {
     const char* pattern = arg->value;
+    enji_pattern* sections_pattern = 0;
+
+    if (d->output != ENJD_OUTPUT_TEXT)
+    {
+        enjp_error(0, "Command 'strings' only supports text output");
+        return -1;
+    }
 
     // Create the string dumper object
     enjd_strings_dumper* sd = enjd_strings_dumper_create(err);
@@ -55,6 +62,13 @@ int enjp_dump_strings_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_err
     // To manage spacers
     int first_one = 1;
 
+    // Compile the eventual input pattern once for all sections
+    if (pattern && !(sections_pattern = enji_pattern_compile(pattern, ENJI_PATTERN_SECTIONS, err)))
+    {
+        enjp_error(err, "Invalid section pattern");
+        goto fail;
+    }
+
     // Now process the sections
     for (enj_elf_shdr* section = d->elf->sections; section; section = section->next)
     {
@@ -66,17 +80,8 @@ int enjp_dump_strings_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_err
                 continue;
 
             // Ignore sections that do not match the pattern
-            int match;
-            if ((match = enji_pattern_match(section, pattern, err)) <= 0)
-            {
-                if (match < 0)
-                {
-                    enjp_error(err, "Invalid section pattern");
-                    goto fail;
-                }
-
+            if (!enji_pattern_match_section(sections_pattern, section))
                 continue;
-            }
         }
 
         // Only process symbol sections
@@ -102,29 +107,29 @@ int enjp_dump_strings_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_err
 
         if (!first_one && d->allow_spacers)
         {
-            printf("\n");
-            fflush(stdout);
+            enjd_sink_printf(d->out, "\n");
         }
 
         if (d->allow_flourish)
         {
-            printf(".:: Strings for section #%ld (%s) ::.\n\n", section->index, section->cached_name ? section->cached_name->string : "");
-            fflush(stdout);
+            enjd_sink_printf(d->out, ".:: Strings for section #%ld (%s) ::.\n\n", section->index, section->cached_name ? section->cached_name->string : "");
         }
 
-        if (enjd_strings_dumper_run(sd, section->elf->blob->buffer + section->data->start->pos, section->data->length, 1, err) < 0)
+        if (enjd_strings_dumper_run_sink(sd, section->elf->blob->buffer + section->data->start->pos, section->data->length, d->out, err) < 0)
         {
             enjp_error(err, "Unable to run dumper");
-            return -1;
+            goto fail;
         }
 
         first_one = 0;
     }
 
     enjd_strings_dumper_delete(sd);
+    enji_pattern_delete(sections_pattern);
     return 0;
 
 fail:
+    enji_pattern_delete(sections_pattern);
     enjd_strings_dumper_delete(sd);
     return -1;
 }
@@ -25,7 +25,8 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
-#include <fnmatch.h>
+#include <fcntl.h>
+#include <errno.h>
 
 static const char* _symbol_header32 =
     "Index  Value            Size             Type          Bind           Visibility    Name                Section\n"
@@ -43,6 +44,95 @@ int enjp_dump_symbols_help()
     return 0;
 }
 
+// Write the gathered symbols to the columnar output file
+static int _write_columnar(enjp_dump_tool* d, enj_symbol** rows, size_t row_count, enj_error** err)
+{
+    int fd = open(d->columnar_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        enj_error_put_posix_errno(err, ENJ_ERR_IO, errno);
+        enjp_error(err, "Unable to open '%s'", d->columnar_path);
+        return -1;
+    }
+
+    if (enjd_columnar_write_symbols(rows, row_count, fd, err) < 0)
+    {
+        enjp_error(err, "Unable to write '%s'", d->columnar_path);
+        close(fd);
+        return -1;
+    }
+
+    close(fd);
+    return 0;
+}
+
+// Symbol sections dumped by a single command, one job each
+typedef struct _symbols_job
+{
+    enjd_formatter* fmt;
+    const char* fmt_string;
+    enjd_program* prog;
+
+    enji_pattern* filter;
+    int allow_headers;
+
+    enj_elf_shdr** sections;
+} _symbols_job;
+
+static int _symbols_section(enjp_dump_tool* d, size_t index, void* arg, enj_error** err)
+{
+    _symbols_job* job = (_symbols_job*) arg;
+    enj_elf_shdr* section = job->sections[index];
+
+    // Text formats are only read and can be shared, but records keep some
+    //   state while running and JSON lines jobs use programs of their own
+    enjd_program* prog = job->prog;
+    if (d->output == ENJD_OUTPUT_JSONL && !(prog = enjp_dump_compile(d, job->fmt, job->fmt_string, _symbol_fmt_string, err)))
+    {
+        enjp_error(err, "Invalid format string");
+        return -1;
+    }
+
+    if (index && d->allow_spacers)
+    {
+        enjd_sink_printf(d->out, "\n");
+    }
+
+    if (d->allow_flourish)
+    {
+        enjd_sink_printf(d->out, ".:: Symbols for section #%ld (%s) ::.\n\n", section->index, section->cached_name ? section->cached_name->string : "");
+    }
+
+    if (job->allow_headers)
+    {
+        enjd_sink_printf(d->out, "%s", d->elf->bits == 64 ? _symbol_header64 : _symbol_header32);
+    }
+
+    // Dump that shitz !
+    int ret = 0;
+    enj_symtab* symtab = (enj_symtab*) section->content;
+    for (enj_symbol* sym = symtab->symbols; sym; sym = sym->next)
+    {
+        // Ignore symbols that do not match the eventual filter pattern,
+        //   unnamed symbols never match
+        if (job->filter && !enji_pattern_match_name(job->filter, sym->cached_name))
+            continue;
+
+        // Run the compiled format
+        if (enjd_program_run(prog, (void*) sym, d->out, err) < 0)
+        {
+            enjp_error(err, "Unable to run formatter");
+            ret = -1;
+            break;
+        }
+    }
+
+    if (prog != job->prog)
+        enjd_program_delete(prog);
+
+    return ret;
+}
+
 int enjp_dump_symbols_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_error** err)
 {
     const char* pattern = arg->value;
@@ -81,16 +171,62 @@ int enjp_dump_symbols_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_err
         return -1;
     }
 
+    // Symbols gathered for columnar outputs
+    enj_symbol** rows = 0;
+    size_t row_count = 0;
+    size_t row_capacity = 0;
+
+    _symbols_job job;
+    job.fmt = fmt;
+    job.fmt_string = fmt_string;
+    job.prog = 0;
+    job.filter = 0;
+    job.sections = 0;
+
+    enji_pattern* sections_pattern = 0;
+
+    // Compile the format once for all entries ; columnar outputs take the
+    //   symbols as they are and have nothing to format
+    if (d->output != ENJD_OUTPUT_COLUMNAR && !(job.prog = enjp_dump_compile(d, fmt, fmt_string, _symbol_fmt_string, err)))
+    {
+        enjp_error(err, "Invalid format string");
+        enjd_formatter_delete(fmt);
+        return -1;
+    }
+
     // Use headers if the default format is used and the user is OK with it
-    int allow_headers = 1;
+    job.allow_headers = 1;
     if (enji_cmdline_find_option(d->cmd, "no-headers", ENJI_CMDLINE_TOOL | ENJI_CMDLINE_ORPHAN, arg, 0) ||
-        fmt_string != _symbol_fmt_string)
-        allow_headers = 0;
+        fmt_string != _symbol_fmt_string || d->output != ENJD_OUTPUT_TEXT)
+        job.allow_headers = 0;
 
-    // To manage spacers
-    int first_one = 1;
+    // Compile patterns once, symbol filters are plain globs
+    if (pattern && !(sections_pattern = enji_pattern_compile(pattern, ENJI_PATTERN_SECTIONS, err)))
+    {
+        enjp_error(err, "Invalid section pattern");
+        goto fail;
+    }
 
-    // Now process the sections
+    if (filter && !(job.filter = enji_pattern_compile(filter, 0, err)))
+    {
+        enjp_error(err, "Invalid symbol filter");
+        goto fail;
+    }
+
+    size_t section_count = 0;
+    for (enj_elf_shdr* section = d->elf->sections; section; section = section->next)
+        ++section_count;
+
+    job.sections = enj_malloc((section_count + 1) * sizeof(enj_elf_shdr*));
+    if (!job.sections)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        enjp_error(err, "Unable to gather sections");
+        goto fail;
+    }
+
+    // Pick the sections to process first
+    size_t job_count = 0;
     for (enj_elf_shdr* section = d->elf->sections; section; section = section->next)
     {
         // Process the eventual input pattern
@@ -101,17 +237,8 @@ int enjp_dump_symbols_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_err
                 continue;
 
             // Ignore sections that do not match the pattern
-            int match;
-            if ((match = enji_pattern_match(section, pattern, err)) <= 0)
-            {
-                if (match < 0)
-                {
-                    enjp_error(err, "Invalid section pattern");
-                    goto fail;
-                }
-
+            if (!enji_pattern_match_section(sections_pattern, section))
                 continue;
-            }
         }
 
         // Only process symbol sections
@@ -134,56 +261,68 @@ int enjp_dump_symbols_run(enjp_dump_tool* d, enji_cmdline_argument* arg, enj_err
             continue;
         }
 
-        if (!first_one && d->allow_spacers)
-        {
-            // Don't forget to flush as libelfninja_dump uses dup()
-            printf("\n");
-            fflush(stdout);
-        }
-
-        if (d->allow_flourish)
-        {
-            printf(".:: Symbols for section #%ld (%s) ::.\n\n", section->index, section->cached_name ? section->cached_name->string : "");
-            fflush(stdout);
-        }
-
-        if (allow_headers)
-        {
-            printf("%s", d->elf->bits == 64 ? _symbol_header64 : _symbol_header32);
-            fflush(stdout);
-        }
+        job.sections[job_count++] = section;
+    }
 
-        // Dump that shitz !
-        enj_symtab* symtab = (enj_symtab*) section->content;
-        for (enj_symbol* sym = symtab->symbols; sym; sym = sym->next)
+    if (d->output == ENJD_OUTPUT_COLUMNAR)
+    {
+        for (size_t i = 0; i < job_count; ++i)
         {
-            // Process the eventual symbol filter pattern
-            if (filter)
+            enj_symtab* symtab = (enj_symtab*) job.sections[i]->content;
+            for (enj_symbol* sym = symtab->symbols; sym; sym = sym->next)
             {
-                // Ignore unnamed symbols
-                if (!sym->cached_name)
+                if (job.filter && !enji_pattern_match_name(job.filter, sym->cached_name))
                     continue;
 
-                // Ignore symbols that do not match the pattern
-                if (fnmatch(filter, sym->cached_name->string, FNM_EXTMATCH) != 0)
-                    continue;
-            }
+                if (row_count == row_capacity)
+                {
+                    size_t capacity = row_capacity ? 2 * row_capacity : 1024;
+
+                    enj_symbol** grown = enj_realloc(rows, capacity * sizeof(enj_symbol*));
+                    if (!grown)
+                    {
+                        enj_error_put(err, ENJ_ERR_MALLOC);
+                        enjp_error(err, "Unable to gather symbols");
+                        goto fail;
+                    }
+
+                    rows = grown;
+                    row_capacity = capacity;
+                }
 
-            // Run the formatter
-            if (enjd_formatter_run(fmt, fmt_string, (void*) sym, 1, err) < 0)
-            {
-                enjp_error(err, "Unable to run formatter");
-                goto fail;
+                rows[row_count++] = sym;
             }
         }
 
-        first_one = 0;
+        if (_write_columnar(d, rows, row_count, err) < 0)
+            goto fail;
     }
-
+    else if (d->output == ENJD_OUTPUT_CSV)
+    {
+        // A single header row comes first, keep the sections in one piece
+        for (size_t i = 0; i < job_count; ++i)
+        {
+            if (_symbols_section(d, i, &job, err) < 0)
+                goto fail;
+        }
+    }
+    else if (enjp_dump_run_jobs(d, job_count, &_symbols_section, &job, err) < 0)
+        goto fail;
+
+    enj_free(rows);
+    enj_free(job.sections);
+    enji_pattern_delete(job.filter);
+    enji_pattern_delete(sections_pattern);
+    enjd_program_delete(job.prog);
     enjd_formatter_delete(fmt);
     return 0;
 
 fail:
+    enj_free(rows);
+    enj_free(job.sections);
+    enji_pattern_delete(job.filter);
+    enji_pattern_delete(sections_pattern);
+    enjd_program_delete(job.prog);
     enjd_formatter_delete(fmt);
     return -1;
 }
@@ -193,7 +332,8 @@ static enjp_dump_command _this_cmd =
     "symbols",
     "Dump symbol information",
     &enjp_dump_symbols_help,
-    &enjp_dump_symbols_run
+    &enjp_dump_symbols_run,
+    ENJP_DUMP_COLUMNAR
 };
 
 static __attribute__((constructor(202))) void _register()
@@ -32,6 +32,33 @@ int enjp_info_layout_help()
     return 0;
 }
 
+static const char* _segment_type(enj_elf_phdr* segment)
+{
+    switch (ENJ_ELF_PHDR_GET(segment, p_type))
+    {
+        case PT_NULL:         return "PT_NULL";
+        case PT_LOAD:         return "PT_LOAD";
+        case PT_DYNAMIC:      return "PT_DYNAMIC";
+        case PT_INTERP:       return "PT_INTERP";
+        case PT_NOTE:         return "PT_NOTE";
+        case PT_SHLIB:        return "PT_SHLIB";
+        case PT_PHDR:         return "PT_PHDR";
+        case PT_TLS:          return "PT_TLS";
+        case PT_GNU_EH_FRAME: return "PT_GNU_EH_FRAME";
+        case PT_GNU_STACK:    return "PT_GNU_STACK";
+        case PT_GNU_RELRO:    return "PT_GNU_RELRO";
+        case PT_GNU_PROPERTY: return "PT_GNU_PROPERTY";
+        default:              return "";
+    }
+}
+
+static void _print_segment(enj_trait_layout_chunk* chunk)
+{
+    printf("%-5s %08lX -> %08lX (%6ld bytes) #%-2ld (%s)\n", "SEG", chunk->offset,
+           chunk->offset + chunk->size - !!chunk->size, chunk->size,
+           chunk->segment->index, _segment_type(chunk->segment));
+}
+
 int enjp_info_layout_run(enjp_info_tool* s, enji_cmdline_argument* arg, enj_error** err)
 {
     if (!s || !s->cmd || !arg || !s->elf)
@@ -47,17 +74,24 @@ int enjp_info_layout_run(enjp_info_tool* s, enji_cmdline_argument* arg, enj_erro
         return -1;
     }
 
+    // Segments are displayed right before the first chunk they start in
+    size_t next_segment = 0;
+
     for (enj_trait_layout_chunk* chunk = lay->chunks; chunk; chunk = chunk->next)
     {
+        while (next_segment < lay->segment_count && lay->segments[next_segment]->offset < chunk->offset + chunk->size)
+            _print_segment(lay->segments[next_segment++]);
+
         const char* type;
 
         switch (chunk->type)
         {
-            case ENJ_TRAIT_LAYOUT_EHDR:    type = "EHDR";  break;
-            case ENJ_TRAIT_LAYOUT_PHDRS:   type = "PHDRS"; break;
-            case ENJ_TRAIT_LAYOUT_SHDRS:   type = "SHDRS"; break;
-            case ENJ_TRAIT_LAYOUT_SECTION: type = "DATA";  break;
-            case ENJ_TRAIT_LAYOUT_FREE:    type = "FREE";  break;
+            case ENJ_TRAIT_LAYOUT_EHDR:     type = "EHDR";  break;
+            case ENJ_TRAIT_LAYOUT_PHDRS:    type = "PHDRS"; break;
+            case ENJ_TRAIT_LAYOUT_SHDRS:    type = "SHDRS"; break;
+            case ENJ_TRAIT_LAYOUT_SECTION:  type = "DATA";  break;
+            case ENJ_TRAIT_LAYOUT_RESERVED: type = "RESV";  break;
+            case ENJ_TRAIT_LAYOUT_FREE:     type = "FREE";  break;
             default: type = "???"; break;
         }
 
@@ -69,6 +103,9 @@ int enjp_info_layout_run(enjp_info_tool* s, enji_cmdline_argument* arg, enj_erro
         printf("\n");
     }
 
+    while (next_segment < lay->segment_count)
+        _print_segment(lay->segments[next_segment++]);
+
     enj_trait_layout_delete(lay);
     return 0;
 }
@@ -0,0 +1,292 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+
+#include "layout.h"
+#include "tool.h"
+#include "log.h"
+
+#include "elfninja/core/core.h"
+#include "elfninja/input/input.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+
+static const char* _help_msg =
+"Usage : elfninja layout <file> reorder --profile=<hot symbols list>\n"
+"Reorder the code sections of a relocatable object built with -ffunction-sections\n"
+"so that the sections holding hot functions are contiguous.\n"
+"The profile lists one symbol per line, hottest first ; only the last word of\n"
+"each line is used (so that '<count> <symbol>' lines are accepted), empty lines and\n"
+"lines starting with '#' are ignored.\n"
+"The '.text.*' section headers are permuted among themselves (hot sections first,\n"
+"in profile order, then the remaining ones in their original order), each one\n"
+"followed by the headers of its relocation sections, and symbols, section links\n"
+"and groups are updated accordingly. Section contents are left in place.\n"
+"GNU ld places the input sections of an output section in the order it creates\n"
+"them while reading section headers, and reading a relocation section header\n"
+"creates its target section ; hence relocation headers move with their target.\n"
+;
+
+int enjp_layout_reorder_help()
+{
+    printf("%s", _help_msg);
+
+    return 0;
+}
+
+static int _is_code_section(enj_elf_shdr* section)
+{
+    if (!section->cached_name || !(ENJ_ELF_SHDR_GET(section, sh_flags) & SHF_EXECINSTR))
+        return 0;
+
+    return !strncmp(section->cached_name->string, ".text.", 6);
+}
+
+// Relocation sections applying to a code section move along with it
+static int _is_code_reloc_section(enj_elf_shdr* section, enj_elf_shdr** order, size_t count)
+{
+    size_t type = ENJ_ELF_SHDR_GET(section, sh_type);
+    size_t info = ENJ_ELF_SHDR_GET(section, sh_info);
+
+    return (type == SHT_REL || type == SHT_RELA) && info && info < count && _is_code_section(order[info]);
+}
+
+int enjp_layout_reorder_run(enjp_layout_tool* p, enji_cmdline_argument* arg, enj_error** err)
+{
+    if (!p || !p->cmd || !arg || !p->elf)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enj_elf* elf = p->elf;
+    FILE* profile = 0;
+    char* line = 0;
+    size_t line_size = 0;
+    enj_elf_shdr** order = 0;
+    enj_elf_shdr** hot = 0;
+    enj_elf_shdr** moved = 0;
+    size_t* slots = 0;
+
+    if (ENJ_ELF_EHDR_GET(elf, e_type) != ET_REL)
+    {
+        enjp_error(0, "Reordering is only supported on relocatable objects");
+        goto fail;
+    }
+
+    enji_cmdline_option* opt = enji_cmdline_find_option(p->cmd, "profile", ENJI_CMDLINE_TOOL, arg, 0);
+    if (!opt || !opt->value)
+    {
+        enjp_error(0, opt ? "Option 'profile' requires a value" : "Option 'profile' is required");
+        goto fail;
+    }
+
+    // Find the symbol table
+    enj_symtab* symtab = 0;
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        if (ENJ_ELF_SHDR_GET(section, sh_type) == SHT_SYMTAB && section->content)
+        {
+            symtab = (enj_symtab*) section->content;
+            break;
+        }
+    }
+
+    if (!symtab)
+    {
+        enjp_error(0, "No symbol table found");
+        goto fail;
+    }
+
+    // Get current order, and the header slots occupied by code sections
+    size_t count = 0;
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+        ++count;
+
+    order = enj_malloc(count * sizeof(enj_elf_shdr*));
+    hot = enj_malloc(count * sizeof(enj_elf_shdr*));
+    moved = enj_malloc(count * sizeof(enj_elf_shdr*));
+    slots = enj_malloc(count * sizeof(size_t));
+    if (!order || !hot || !moved || !slots)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        enjp_error(err, "Unable to allocate section order");
+        goto fail;
+    }
+
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        if (section->index >= count)
+        {
+            enj_error_put(err, ENJ_ERR_BAD_INDEX);
+            enjp_error(err, "Inconsistent section indices");
+            goto fail;
+        }
+
+        order[section->index] = section;
+    }
+
+    size_t slot_count = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (_is_code_section(order[i]) || _is_code_reloc_section(order[i], order, count))
+            slots[slot_count++] = i;
+    }
+
+    // Read the profile and collect hot sections
+    profile = fopen(opt->value, "r");
+    if (!profile)
+    {
+        enj_error_put_posix_errno(err, ENJ_ERR_IO, errno);
+        enjp_error(err, "Unable to open profile '%s'", opt->value);
+        goto fail;
+    }
+
+    size_t hot_count = 0;
+    size_t unknown_count = 0;
+
+    while (getline(&line, &line_size, profile) >= 0)
+    {
+        // Keep the last word of the line
+        char* end = line + strlen(line);
+        while (end > line && isspace((unsigned char) end[-1]))
+            --end;
+        *end = '\0';
+
+        char* name = end;
+        while (name > line && !isspace((unsigned char) name[-1]))
+            --name;
+
+        if (!*name || *line == '#')
+            continue;
+
+        enj_symbol* sym = enj_symtab_find_symbol(symtab, name, 0);
+        size_t shndx = sym ? ENJ_SYMBOL_GET(sym, st_shndx) : 0;
+
+        if (!shndx || shndx >= count || !_is_code_section(order[shndx]))
+        {
+            enjp_trace("Ignoring symbol '%s'", name);
+            ++unknown_count;
+            continue;
+        }
+
+        size_t i;
+        for (i = 0; i < hot_count && hot[i] != order[shndx]; ++i);
+
+        if (i == hot_count)
+            hot[hot_count++] = order[shndx];
+    }
+
+    if (!hot_count)
+    {
+        enjp_message("No hot code section found, nothing to reorder");
+        goto done;
+    }
+
+    if (unknown_count)
+        enjp_warning(0, "%ld profile entries do not match any code section symbol", unknown_count);
+
+    // Fill code slots with hot sections, then cold ones in their original order
+    enj_elf_shdr** cold = hot + hot_count;
+    size_t cold_count = 0;
+
+    for (size_t i = 0; i < slot_count; ++i)
+    {
+        if (!_is_code_section(order[slots[i]]))
+            continue;
+
+        size_t j;
+        for (j = 0; j < hot_count && hot[j] != order[slots[i]]; ++j);
+
+        if (j == hot_count)
+            cold[cold_count++] = order[slots[i]];
+    }
+
+    // Each code section is followed by its relocation sections, in their original order
+    size_t moved_count = 0;
+    for (size_t i = 0; i < hot_count + cold_count; ++i)
+    {
+        moved[moved_count++] = hot[i];
+
+        for (size_t j = 0; j < slot_count; ++j)
+        {
+            enj_elf_shdr* reloc = order[slots[j]];
+
+            if (_is_code_reloc_section(reloc, order, count) && ENJ_ELF_SHDR_GET(reloc, sh_info) == hot[i]->index)
+                moved[moved_count++] = reloc;
+        }
+    }
+
+    for (size_t i = 0; i < slot_count; ++i)
+        order[slots[i]] = moved[i];
+
+    if (enj_elf_shdr_reorder(elf, order, count, err) < 0)
+    {
+        enjp_error(err, "Unable to reorder section headers");
+        goto fail;
+    }
+
+    if (enj_elf_push(elf, err) < 0)
+    {
+        enjp_error(err, "Unable to push changes to ELF");
+        goto fail;
+    }
+
+    enjp_message("Placed %ld hot code sections ahead of %ld cold ones", hot_count, cold_count);
+
+done:
+    free(line);
+    fclose(profile);
+    enj_free(order);
+    enj_free(hot);
+    enj_free(moved);
+    enj_free(slots);
+    return 0;
+
+fail:
+    free(line);
+    if (profile)
+        fclose(profile);
+    enj_free(order);
+    enj_free(hot);
+    enj_free(moved);
+    enj_free(slots);
+    return -1;
+}
+
+static enjp_layout_command _this_cmd =
+{
+    "reorder",
+    "Reorder code sections from a profile",
+    &enjp_layout_reorder_help,
+    &enjp_layout_reorder_run
+};
+
+static __attribute__((constructor(200))) void _register()
+{
+    enj_error* err = 0;
+
+    if (enjp_layout_register_command(&_this_cmd, &err) < 0)
+        enjp_fatal(&err, "Unable to register layout command 'reorder'");
+}
@@ -52,10 +52,11 @@ int main(int argc, char** argv)
     }
 
     // Run tool
+    int status = 0;
     if (t->run)
-        (*t->run)(cmd);
+        status = (*t->run)(cmd);
 
     // Cleanup and exit
     enji_cmdline_delete(cmd);
-    return 0;
+    return status < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
 }
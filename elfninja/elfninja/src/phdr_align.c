@@ -0,0 +1,218 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "phdr.h"
+#include "tool.h"
+#include "log.h"
+
+#include "elfninja/core/core.h"
+#include "elfninja/input/input.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+
+static const char* _help_msg =
+"Usage : elfninja phdr <file> align --align=<size>\n"
+"    or elfninja phdr <file> align=<size>\n"
+"Realign all PT_LOAD segments in the file so that p_offset = p_vaddr (mod size),\n"
+"and set their p_align to size (for example 2M for huge pages).\n"
+"Segments are not moved in memory : zero padding is inserted in the file before\n"
+"each misaligned segment, and everything following it is shifted.\n"
+"The size accepts K, M and G suffixes and must be a power of two.\n"
+;
+
+int enjp_phdr_align_help()
+{
+    printf("%s", _help_msg);
+
+    return 0;
+}
+
+static int _compare_segments(const void* a, const void* b)
+{
+    size_t lhs = (*(enj_elf_phdr* const*) a)->data->start->pos;
+    size_t rhs = (*(enj_elf_phdr* const*) b)->data->start->pos;
+
+    return lhs < rhs ? -1 : lhs > rhs;
+}
+
+int enjp_phdr_align_run(enjp_phdr_tool* p, enji_cmdline_argument* arg, enj_error** err)
+{
+    if (!p || !p->cmd || !arg || !p->elf)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enj_elf* elf = p->elf;
+    enj_elf_phdr** loads = 0;
+    enj_trait_layout* lay = 0;
+
+    const char* value = arg->value;
+    if (!value)
+    {
+        enji_cmdline_option* opt = enji_cmdline_find_option(p->cmd, "align", ENJI_CMDLINE_TOOL, arg, 0);
+        if (!opt || !opt->value)
+        {
+            enjp_error(0, opt ? "Option 'align' requires a value" : "Option 'align' is required");
+            goto fail;
+        }
+
+        value = opt->value;
+    }
+
+    size_t align = enji_parse_size(value, err);
+    if (*err || !align || (align & (align - 1)))
+    {
+        enjp_error(err, "Invalid alignment '%s'", value);
+        goto fail;
+    }
+
+    // Collect PT_LOAD segments in file order
+    size_t count = 0;
+    for (enj_elf_phdr* segment = elf->segments; segment; segment = segment->next)
+        ++count;
+
+    loads = enj_malloc((count + 1) * sizeof(enj_elf_phdr*));
+    if (!loads)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        enjp_error(err, "Unable to allocate segment list");
+        goto fail;
+    }
+
+    size_t load_count = 0;
+    for (enj_elf_phdr* segment = elf->segments; segment; segment = segment->next)
+    {
+        if (ENJ_ELF_PHDR_GET(segment, p_type) == PT_LOAD && segment->data)
+            loads[load_count++] = segment;
+    }
+
+    if (!load_count)
+    {
+        enjp_error(0, "No PT_LOAD segment to align");
+        goto fail;
+    }
+
+    qsort(loads, load_count, sizeof(enj_elf_phdr*), &_compare_segments);
+
+    // Padding goes right before segments, check that none starts in the middle of a section
+    if (!(lay = enj_trait_layout_create(elf, err)))
+    {
+        enjp_error(err, "Unable to create layout trait");
+        goto fail;
+    }
+
+    for (size_t i = 0; i < load_count; ++i)
+    {
+        size_t offset = loads[i]->data->start->pos;
+        enj_trait_layout_chunk* chunk = enj_trait_layout_find(lay, offset);
+
+        if (chunk && chunk->type != ENJ_TRAIT_LAYOUT_FREE && chunk->offset < offset)
+        {
+            enjp_error(0, "Segment #%ld starts inside %s, unable to pad it",
+                       loads[i]->index, chunk->section && chunk->section->cached_name ?
+                       chunk->section->cached_name->string : "file headers");
+            goto fail;
+        }
+    }
+
+    // Shift misaligned segments forward
+    size_t old_size = elf->blob->buffer_size;
+
+    for (size_t i = 0; i < load_count; ++i)
+    {
+        size_t offset = loads[i]->data->start->pos;
+        size_t vaddr = ENJ_ELF_PHDR_GET(loads[i], p_vaddr);
+        size_t pad = (vaddr - offset) & (align - 1);
+
+        if (pad)
+        {
+            if (!offset)
+            {
+                enjp_error(0, "Segment #%ld holds the ELF header and cannot be shifted", loads[i]->index);
+                goto fail;
+            }
+
+            if (enj_blob_pad(elf->blob, offset, pad, err) < 0)
+            {
+                enjp_error(err, "Unable to pad segment #%ld", loads[i]->index);
+                goto fail;
+            }
+        }
+
+        ENJ_ELF_PHDR_SET(loads[i], p_align, align);
+    }
+
+    // SHT_NOBITS sections have no data to follow, keep their offset consistent with their segment
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        if (ENJ_ELF_SHDR_GET(section, sh_type) != SHT_NOBITS)
+            continue;
+
+        // .tbss is only mapped by PT_TLS
+        enj_elf_phdr* segment = enj_trait_layout_load_segment(lay, section);
+        for (enj_elf_phdr* tls = elf->segments; !segment && tls; tls = tls->next)
+        {
+            if (ENJ_ELF_PHDR_GET(tls, p_type) == PT_TLS && enj_trait_layout_in_segment(lay, tls, section))
+                segment = tls;
+        }
+
+        if (!segment || !segment->data)
+            continue;
+
+        size_t addr = ENJ_ELF_SHDR_GET(section, sh_addr);
+        ENJ_ELF_SHDR_SET(section, sh_offset, segment->data->start->pos + (addr - ENJ_ELF_PHDR_GET(segment, p_vaddr)));
+    }
+
+    if (enj_elf_push(elf, err) < 0)
+    {
+        enjp_error(err, "Unable to push changes to ELF");
+        goto fail;
+    }
+
+    enjp_message("Aligned %ld segments to 0x%lX, file grew by %ld bytes", load_count, align,
+                 elf->blob->buffer_size - old_size);
+
+    enj_trait_layout_delete(lay);
+    enj_free(loads);
+    return 0;
+
+fail:
+    enj_trait_layout_delete(lay);
+    enj_free(loads);
+    return -1;
+}
+
+static enjp_phdr_command _this_cmd =
+{
+    "align",
+    "Realign loadable segments",
+    &enjp_phdr_align_help,
+    &enjp_phdr_align_run
+};
+
+static __attribute__((constructor(204))) void _register()
+{
+    enj_error* err = 0;
+
+    if (enjp_phdr_register_command(&_this_cmd, &err) < 0)
+        enjp_fatal(&err, "Unable to register segment command 'align'");
+}
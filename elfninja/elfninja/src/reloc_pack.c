@@ -0,0 +1,842 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "reloc.h"
+#include "tool.h"
+#include "log.h"
+
+#include "elfninja/core/core.h"
+#include "elfninja/input/input.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+
+static const char* _help_msg =
+"Usage : elfninja reloc <file> pack\n"
+"Convert the relative relocations of the dynamic relocation table to a\n"
+"packed SHT_RELR table. The packed table is written in the space freed from\n"
+"the relocation table, so that no other section has to be moved ; .dynamic\n"
+"needs three spare entries (trailing DT_NULL entries, or the DT_RELA / DT_REL\n"
+"entries when no other relocation is left).\n"
+"The dynamic loader must support DT_RELR (glibc 2.36 or later), and glibc also\n"
+"requires a GLIBC_ABI_DT_RELR version requirement, added to libc after the\n"
+"packed table. Its name is either found in .dynstr, appended in the unused\n"
+"bytes right after it, or .dynstr is moved to the freed space with the name\n"
+"appended. The file is left unchanged when none of these fit.\n"
+;
+
+int enjp_reloc_pack_help()
+{
+    printf("%s", _help_msg);
+
+    return 0;
+}
+
+static size_t _relative_type(enj_elf* elf)
+{
+    switch (ENJ_ELF_EHDR_GET(elf, e_machine))
+    {
+        case EM_X86_64:  return R_X86_64_RELATIVE;
+        case EM_386:     return R_386_RELATIVE;
+        case EM_AARCH64: return R_AARCH64_RELATIVE;
+        case EM_ARM:     return R_ARM_RELATIVE;
+        case EM_RISCV:   return R_RISCV_RELATIVE;
+    }
+
+    return 0;
+}
+
+static int _vaddr_to_offset(enj_elf* elf, size_t vaddr, size_t size, size_t* offset)
+{
+    for (enj_elf_phdr* segment = elf->segments; segment; segment = segment->next)
+    {
+        if (ENJ_ELF_PHDR_GET(segment, p_type) != PT_LOAD)
+            continue;
+
+        size_t p_vaddr = ENJ_ELF_PHDR_GET(segment, p_vaddr);
+        size_t p_filesz = ENJ_ELF_PHDR_GET(segment, p_filesz);
+
+        if (vaddr >= p_vaddr && vaddr + size <= p_vaddr + p_filesz)
+        {
+            *offset = ENJ_ELF_PHDR_GET(segment, p_offset) + (vaddr - p_vaddr);
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+// Relative relocations can be packed if they are word aligned and target file-backed
+//  memory, as packed relocations keep their addend in place
+static int _packable(enj_elf* elf, enj_reloc* reloc, size_t i, size_t relative_type, size_t* target)
+{
+    size_t word = elf->bits / 8;
+
+    return ENJ_RELOC_TYPE(reloc, i) == relative_type && !ENJ_RELOC_SYM(reloc, i) &&
+           !(reloc->offsets[i] % word) &&
+           !_vaddr_to_offset(elf, reloc->offsets[i], word, target);
+}
+
+static int _compare_offsets(const void* a, const void* b)
+{
+    size_t lhs = *(const size_t*) a;
+    size_t rhs = *(const size_t*) b;
+
+    return lhs < rhs ? -1 : lhs > rhs;
+}
+
+// Encode sorted, word aligned addresses : an address entry is followed by bitmap
+//  entries (odd words) flagging which of the next (word bits - 1) words are relocated
+static size_t _encode_relr(size_t* offsets, size_t count, size_t word, unsigned char* out)
+{
+    size_t nbits = word * 8 - 1;
+    size_t words = 0;
+
+    for (size_t i = 0; i < count; )
+    {
+        size_t base = offsets[i] + word;
+        memcpy(out + words++ * word, &offsets[i], word);
+        ++i;
+
+        for (;;)
+        {
+            size_t bitmap = 0;
+
+            for (; i < count; ++i)
+            {
+                size_t delta = offsets[i] - base;
+                if (delta >= nbits * word || delta % word)
+                    break;
+
+                bitmap |= (size_t) 1 << (delta / word);
+            }
+
+            if (!bitmap)
+                break;
+
+            bitmap = (bitmap << 1) | 1;
+            memcpy(out + words++ * word, &bitmap, word);
+            base += nbits * word;
+        }
+    }
+
+    return words;
+}
+
+static const char* _abi_version = "GLIBC_ABI_DT_RELR";
+
+// How the GLIBC_ABI_DT_RELR version requirement is added, decided before anything is written :
+//  the version requirements are rebuilt in the freed space, and the name is either found in
+//  .dynstr, appended to it in unused padding, or .dynstr is moved after the requirements
+typedef struct _abi_plan
+{
+    enj_dynamic_entry* verneed;
+    enj_dynamic_entry* strtab;
+    enj_dynamic_entry* strsz;
+
+    enj_elf_shdr* section;
+    enj_elf_shdr* strings;
+    size_t strtab_offset;
+
+    size_t name;
+    int found;
+    int append;
+
+    size_t verneed_size;
+    size_t size;
+} _abi_plan;
+
+// Find the libc requirement (offset in the version requirements) and the highest version index
+static int _find_libc(enj_elf* elf, const unsigned char* data, size_t size, size_t strtab_offset,
+                      size_t* libc, size_t* max_other)
+{
+    *libc = (size_t) -1;
+    *max_other = 1;
+
+    for (size_t vn = 0; vn + sizeof(Elf64_Verneed) <= size; )
+    {
+        Elf64_Verneed need;
+        memcpy(&need, data + vn, sizeof(Elf64_Verneed));
+
+        char file[8] = { 0 };
+        enj_blob_read(elf->blob, strtab_offset + need.vn_file, file, sizeof(file) - 1, 0);
+        if (!strncmp(file, "libc.so", 7))
+            *libc = vn;
+
+        for (size_t i = 0, vna = vn + need.vn_aux; i < need.vn_cnt && vna + sizeof(Elf64_Vernaux) <= size; ++i)
+        {
+            Elf64_Vernaux aux;
+            memcpy(&aux, data + vna, sizeof(Elf64_Vernaux));
+
+            if ((aux.vna_other & 0x7FFF) > *max_other)
+                *max_other = aux.vna_other & 0x7FFF;
+            vna += aux.vna_next;
+        }
+
+        if (!need.vn_next)
+            break;
+        vn += need.vn_next;
+    }
+
+    return *libc == (size_t) -1 ? 1 : 0;
+}
+
+static unsigned char* _read_section(enj_elf* elf, enj_elf_shdr* section, enj_error** err)
+{
+    unsigned char* data = enj_malloc(section->data->length + 1);
+    if (!data)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return 0;
+    }
+
+    if (enj_blob_read(elf->blob, section->data->start->pos, data, section->data->length, err) < 0)
+    {
+        enj_free(data);
+        return 0;
+    }
+
+    return data;
+}
+
+// Check that the version requirement can be added within room bytes of freed space ;
+//  returns 1 if it can not
+static int _plan_abi_dependency(enj_elf* elf, enj_dynamic* dynamic, size_t room, _abi_plan* plan, enj_error** err)
+{
+    memset(plan, 0, sizeof(_abi_plan));
+
+    for (enj_dynamic_entry* dyn = dynamic->entries; dyn; dyn = dyn->next)
+    {
+        if (dyn->tag == DT_VERNEED)
+            plan->verneed = dyn;
+        else if (dyn->tag == DT_STRTAB)
+            plan->strtab = dyn;
+        else if (dyn->tag == DT_STRSZ)
+            plan->strsz = dyn;
+    }
+
+    if (!plan->verneed || !plan->strtab || !plan->strsz)
+        return 1;
+
+    for (enj_elf_shdr* other = elf->sections; other; other = other->next)
+    {
+        size_t type = ENJ_ELF_SHDR_GET(other, sh_type);
+        size_t addr = ENJ_ELF_SHDR_GET(other, sh_addr);
+
+        if (type == SHT_GNU_verneed && other->data && addr == plan->verneed->value)
+            plan->section = other;
+        else if (type == SHT_STRTAB && other->data && addr == plan->strtab->value &&
+                 ENJ_ELF_SHDR_GET(other, sh_size) == plan->strsz->value)
+            plan->strings = other;
+    }
+
+    size_t strsz = plan->strsz->value;
+    if (!plan->section || _vaddr_to_offset(elf, plan->strtab->value, strsz, &plan->strtab_offset) < 0)
+        return 1;
+
+    unsigned char* data = _read_section(elf, plan->section, err);
+    if (!data)
+        return -1;
+
+    size_t libc, max_other;
+    int status = _find_libc(elf, data, plan->section->data->length, plan->strtab_offset, &libc, &max_other);
+    enj_free(data);
+
+    if (status)
+        return 1;
+
+    plan->verneed_size = plan->section->data->length + sizeof(Elf64_Vernaux);
+    plan->size = plan->verneed_size;
+
+    // Look for the name, possibly as the tail of a longer string
+    size_t name_size = strlen(_abi_version) + 1;
+
+    unsigned char* strings = enj_malloc(strsz + 1);
+    if (!strings)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    if (enj_blob_read(elf->blob, plan->strtab_offset, strings, strsz, err) < 0)
+    {
+        enj_free(strings);
+        return -1;
+    }
+
+    for (size_t i = 0; i + name_size <= strsz && !plan->found; ++i)
+    {
+        if (!memcmp(strings + i, _abi_version, name_size))
+        {
+            plan->found = 1;
+            plan->name = i;
+        }
+    }
+
+    enj_free(strings);
+
+    if (plan->found)
+        return plan->size > room;
+
+    // Otherwise .dynstr must have a section header, to grow or move it
+    if (!plan->strings)
+        return 1;
+
+    // It may grow in place if the bytes right after it are unused padding of the same segment
+    size_t grown_offset;
+    size_t start = plan->strtab_offset + strsz;
+
+    plan->append = _vaddr_to_offset(elf, plan->strtab->value, strsz + name_size, &grown_offset) == 0 &&
+                   grown_offset == plan->strtab_offset;
+
+    for (enj_elf_shdr* other = elf->sections; other && plan->append; other = other->next)
+    {
+        if (other == plan->strings || ENJ_ELF_SHDR_GET(other, sh_type) == SHT_NOBITS)
+            continue;
+
+        size_t offset = ENJ_ELF_SHDR_GET(other, sh_offset);
+        size_t size = ENJ_ELF_SHDR_GET(other, sh_size);
+
+        if (size && offset < start + name_size && start < offset + size)
+            plan->append = 0;
+    }
+
+    if (plan->append)
+    {
+        char padding[name_size];
+        if (enj_blob_read(elf->blob, start, padding, name_size, err) < 0)
+            return -1;
+
+        for (size_t i = 0; i < name_size; ++i)
+        {
+            if (padding[i])
+                plan->append = 0;
+        }
+    }
+
+    // Or it is moved to the freed space, right after the version requirements
+    if (!plan->append)
+        plan->size += strsz + name_size;
+
+    return plan->size > room;
+}
+
+// Name anchors of the symbols and dynamic entries using .dynstr follow it when it is moved
+static void _move_string_anchors(enj_elf* elf, enj_elf_shdr* strings, size_t from, size_t to, size_t size)
+{
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        if (!section->content_view || !section->content)
+            continue;
+
+        if (section->content_view->tag == ENJ_ELF_SYMTAB && ((enj_symtab*) section->content)->strtab == strings)
+        {
+            for (enj_symbol* sym = ((enj_symtab*) section->content)->symbols; sym; sym = sym->next)
+            {
+                if (sym->name && sym->name->pos >= from && sym->name->pos < from + size)
+                    sym->name->pos = sym->name->pos - from + to;
+            }
+        }
+        else if (section->content_view->tag == ENJ_ELF_DYNAMIC && ((enj_dynamic*) section->content)->strtab == strings)
+        {
+            for (enj_dynamic_entry* dyn = ((enj_dynamic*) section->content)->entries; dyn; dyn = dyn->next)
+            {
+                if (dyn->string && dyn->string->pos >= from && dyn->string->pos < from + size)
+                    dyn->string->pos = dyn->string->pos - from + to;
+            }
+        }
+    }
+}
+
+// Store the version name as planned, and give its offset in .dynstr
+static int _add_abi_name(enj_elf* elf, _abi_plan* plan, size_t pos, size_t addr, size_t* name, enj_error** err)
+{
+    if (plan->found)
+    {
+        *name = plan->name;
+        return 0;
+    }
+
+    size_t strsz = plan->strsz->value;
+    size_t name_size = strlen(_abi_version) + 1;
+    size_t start = plan->strtab_offset;
+
+    if (!plan->append)
+    {
+        // Copy the whole table, string offsets are unchanged
+        unsigned char* strings = _read_section(elf, plan->strings, err);
+        if (!strings)
+            return -1;
+
+        int ret = enj_blob_write(elf->blob, pos, strings, strsz, err);
+        enj_free(strings);
+        if (ret < 0)
+            return -1;
+
+        _move_string_anchors(elf, plan->strings, plan->strings->data->start->pos, pos, strsz);
+
+        ENJ_ELF_SHDR_SET(plan->strings, sh_addr, addr);
+        ENJ_ELF_SHDR_SET(plan->strings, sh_offset, pos);
+
+        plan->strtab->value = addr;
+        start = pos;
+    }
+
+    if (enj_blob_write(elf->blob, start + strsz, _abi_version, name_size, err) < 0)
+        return -1;
+
+    ENJ_ELF_SHDR_SET(plan->strings, sh_size, strsz + name_size);
+
+    if (enj_elf_shdr_write(plan->strings, err) < 0 ||
+        enj_elf_shdr_pull(plan->strings, err) < 0)
+        return -1;
+
+    *name = strsz;
+    plan->strsz->value += name_size;
+
+    return 0;
+}
+
+// glibc refuses DT_RELR without a GLIBC_ABI_DT_RELR version requirement on libc ; rebuild the
+//  version requirements with it at pos (within the freed space), as planned
+static int _add_abi_dependency(enj_elf* elf, _abi_plan* plan, size_t pos, size_t addr, enj_error** err)
+{
+    enj_elf_shdr* section = plan->section;
+    size_t old_size = section->data->length;
+    size_t new_size = plan->verneed_size;
+
+    unsigned char* old = _read_section(elf, section, err);
+    if (!old)
+        return -1;
+
+    unsigned char* new = enj_malloc(new_size);
+    if (!new)
+    {
+        enj_free(old);
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return -1;
+    }
+
+    size_t libc, max_other, name;
+    _find_libc(elf, old, old_size, plan->strtab_offset, &libc, &max_other);
+
+    if (_add_abi_name(elf, plan, pos + new_size, addr + new_size, &name, err) < 0)
+    {
+        enj_free(old);
+        enj_free(new);
+        return -1;
+    }
+
+    // Rebuild the entries contiguously, appending the new requirement to libc
+    size_t out = 0;
+    for (size_t vn = 0; vn + sizeof(Elf64_Verneed) <= old_size; )
+    {
+        Elf64_Verneed need;
+        memcpy(&need, old + vn, sizeof(Elf64_Verneed));
+
+        size_t next = need.vn_next;
+        size_t vna = vn + need.vn_aux;
+        size_t cnt = need.vn_cnt;
+
+        need.vn_cnt = cnt + (vn == libc);
+        need.vn_aux = sizeof(Elf64_Verneed);
+        need.vn_next = next ? sizeof(Elf64_Verneed) + need.vn_cnt * sizeof(Elf64_Vernaux) : 0;
+        memcpy(new + out, &need, sizeof(Elf64_Verneed));
+        out += sizeof(Elf64_Verneed);
+
+        for (size_t i = 0; i < cnt; ++i)
+        {
+            Elf64_Vernaux aux;
+            memcpy(&aux, old + vna, sizeof(Elf64_Vernaux));
+            vna += aux.vna_next;
+
+            aux.vna_next = (i + 1 < need.vn_cnt) ? sizeof(Elf64_Vernaux) : 0;
+            memcpy(new + out, &aux, sizeof(Elf64_Vernaux));
+            out += sizeof(Elf64_Vernaux);
+        }
+
+        if (vn == libc)
+        {
+            Elf64_Vernaux aux;
+            aux.vna_hash = enj_hash_sysv(_abi_version);
+            aux.vna_flags = 0;
+            aux.vna_other = max_other + 1;
+            aux.vna_name = name;
+            aux.vna_next = 0;
+            memcpy(new + out, &aux, sizeof(Elf64_Vernaux));
+            out += sizeof(Elf64_Vernaux);
+        }
+
+        if (!next)
+            break;
+        vn += next;
+    }
+
+    enj_free(old);
+
+    if (enj_blob_write(elf->blob, pos, new, out, err) < 0)
+    {
+        enj_free(new);
+        return -1;
+    }
+
+    enj_free(new);
+
+    // Move the version requirement section over there
+    ENJ_ELF_SHDR_SET(section, sh_addr, addr);
+    ENJ_ELF_SHDR_SET(section, sh_offset, pos);
+    ENJ_ELF_SHDR_SET(section, sh_size, new_size);
+
+    if (enj_elf_shdr_write(section, err) < 0 ||
+        enj_elf_shdr_pull(section, err) < 0)
+        return -1;
+
+    plan->verneed->value = addr;
+
+    return 0;
+}
+
+int enjp_reloc_pack_run(enjp_reloc_tool* p, enji_cmdline_argument* arg, enj_error** err)
+{
+    if (!p || !p->cmd || !arg || !p->elf)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enj_elf* elf = p->elf;
+    size_t word = elf->bits / 8;
+    size_t* packed = 0;
+    unsigned char* relr_data = 0;
+
+    size_t relative_type = _relative_type(elf);
+    if (!relative_type)
+    {
+        enjp_error(0, "Unsupported machine type %ld", (size_t) ENJ_ELF_EHDR_GET(elf, e_machine));
+        goto fail;
+    }
+
+    // Find the dynamic section
+    enj_dynamic* dynamic = 0;
+    for (enj_elf_shdr* section = elf->sections; section; section = section->next)
+    {
+        if (section->content_view && section->content_view->tag == ENJ_ELF_DYNAMIC && section->content)
+        {
+            dynamic = (enj_dynamic*) section->content;
+            break;
+        }
+    }
+
+    if (!dynamic)
+    {
+        enjp_error(0, "No dynamic section found");
+        goto fail;
+    }
+
+    // Get the dynamic relocation table entries
+    enj_dynamic_entry* table = 0;
+    enj_dynamic_entry* table_size = 0;
+    enj_dynamic_entry* table_ent = 0;
+    enj_dynamic_entry* table_count = 0;
+
+    for (enj_dynamic_entry* dyn = dynamic->entries; dyn; dyn = dyn->next)
+    {
+        switch (dyn->tag)
+        {
+            case DT_RELA:
+            case DT_REL:
+                table = dyn;
+                break;
+
+            case DT_RELASZ:
+            case DT_RELSZ:
+                table_size = dyn;
+                break;
+
+            case DT_RELAENT:
+            case DT_RELENT:
+                table_ent = dyn;
+                break;
+
+            case DT_RELACOUNT:
+            case DT_RELCOUNT:
+                table_count = dyn;
+                break;
+
+            case DT_RELR:
+                enjp_error(0, "File already has packed relative relocations");
+                goto fail;
+        }
+    }
+
+    if (!table)
+    {
+        enjp_message("No dynamic relocation table, nothing to pack");
+        return 0;
+    }
+
+    // Find the matching relocation section
+    enj_elf_shdr* section = 0;
+    for (enj_elf_shdr* other = elf->sections; other; other = other->next)
+    {
+        if (other->content_view && other->content_view->tag == ENJ_ELF_RELOC && other->content &&
+            other->data && (ENJ_ELF_SHDR_GET(other, sh_flags) & SHF_ALLOC) &&
+            ENJ_ELF_SHDR_GET(other, sh_addr) == table->value)
+        {
+            section = other;
+            break;
+        }
+    }
+
+    if (!section)
+    {
+        enjp_error(0, "No section matches the dynamic relocation table at 0x%08lX", table->value);
+        goto fail;
+    }
+
+    enj_reloc* reloc = (enj_reloc*) section->content;
+
+    // Split relative relocations from the other ones
+    packed = enj_malloc((reloc->count + 1) * sizeof(size_t));
+    if (!packed)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        enjp_error(err, "Unable to allocate relocation list");
+        goto fail;
+    }
+
+    size_t packed_count = 0;
+    size_t kept_count = 0;
+
+    for (size_t i = 0; i < reloc->count; ++i)
+    {
+        size_t target;
+
+        if (_packable(elf, reloc, i, relative_type, &target))
+            packed[packed_count++] = reloc->offsets[i];
+        else
+            ++kept_count;
+    }
+
+    if (!packed_count)
+    {
+        enjp_message("No relative relocation to pack");
+        enj_free(packed);
+        return 0;
+    }
+
+    qsort(packed, packed_count, sizeof(size_t), &_compare_offsets);
+
+    relr_data = enj_malloc(packed_count * word);
+    if (!relr_data)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        enjp_error(err, "Unable to allocate packed relocations");
+        goto fail;
+    }
+
+    size_t relr_words = _encode_relr(packed, packed_count, word, relr_data);
+
+    // Pick three dynamic entries to hold DT_RELR, DT_RELRSZ and DT_RELRENT : the old table entries
+    //  if no relocation is left, then spare DT_NULL entries (keeping the last one as terminator)
+    enj_dynamic_entry* slots[3];
+    size_t slot_count = 0;
+
+    if (!kept_count)
+    {
+        enj_dynamic_entry* old[4] = { table, table_size, table_ent, table_count };
+        for (size_t i = 0; i < 4 && slot_count < 3; ++i)
+        {
+            if (old[i])
+                slots[slot_count++] = old[i];
+        }
+    }
+
+    for (enj_dynamic_entry* dyn = dynamic->entries; dyn && slot_count < 3; dyn = dyn->next)
+    {
+        if (dyn->tag != DT_NULL || !dyn->next)
+            continue;
+
+        slots[slot_count++] = dyn;
+    }
+
+    if (slot_count < 3)
+    {
+        enjp_error(0, "Not enough spare entries in the dynamic section");
+        goto fail;
+    }
+
+    // Lay the packed relocations out in the freed space of the relocation section,
+    //  followed by the loader version requirement ; nothing is written before both fit
+    size_t entsize = section->data->length / (reloc->count ? reloc->count : 1);
+    size_t old_size = section->data->length;
+    size_t new_size = kept_count * entsize;
+    size_t relr_pos = (new_size + word - 1) / word * word;
+    size_t relr_size = relr_words * word;
+
+    if (relr_pos + relr_size > old_size)
+    {
+        enj_error_put(err, ENJ_ERR_TOO_BIG);
+        enjp_error(err, "Packed relocations do not fit in the relocation section");
+        goto fail;
+    }
+
+    _abi_plan plan;
+    size_t verneed_pos = (relr_pos + relr_size + word - 1) / word * word;
+    int status = verneed_pos > old_size ? 1 : _plan_abi_dependency(elf, dynamic, old_size - verneed_pos, &plan, err);
+    if (status < 0)
+    {
+        enjp_error(err, "Unable to add %s version requirement", _abi_version);
+        goto fail;
+    }
+    else if (status > 0)
+    {
+        enj_error_put(err, ENJ_ERR_TOO_BIG);
+        enjp_error(err, "Unable to add a %s version requirement to libc in the freed space, "
+                        "the loader would reject packed relocations", _abi_version);
+        goto fail;
+    }
+
+    // Keep the addends of packed relocations in place, and the other relocations
+    for (size_t i = 0, kept = 0; i < reloc->count; ++i)
+    {
+        size_t target;
+
+        if (_packable(elf, reloc, i, relative_type, &target))
+        {
+            if (reloc->rela && enj_blob_write(elf->blob, target, &reloc->addends[i], word, err) < 0)
+            {
+                enjp_error(err, "Unable to write relocation addend");
+                goto fail;
+            }
+
+            continue;
+        }
+
+        reloc->offsets[kept] = reloc->offsets[i];
+        reloc->infos[kept] = reloc->infos[i];
+        reloc->addends[kept] = reloc->addends[i];
+        ++kept;
+    }
+
+    // Create the packed relocation section
+    enj_elf_shdr* relr = enj_elf_new_shdr(elf, SHT_RELR, ".relr.dyn", err);
+    if (!relr)
+    {
+        enjp_error(err, "Unable to create section '.relr.dyn'");
+        goto fail;
+    }
+
+    size_t base_offset = section->data->start->pos;
+    size_t base_addr = ENJ_ELF_SHDR_GET(section, sh_addr);
+
+    ENJ_ELF_SHDR_SET(relr, sh_flags, SHF_ALLOC);
+    ENJ_ELF_SHDR_SET(relr, sh_addr, base_addr + relr_pos);
+    ENJ_ELF_SHDR_SET(relr, sh_offset, base_offset + relr_pos);
+    ENJ_ELF_SHDR_SET(relr, sh_size, relr_size);
+    ENJ_ELF_SHDR_SET(relr, sh_entsize, word);
+    ENJ_ELF_SHDR_SET(relr, sh_addralign, word);
+
+    if (enj_blob_set(elf->blob, base_offset + new_size, 0, old_size - new_size, err) < 0 ||
+        enj_blob_write(elf->blob, base_offset + relr_pos, relr_data, relr_size, err) < 0 ||
+        enj_elf_shdr_write(relr, err) < 0 ||
+        enj_elf_shdr_pull(relr, err) < 0)
+    {
+        enjp_error(err, "Unable to write packed relocations");
+        goto fail;
+    }
+
+    // Shrink the relocation section without moving anything around
+    reloc->count = kept_count;
+
+    ENJ_ELF_SHDR_SET(section, sh_offset, base_offset);
+    ENJ_ELF_SHDR_SET(section, sh_size, new_size);
+
+    if (enj_elf_shdr_write(section, err) < 0 ||
+        enj_elf_shdr_pull(section, err) < 0)
+    {
+        enjp_error(err, "Unable to shrink relocation section");
+        goto fail;
+    }
+
+    // Add the loader version requirement after the packed relocations
+    if (_add_abi_dependency(elf, &plan, base_offset + verneed_pos, base_addr + verneed_pos, err) < 0)
+    {
+        enjp_error(err, "Unable to add %s version requirement", _abi_version);
+        goto fail;
+    }
+
+    // Update dynamic entries
+    if (kept_count)
+    {
+        if (table_size)
+            table_size->value = new_size;
+
+        if (table_count)
+        {
+            size_t leading = 0;
+            while (leading < kept_count && ENJ_RELOC_TYPE(reloc, leading) == relative_type)
+                ++leading;
+
+            table_count->value = leading;
+        }
+    }
+
+    slots[0]->tag = DT_RELR;
+    slots[0]->value = base_addr + relr_pos;
+    slots[1]->tag = DT_RELRSZ;
+    slots[1]->value = relr_size;
+    slots[2]->tag = DT_RELRENT;
+    slots[2]->value = word;
+
+    if (enj_elf_push(elf, err) < 0)
+    {
+        enjp_error(err, "Unable to push changes to ELF");
+        goto fail;
+    }
+
+    enjp_message("Packed %ld relative relocations into %ld bytes (was %ld bytes), %ld relocations left",
+                 packed_count, relr_size, packed_count * entsize, kept_count);
+
+    enj_free(packed);
+    enj_free(relr_data);
+    return 0;
+
+fail:
+    enj_free(packed);
+    enj_free(relr_data);
+    return -1;
+}
+
+static enjp_reloc_command _this_cmd =
+{
+    "pack",
+    "Pack relative relocations",
+    &enjp_reloc_pack_help,
+    &enjp_reloc_pack_run
+};
+
+static __attribute__((constructor(200))) void _register()
+{
+    enj_error* err = 0;
+
+    if (enjp_reloc_register_command(&_this_cmd, &err) < 0)
+        enjp_fatal(&err, "Unable to register relocation command 'pack'");
+}
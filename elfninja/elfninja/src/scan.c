@@ -0,0 +1,913 @@
+/*
+ * This file is part of elfninja
+ * Copyright (C) 2017  Alexandre Monti
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define _GNU_SOURCE
+
+#include "tool.h"
+#include "log.h"
+
+#include "elfninja/core/core.h"
+#include "elfninja/input/input.h"
+#include "elfninja/dump/dump.h"
+
+#include <stdio.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+static const char* _help_msg =
+"Usage : elfninja scan <path> [<path> ...] [--threads=<count>] [--max-inflight=<count>]\n"
+"                      [--format=<format>]\n"
+"Walk the given directories and probe every regular file found, emitting one record\n"
+"per ELF file (non-ELF files are skipped after reading their first bytes).\n"
+"Symbolic links found while walking are not followed.\n"
+"\n"
+"Options :\n"
+"  --threads=<count>      : number of worker threads (defaults to the number of CPUs).\n"
+"  --max-inflight=<count> : maximum number of files probed at the same time (defaults\n"
+"                           to the number of threads).\n"
+"  --format=<format>      : format string for each record, using the same syntax as\n"
+"                           'elfninja dump'. A newline is appended to each record.\n"
+"                           When not specified, records are emitted as JSON lines.\n"
+"\n"
+"Format fields :\n"
+"  path     : path of the file\n"
+"  class    : ELF file class (ELFCLASS32 / ELFCLASS64)\n"
+"  type     : ELF file type\n"
+"  machine  : target machine architecture\n"
+"  build_id : GNU build ID, in hexadecimal\n"
+"  soname   : DT_SONAME of the file\n"
+"  needed   : comma-separated list of DT_NEEDED entries\n"
+;
+
+enum
+{
+    SCAN_PATH,
+    SCAN_CLASS,
+    SCAN_TYPE,
+    SCAN_MACHINE,
+    SCAN_BUILD_ID,
+    SCAN_SONAME,
+    SCAN_NEEDED
+};
+
+static struct
+{
+    const char* name;
+    size_t field;
+    int probe;
+} _scan_fields[] =
+{
+    { "path",     SCAN_PATH,     0                  },
+    { "class",    SCAN_CLASS,    ENJ_PROBE_CLASS    },
+    { "type",     SCAN_TYPE,     ENJ_PROBE_TYPE     },
+    { "machine",  SCAN_MACHINE,  ENJ_PROBE_MACHINE  },
+    { "build_id", SCAN_BUILD_ID, ENJ_PROBE_BUILD_ID },
+    { "soname",   SCAN_SONAME,   ENJ_PROBE_SONAME   },
+    { "needed",   SCAN_NEEDED,   ENJ_PROBE_NEEDED   },
+    { 0,          0,             0                  }
+};
+
+typedef struct _scan_record
+{
+    const char* path;
+    enj_probe_result* result;
+} _scan_record;
+
+typedef struct _scan_item
+{
+    char* path;
+    int is_dir;
+} _scan_item;
+
+// Work queue of a single worker ; the owner pushes and pops at the tail,
+//   idle workers steal from the head
+typedef struct _scan_deque
+{
+    pthread_mutex_t lock;
+
+    _scan_item* items;
+    size_t head;
+    size_t count;
+    size_t capacity;
+} _scan_deque;
+
+typedef struct _scan_worker
+{
+    size_t index;
+    pthread_t thread;
+
+    _scan_deque deque;
+    enj_probe_result result;
+
+    // Per-worker memory sink, so that records are written out in one go
+    enjd_sink* out;
+} _scan_worker;
+
+static struct
+{
+    _scan_worker* workers;
+    size_t worker_count;
+
+    // Items pushed but not yet processed, and items sitting in a deque
+    atomic_size_t pending;
+    atomic_size_t queued;
+
+    // Idle workers sleep here until some work is queued or everything is done
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle_cond;
+    atomic_size_t sleepers;
+
+    // Limits the number of files being probed at the same time
+    sem_t inflight;
+
+    // Serializes records and diagnostics
+    pthread_mutex_t output_lock;
+
+    const char* fmt_string;
+    enjd_formatter* fmt;
+    enjd_program* prog;
+    int probe_fields;
+
+    atomic_size_t found;
+    atomic_size_t failures;
+} _scan;
+
+static const char* _type_name(int type)
+{
+    switch (type)
+    {
+        case ET_REL:  return "ET_REL";
+        case ET_EXEC: return "ET_EXEC";
+        case ET_DYN:  return "ET_DYN";
+        case ET_CORE: return "ET_CORE";
+        default:      return 0;
+    }
+}
+
+static const char* _machine_name(int machine)
+{
+    switch (machine)
+    {
+        case EM_386:     return "EM_386";
+        case EM_68K:     return "EM_68K";
+        case EM_MIPS:    return "EM_MIPS";
+        case EM_PPC:     return "EM_PPC";
+        case EM_PPC64:   return "EM_PPC64";
+        case EM_S390:    return "EM_S390";
+        case EM_ARM:     return "EM_ARM";
+        case EM_SH:      return "EM_SH";
+        case EM_SPARCV9: return "EM_SPARCV9";
+        case EM_IA_64:   return "EM_IA_64";
+        case EM_X86_64:  return "EM_X86_64";
+        case EM_AARCH64: return "EM_AARCH64";
+        case EM_RISCV:   return "EM_RISCV";
+        case EM_BPF:     return "EM_BPF";
+        default:         return 0;
+    }
+}
+
+static void _json_string(enjd_sink* sink, const char* string)
+{
+    enjd_sink_putc(sink, '"');
+
+    for (const unsigned char* p = (const unsigned char*) string; *p; ++p)
+    {
+        if (*p == '"' || *p == '\\')
+            enjd_sink_printf(sink, "\\%c", *p);
+        else if (*p < 0x20)
+            enjd_sink_printf(sink, "\\u%04x", *p);
+        else
+            enjd_sink_putc(sink, *p);
+    }
+
+    enjd_sink_putc(sink, '"');
+}
+
+static void _json_record(enjd_sink* sink, const char* path, enj_probe_result* result)
+{
+    const char* name;
+
+    enjd_sink_printf(sink, "{\"path\":");
+    _json_string(sink, path);
+
+    if (result->fields & ENJ_PROBE_CLASS)
+        enjd_sink_printf(sink, ",\"class\":\"ELFCLASS%d\"", result->bits);
+
+    if (result->fields & ENJ_PROBE_TYPE)
+    {
+        if ((name = _type_name(result->type)))
+            enjd_sink_printf(sink, ",\"type\":\"%s\"", name);
+        else
+            enjd_sink_printf(sink, ",\"type\":%d", result->type);
+    }
+
+    if (result->fields & ENJ_PROBE_MACHINE)
+    {
+        if ((name = _machine_name(result->machine)))
+            enjd_sink_printf(sink, ",\"machine\":\"%s\"", name);
+        else
+            enjd_sink_printf(sink, ",\"machine\":%d", result->machine);
+    }
+
+    if (result->fields & ENJ_PROBE_BUILD_ID)
+    {
+        enjd_sink_printf(sink, ",\"build_id\":\"");
+
+        for (size_t i = 0; i < result->build_id_length; ++i)
+            enjd_sink_printf(sink, "%02x", result->build_id[i]);
+
+        enjd_sink_putc(sink, '"');
+    }
+
+    if (result->fields & ENJ_PROBE_SONAME)
+    {
+        enjd_sink_printf(sink, ",\"soname\":");
+        _json_string(sink, result->soname);
+    }
+
+    if (result->fields & ENJ_PROBE_NEEDED)
+    {
+        enjd_sink_printf(sink, ",\"needed\":[");
+
+        for (size_t i = 0; i < result->needed_count; ++i)
+        {
+            if (i)
+                enjd_sink_putc(sink, ',');
+            _json_string(sink, result->needed[i]);
+        }
+
+        enjd_sink_putc(sink, ']');
+    }
+
+    if (result->truncated)
+        enjd_sink_printf(sink, ",\"truncated\":true");
+
+    enjd_sink_printf(sink, "}\n");
+}
+
+static int _scan_field(void* arg0, void* arg1, enjd_sink* sink, int width, char pad, enj_error** err)
+{
+    if (!arg1)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    size_t field = (size_t) arg0;
+    _scan_record* record = (_scan_record*) arg1;
+    enj_probe_result* result = record->result;
+    const char* name;
+
+    switch (field)
+    {
+        case SCAN_PATH:
+            enjd_sink_padded_printf(sink, width, pad, "%s", record->path);
+            break;
+
+        case SCAN_CLASS:
+            enjd_sink_padded_printf(sink, width, pad, "ELFCLASS%d", result->bits);
+            break;
+
+        case SCAN_TYPE:
+            if ((name = _type_name(result->type)))
+                enjd_sink_padded_printf(sink, width, pad, "%s", name);
+            else
+                enjd_sink_padded_printf(sink, width, pad, "ET_NONE(0x%04X)", result->type);
+            break;
+
+        case SCAN_MACHINE:
+            if ((name = _machine_name(result->machine)))
+                enjd_sink_padded_printf(sink, width, pad, "%s", name);
+            else
+                enjd_sink_padded_printf(sink, width, pad, "EM_NONE(0x%04X)", result->machine);
+            break;
+
+        case SCAN_BUILD_ID:
+        {
+            char hex[2 * ENJ_PROBE_BUILD_ID_SIZE + 1] = { 0 };
+            for (size_t i = 0; i < result->build_id_length; ++i)
+                sprintf(hex + 2 * i, "%02x", result->build_id[i]);
+
+            enjd_sink_padded_printf(sink, width, pad, "%s", hex);
+            break;
+        }
+
+        case SCAN_SONAME:
+            enjd_sink_padded_printf(sink, width, pad, "%s", result->soname);
+            break;
+
+        case SCAN_NEEDED:
+        {
+            size_t length = 0;
+            for (size_t i = 0; i < result->needed_count; ++i)
+                length += strlen(result->needed[i]) + 1;
+
+            char list[length + 1];
+            list[0] = '\0';
+
+            for (size_t i = 0; i < result->needed_count; ++i)
+            {
+                if (i)
+                    strcat(list, ",");
+                strcat(list, result->needed[i]);
+            }
+
+            enjd_sink_padded_printf(sink, width, pad, "%s", list);
+            break;
+        }
+
+        default:
+        {
+            enj_error_put(err, ENJ_ERR_ARGUMENT);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static enjd_formatter* _scan_formatter_create(enj_error** err)
+{
+    enjd_formatter* fmt = enjd_formatter_create(err);
+    if (!fmt)
+        return 0;
+
+    for (size_t i = 0; _scan_fields[i].name; ++i)
+    {
+        if (!enjd_formatter_new_elem(fmt, _scan_fields[i].name, &_scan_field, (void*) _scan_fields[i].field, err))
+        {
+            enjd_formatter_delete(fmt);
+            return 0;
+        }
+    }
+
+    return fmt;
+}
+
+static int _deque_push(_scan_deque* deque, char* path, int is_dir)
+{
+    pthread_mutex_lock(&deque->lock);
+
+    if (deque->count == deque->capacity)
+    {
+        size_t capacity = deque->capacity ? deque->capacity * 2 : 64;
+
+        _scan_item* items = enj_malloc(capacity * sizeof(_scan_item));
+        if (!items)
+        {
+            pthread_mutex_unlock(&deque->lock);
+            return -1;
+        }
+
+        // Unwrap the ring buffer in the new storage
+        for (size_t i = 0; i < deque->count; ++i)
+            items[i] = deque->items[(deque->head + i) % deque->capacity];
+
+        enj_free(deque->items);
+        deque->items = items;
+        deque->head = 0;
+        deque->capacity = capacity;
+    }
+
+    _scan_item* item = &deque->items[(deque->head + deque->count) % deque->capacity];
+    item->path = path;
+    item->is_dir = is_dir;
+    ++deque->count;
+
+    pthread_mutex_unlock(&deque->lock);
+    return 0;
+}
+
+static int _deque_pop(_scan_deque* deque, _scan_item* item)
+{
+    int found = 0;
+
+    pthread_mutex_lock(&deque->lock);
+
+    if (deque->count)
+    {
+        --deque->count;
+        *item = deque->items[(deque->head + deque->count) % deque->capacity];
+        found = 1;
+    }
+
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static int _deque_steal(_scan_deque* deque, _scan_item* item)
+{
+    int found = 0;
+
+    // Don't wait on a busy victim, there may be work elsewhere
+    if (pthread_mutex_trylock(&deque->lock))
+        return 0;
+
+    if (deque->count)
+    {
+        *item = deque->items[deque->head];
+        deque->head = (deque->head + 1) % deque->capacity;
+        --deque->count;
+        found = 1;
+    }
+
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+// Queue an item on the given worker, takes ownership of path
+static int _push(_scan_worker* worker, char* path, int is_dir)
+{
+    atomic_fetch_add(&_scan.pending, 1);
+
+    if (_deque_push(&worker->deque, path, is_dir) < 0)
+    {
+        atomic_fetch_sub(&_scan.pending, 1);
+        enj_free(path);
+        return -1;
+    }
+
+    atomic_fetch_add(&_scan.queued, 1);
+
+    if (atomic_load(&_scan.sleepers))
+    {
+        pthread_mutex_lock(&_scan.idle_lock);
+        pthread_cond_signal(&_scan.idle_cond);
+        pthread_mutex_unlock(&_scan.idle_lock);
+    }
+
+    return 0;
+}
+
+// Get the next item for a worker, returns 0 when the whole scan is done
+static int _next(_scan_worker* worker, _scan_item* item)
+{
+    for (;;)
+    {
+        if (_deque_pop(&worker->deque, item))
+        {
+            atomic_fetch_sub(&_scan.queued, 1);
+            return 1;
+        }
+
+        for (size_t i = 1; i < _scan.worker_count; ++i)
+        {
+            _scan_worker* victim = &_scan.workers[(worker->index + i) % _scan.worker_count];
+
+            if (_deque_steal(&victim->deque, item))
+            {
+                atomic_fetch_sub(&_scan.queued, 1);
+                return 1;
+            }
+        }
+
+        pthread_mutex_lock(&_scan.idle_lock);
+        atomic_fetch_add(&_scan.sleepers, 1);
+
+        while (!atomic_load(&_scan.queued) && atomic_load(&_scan.pending))
+            pthread_cond_wait(&_scan.idle_cond, &_scan.idle_lock);
+
+        atomic_fetch_sub(&_scan.sleepers, 1);
+        pthread_mutex_unlock(&_scan.idle_lock);
+
+        if (!atomic_load(&_scan.pending))
+            return 0;
+    }
+}
+
+static void _done()
+{
+    if (atomic_fetch_sub(&_scan.pending, 1) == 1)
+    {
+        pthread_mutex_lock(&_scan.idle_lock);
+        pthread_cond_broadcast(&_scan.idle_cond);
+        pthread_mutex_unlock(&_scan.idle_lock);
+    }
+}
+
+static char* _join(const char* dir, const char* name)
+{
+    size_t dir_length = strlen(dir);
+    size_t name_length = strlen(name);
+
+    // Avoid doubling the separator for paths such as '/'
+    while (dir_length > 1 && dir[dir_length - 1] == '/')
+        --dir_length;
+
+    char* path = enj_malloc(dir_length + name_length + 2);
+    if (!path)
+        return 0;
+
+    memcpy(path, dir, dir_length);
+    if (!dir_length || dir[dir_length - 1] != '/')
+        path[dir_length++] = '/';
+    memcpy(path + dir_length, name, name_length + 1);
+
+    return path;
+}
+
+static void _failure(const char* path, enj_error** err, const char* what)
+{
+    atomic_fetch_add(&_scan.failures, 1);
+
+    pthread_mutex_lock(&_scan.output_lock);
+    enjp_warning(err, "%s '%s'", what, path);
+    pthread_mutex_unlock(&_scan.output_lock);
+}
+
+static void _walk(_scan_worker* worker, const char* path)
+{
+    enj_error* err = 0;
+
+    DIR* dir = opendir(path);
+    if (!dir)
+    {
+        enj_error_put_posix_errno(&err, ENJ_ERR_IO, errno);
+        _failure(path, &err, "Unable to open directory");
+        return;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)))
+    {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+            continue;
+
+        int type = entry->d_type;
+        if (type != DT_DIR && type != DT_REG && type != DT_LNK)
+        {
+            char* child = _join(path, entry->d_name);
+            struct stat st;
+
+            if (child && !lstat(child, &st))
+                type = S_ISDIR(st.st_mode) ? DT_DIR : (S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN);
+
+            enj_free(child);
+        }
+
+        if (type != DT_DIR && type != DT_REG)
+            continue;
+
+        char* child = _join(path, entry->d_name);
+        if (!child || _push(worker, child, type == DT_DIR) < 0)
+        {
+            enj_error_put(&err, ENJ_ERR_MALLOC);
+            _failure(path, &err, "Unable to queue entries of");
+            break;
+        }
+    }
+
+    closedir(dir);
+}
+
+static void _probe(_scan_worker* worker, const char* path)
+{
+    enj_error* err = 0;
+    int ret;
+
+    while (sem_wait(&_scan.inflight) < 0 && errno == EINTR)
+        ;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        sem_post(&_scan.inflight);
+
+        enj_error_put_posix_errno(&err, ENJ_ERR_IO, errno);
+        _failure(path, &err, "Unable to open");
+        return;
+    }
+
+    ret = enj_elf_probe(fd, _scan.probe_fields, &worker->result, &err);
+
+    close(fd);
+    sem_post(&_scan.inflight);
+
+    if (ret < 0)
+    {
+        // Not an ELF file, skip it silently
+        if (err && err->code == ENJ_ERR_BADHDR)
+        {
+            enj_error_delete(err);
+            return;
+        }
+
+        _failure(path, &err, "Unable to probe");
+        return;
+    }
+
+    atomic_fetch_add(&_scan.found, 1);
+
+    // Format the record in the worker's sink, then write it out at once
+    enjd_sink_reset(worker->out);
+
+    if (_scan.prog)
+    {
+        _scan_record record = { path, &worker->result };
+
+        if (enjd_program_run(_scan.prog, &record, worker->out, &err) < 0)
+        {
+            _failure(path, &err, "Unable to format record for");
+            return;
+        }
+
+        enjd_sink_putc(worker->out, '\n');
+    }
+    else
+        _json_record(worker->out, path, &worker->result);
+
+    if (enjd_sink_error(worker->out, &err) < 0)
+    {
+        _failure(path, &err, "Unable to format record for");
+        return;
+    }
+
+    pthread_mutex_lock(&_scan.output_lock);
+
+    for (size_t count = 0; count < worker->out->length; )
+    {
+        ssize_t written = write(1, worker->out->buffer + count, worker->out->length - count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        count += written;
+    }
+
+    pthread_mutex_unlock(&_scan.output_lock);
+}
+
+static void* _worker_main(void* arg)
+{
+    _scan_worker* worker = (_scan_worker*) arg;
+    _scan_item item;
+
+    while (_next(worker, &item))
+    {
+        if (item.is_dir)
+            _walk(worker, item.path);
+        else
+            _probe(worker, item.path);
+
+        enj_free(item.path);
+        _done();
+    }
+
+    return 0;
+}
+
+static int _count_option(enji_cmdline* cmd, const char* name, size_t* value)
+{
+    enj_error* err = 0;
+    enji_cmdline_option* opt;
+
+    if (!(opt = enji_cmdline_find_option(cmd, name, ENJI_CMDLINE_TOOL, 0, 0)))
+        return 0;
+
+    if (!opt->value)
+    {
+        enjp_error(0, "Option '%s' expects a value", name);
+        return -1;
+    }
+
+    *value = enji_parse_number(opt->value, &err);
+    if (err)
+    {
+        enjp_error(&err, "Invalid value for option '%s'", name);
+        return -1;
+    }
+
+    if (!*value)
+    {
+        enjp_error(0, "Option '%s' expects a non-zero value", name);
+        return -1;
+    }
+
+    return 0;
+}
+
+int enjp_scan_help(enji_cmdline* cmd)
+{
+    printf("%s", _help_msg);
+
+    return 0;
+}
+
+int enjp_scan_run(enji_cmdline* cmd)
+{
+    if (!cmd)
+        return -1;
+
+    enj_error* err = 0;
+    int ret = -1;
+
+    if (!cmd->arguments)
+        enjp_fatal(0, "No path specified. Try 'elfninja help scan'");
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t threads = cpus > 0 ? cpus : 1;
+    size_t max_inflight = 0;
+
+    if (_count_option(cmd, "threads", &threads) < 0 ||
+        _count_option(cmd, "max-inflight", &max_inflight) < 0)
+        return -1;
+
+    if (!max_inflight)
+        max_inflight = threads;
+
+    _scan.probe_fields = ENJ_PROBE_ALL;
+
+    enji_cmdline_option* opt;
+    if ((opt = enji_cmdline_find_option(cmd, "format", ENJI_CMDLINE_TOOL, 0, 0)))
+    {
+        if (!opt->value)
+        {
+            enjp_error(0, "Option 'format' expects a value");
+            return -1;
+        }
+
+        _scan.fmt_string = opt->value;
+        _scan.fmt = _scan_formatter_create(&err);
+        if (!_scan.fmt)
+        {
+            enjp_error(&err, "Unable to create formatter object");
+            return -1;
+        }
+
+        // Workers share the compiled format, which is only read
+        _scan.prog = enjd_formatter_compile(_scan.fmt, _scan.fmt_string, &err);
+        if (!_scan.prog)
+        {
+            enjp_error(&err, "Invalid format string");
+            enjd_formatter_delete(_scan.fmt);
+            return -1;
+        }
+
+        // Only probe what the records will show
+        _scan.probe_fields = 0;
+
+        for (size_t i = 0; i < _scan.prog->op_count; ++i)
+        {
+            if (!_scan.prog->ops[i].elem)
+                continue;
+
+            for (size_t j = 0; _scan_fields[j].name; ++j)
+            {
+                if (_scan.prog->ops[i].elem->arg0 == (void*) _scan_fields[j].field)
+                    _scan.probe_fields |= _scan_fields[j].probe;
+            }
+        }
+    }
+
+    _scan.worker_count = threads;
+    _scan.workers = enj_malloc(threads * sizeof(_scan_worker));
+    if (!_scan.workers)
+    {
+        enj_error_put(&err, ENJ_ERR_MALLOC);
+        enjp_error(&err, "Unable to allocate workers");
+        goto fail;
+    }
+
+    atomic_init(&_scan.pending, 0);
+    atomic_init(&_scan.queued, 0);
+    atomic_init(&_scan.sleepers, 0);
+    atomic_init(&_scan.found, 0);
+    atomic_init(&_scan.failures, 0);
+
+    pthread_mutex_init(&_scan.idle_lock, 0);
+    pthread_cond_init(&_scan.idle_cond, 0);
+    pthread_mutex_init(&_scan.output_lock, 0);
+    sem_init(&_scan.inflight, 0, max_inflight);
+
+    for (size_t i = 0; i < threads; ++i)
+    {
+        _scan.workers[i].index = i;
+        pthread_mutex_init(&_scan.workers[i].deque.lock, 0);
+    }
+
+    for (size_t i = 0; i < threads; ++i)
+    {
+        if (!(_scan.workers[i].out = enjd_sink_create_memory(&err)))
+        {
+            enjp_error(&err, "Unable to allocate output buffers");
+            goto cleanup;
+        }
+    }
+
+    // Seed the workers with the command line paths, round-robin
+    size_t seeded = 0;
+    for (enji_cmdline_argument* arg = cmd->arguments; arg; arg = arg->next)
+    {
+        const char* path = arg->name->string;
+        struct stat st;
+
+        if (stat(path, &st) < 0)
+        {
+            enj_error_put_posix_errno(&err, ENJ_ERR_IO, errno);
+            _failure(path, &err, "Unable to access");
+            continue;
+        }
+
+        if (!S_ISDIR(st.st_mode) && !S_ISREG(st.st_mode))
+        {
+            enjp_warning(0, "Ignoring '%s' (not a directory nor a regular file)", path);
+            continue;
+        }
+
+        char* copy = strdup(path);
+        if (!copy || _push(&_scan.workers[seeded++ % threads], copy, S_ISDIR(st.st_mode)) < 0)
+        {
+            enj_error_put(&err, ENJ_ERR_MALLOC);
+            enjp_error(&err, "Unable to queue '%s'", path);
+            goto cleanup;
+        }
+    }
+
+    // Run the pool, the main thread being worker 0
+    size_t started = 1;
+    for (; started < threads; ++started)
+    {
+        if (pthread_create(&_scan.workers[started].thread, 0, &_worker_main, &_scan.workers[started]))
+        {
+            enjp_warning(0, "Unable to start more than %ld threads", started);
+            break;
+        }
+    }
+
+    _worker_main(&_scan.workers[0]);
+
+    for (size_t i = 1; i < started; ++i)
+        pthread_join(_scan.workers[i].thread, 0);
+
+    if (atomic_load(&_scan.failures))
+        enjp_warning(0, "%ld ELF files found, %ld paths could not be scanned",
+                     atomic_load(&_scan.found), atomic_load(&_scan.failures));
+
+    ret = 0;
+
+cleanup:
+    for (size_t i = 0; i < threads; ++i)
+    {
+        _scan_deque* deque = &_scan.workers[i].deque;
+
+        for (size_t j = 0; j < deque->count; ++j)
+            enj_free(deque->items[(deque->head + j) % deque->capacity].path);
+
+        enj_free(deque->items);
+        enjd_sink_delete(_scan.workers[i].out);
+        pthread_mutex_destroy(&deque->lock);
+    }
+
+    sem_destroy(&_scan.inflight);
+    pthread_mutex_destroy(&_scan.output_lock);
+    pthread_cond_destroy(&_scan.idle_cond);
+    pthread_mutex_destroy(&_scan.idle_lock);
+
+fail:
+    enj_free(_scan.workers);
+    enjd_program_delete(_scan.prog);
+    enjd_formatter_delete(_scan.fmt);
+    return ret;
+}
+
+static enjp_tool _this_tool =
+{
+    "scan",
+    "Probe all ELF files found in directory trees",
+    &enjp_scan_help,
+    &enjp_scan_run
+};
+
+static __attribute__((constructor(112))) void _register()
+{
+    enj_error* err = 0;
+
+    if (enjp_tool_register(&_this_tool, &err) < 0)
+        enjp_fatal(&err, "Unable to register tool 'scan'");
+}
@@ -50,7 +50,9 @@ int enjp_shdr_add_run(enjp_shdr_tool* s, enji_cmdline_argument* arg, enj_error**
     size_t sh_info = 0;
     size_t sh_entsize = 0;
     size_t sh_addralign = 0;
+    int has_offset = 0;
 
+    enj_trait_layout* lay = 0;
     enji_cmdline_option* opt = 0;
 
     if ((opt = enji_cmdline_find_option(s->cmd, "name", ENJI_CMDLINE_TOOL, arg, 0)))
@@ -126,6 +128,8 @@ int enjp_shdr_add_run(enjp_shdr_tool* s, enji_cmdline_argument* arg, enj_error**
             enjp_error(err, "Invalid value for option '%s'", opt->name->string);
             goto fail;
         }
+
+        has_offset = 1;
     }
 
     if ((opt = enji_cmdline_find_option(s->cmd, "size", ENJI_CMDLINE_TOOL, arg, 0)))
@@ -208,6 +212,15 @@ int enjp_shdr_add_run(enjp_shdr_tool* s, enji_cmdline_argument* arg, enj_error**
         }
     }
 
+    // Track layout changes, to place section data without moving anything if possible
+    int needs_data = !has_offset && sh_size && sh_type != SHT_NOBITS;
+
+    if (needs_data && !(lay = enj_trait_layout_create(s->elf, err)))
+    {
+        enjp_error(err, "Unable to create layout trait");
+        goto fail;
+    }
+
     enj_elf_shdr* section = enj_elf_new_shdr(s->elf, sh_type, name, err);
     if (!section)
     {
@@ -215,6 +228,52 @@ int enjp_shdr_add_run(enjp_shdr_tool* s, enji_cmdline_argument* arg, enj_error**
         goto fail;
     }
 
+    if (needs_data)
+    {
+        enj_trait_layout_constraints constraints = { ENJ_ELF_EHDR_GET(s->elf, e_ehsize), 0, 0, 0, 0 };
+
+        // Allocated sections go where a loadable segment maps their address, or at an
+        //  offset congruent to it (so that a segment can map them) ; other ones stay
+        //  out of segments
+        enj_elf_phdr* load = 0;
+        size_t load_align = 0;
+
+        for (enj_elf_phdr* segment = s->elf->segments; segment && (sh_flags & SHF_ALLOC); segment = segment->next)
+        {
+            if (ENJ_ELF_PHDR_GET(segment, p_type) != PT_LOAD)
+                continue;
+
+            size_t vaddr = ENJ_ELF_PHDR_GET(segment, p_vaddr);
+            size_t filesz = ENJ_ELF_PHDR_GET(segment, p_filesz);
+
+            if (sh_addr >= vaddr && sh_addr + sh_size <= vaddr + filesz)
+                load = segment;
+
+            if (ENJ_ELF_PHDR_GET(segment, p_align) > load_align)
+                load_align = ENJ_ELF_PHDR_GET(segment, p_align);
+        }
+
+        if (load)
+        {
+            constraints.min_offset = ENJ_ELF_PHDR_GET(load, p_offset) + sh_addr - ENJ_ELF_PHDR_GET(load, p_vaddr);
+            constraints.max_offset = constraints.min_offset + sh_size;
+            constraints.flags = ENJ_TRAIT_LAYOUT_NO_APPEND;
+        }
+        else
+        {
+            constraints.flags = ENJ_TRAIT_LAYOUT_NO_SEGMENT;
+            constraints.addr = sh_addr;
+            constraints.addr_align = load_align;
+        }
+
+        sh_offset = enj_trait_layout_alloc(lay, sh_size, sh_addralign > 1 ? sh_addralign : 1, &constraints, err);
+        if (!sh_offset)
+        {
+            enjp_error(err, "Unable to allocate %ld bytes for section data", sh_size);
+            goto fail;
+        }
+    }
+
     ENJ_ELF_SHDR_SET(section, sh_flags, sh_flags);
     ENJ_ELF_SHDR_SET(section, sh_addr, sh_addr);
     ENJ_ELF_SHDR_SET(section, sh_offset, sh_offset);
@@ -224,15 +283,26 @@ int enjp_shdr_add_run(enjp_shdr_tool* s, enji_cmdline_argument* arg, enj_error**
     ENJ_ELF_SHDR_SET(section, sh_entsize, sh_entsize);
     ENJ_ELF_SHDR_SET(section, sh_addralign, sh_addralign);
 
+    // Attach section data
+    if (needs_data &&
+       (enj_elf_shdr_write(section, err) < 0 ||
+        enj_elf_shdr_pull(section, err) < 0))
+    {
+        enjp_error(err, "Unable to setup section data");
+        goto fail;
+    }
+
     if (enj_elf_push(s->elf, err) < 0)
     {
         enjp_error(err, "Unable to push changes to ELF");
         goto fail;
     }
 
+    enj_trait_layout_delete(lay);
     return 0;
 
 fail:
+    enj_trait_layout_delete(lay);
     return -1;
 }
 
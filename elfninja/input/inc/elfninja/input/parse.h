@@ -31,6 +31,7 @@ typedef struct enji_parse_dict
 } enji_parse_dict;
 
 size_t enji_parse_number(const char* string, enj_error** err);
+size_t enji_parse_size(const char* string, enj_error** err);
 size_t enji_parse_offset(enj_elf* elf, const char* string, enj_error** err);
 size_t enji_parse_address(enj_elf* elf, const char* string, enj_error** err);
 char* enji_parse_hex(const char* string, size_t* length, enj_error** err);
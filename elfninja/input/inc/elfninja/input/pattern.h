@@ -21,6 +21,46 @@
 
 #include "elfninja/core/error.h"
 #include "elfninja/core/elf.h"
+#include "elfninja/core/fstring.h"
+
+// Compiled patterns : plain names and names with a leading and/or trailing
+//   '*' are matched with memcmp/memmem, other globs go through fnmatch
+enum
+{
+    ENJI_PATTERN_LITERAL,
+    ENJI_PATTERN_PREFIX,
+    ENJI_PATTERN_SUFFIX,
+    ENJI_PATTERN_CONTAINS,
+    ENJI_PATTERN_ANY,
+    ENJI_PATTERN_GLOB,
+    ENJI_PATTERN_INDEX
+};
+
+// Compilation flags
+enum
+{
+    ENJI_PATTERN_SECTIONS = 0x01 // Section patterns, allowing #n, #<n, #>=n...
+};
+
+typedef struct enji_pattern
+{
+    int kind;
+
+    // Name part, or the whole glob ; the hash is set for literals
+    char* text;
+    size_t length;
+    enj_fstring_hash_t hash;
+
+    // Section index comparison
+    int op;
+    size_t index;
+} enji_pattern;
+
+enji_pattern* enji_pattern_compile(const char* pattern, int flags, enj_error** err);
+void enji_pattern_delete(enji_pattern* pat);
+
+int enji_pattern_match_name(enji_pattern const* pat, enj_fstring const* name);
+int enji_pattern_match_section(enji_pattern const* pat, enj_elf_shdr* section);
 
 int enji_pattern_match(enj_elf_shdr* section, const char* pattern, enj_error** err);
 enj_elf_shdr* enji_pattern_match_unique(enj_elf* elf, const char* pattern, enj_error** err);
@@ -106,6 +106,59 @@ size_t enji_parse_number(const char* string, enj_error** err)
     return value;
 }
 
+size_t enji_parse_size(const char* string, enj_error** err)
+{
+    if (!string)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return 0;
+    }
+
+    size_t length = strlen(string);
+    size_t shift = 0;
+
+    // Strip an eventual K / M / G suffix
+    if (length > 1)
+    {
+        switch (string[length - 1])
+        {
+            case 'k': case 'K': shift = 10; break;
+            case 'm': case 'M': shift = 20; break;
+            case 'g': case 'G': shift = 30; break;
+        }
+    }
+
+    if (!shift)
+        return enji_parse_number(string, err);
+
+    char* number = enj_malloc(length);
+    if (!number)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return 0;
+    }
+
+    memcpy(number, string, length - 1);
+
+    enj_error* parse_err = 0;
+    size_t value = enji_parse_number(number, &parse_err);
+    enj_free(number);
+
+    if (parse_err)
+    {
+        enj_error_wrap(err, ENJ_ERR_BAD_NUMBER, parse_err);
+        return 0;
+    }
+
+    if (value > (((size_t) -1) >> shift))
+    {
+        enj_error_put(err, ENJ_ERR_TOO_BIG);
+        return 0;
+    }
+
+    return value << shift;
+}
+
 size_t enji_parse_offset(enj_elf* elf, const char* string, enj_error** err)
 {
     if (!elf || !string)
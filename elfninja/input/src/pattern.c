@@ -16,6 +16,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#define _GNU_SOURCE
+
 #include "elfninja/input/pattern.h"
 #include "elfninja/input/parse.h"
 
@@ -26,85 +28,240 @@
 #include <ctype.h>
 #include <fnmatch.h>
 
-int enji_pattern_match(enj_elf_shdr* section, const char* pattern, enj_error** err)
+enum
 {
-    if (!section || !pattern)
+    OP_EQ,
+    OP_LT,
+    OP_LTE,
+    OP_GT,
+    OP_GTE
+};
+
+// Can the pattern be matched with memcmp/memmem ? It then has to be plain
+//   text with an eventual leading and trailing '*', and no extended glob ;
+//   the text is then p[*start, *end)
+static int _classify(const char* p, size_t* start, size_t* end)
+{
+    size_t length = strlen(p);
+
+    *start = 0;
+    *end = length;
+
+    for (size_t i = 0; i + 1 < length; ++i)
+    {
+        if (p[i + 1] == '(' && strchr("?*+@!", p[i]))
+            return ENJI_PATTERN_GLOB;
+    }
+
+    int leading = 0;
+    int trailing = 0;
+
+    if (*start < *end && p[*start] == '*')
+    {
+        ++*start;
+        leading = 1;
+    }
+
+    if (*start < *end && p[*end - 1] == '*')
+    {
+        --*end;
+        trailing = 1;
+    }
+
+    for (size_t i = *start; i < *end; ++i)
+    {
+        if (strchr("*?[\\", p[i]))
+        {
+            *start = 0;
+            *end = length;
+            return ENJI_PATTERN_GLOB;
+        }
+    }
+
+    if (*start == *end && (leading || trailing))
+        return ENJI_PATTERN_ANY;
+    else if (leading && trailing)
+        return ENJI_PATTERN_CONTAINS;
+    else if (leading)
+        return ENJI_PATTERN_SUFFIX;
+    else if (trailing)
+        return ENJI_PATTERN_PREFIX;
+
+    return ENJI_PATTERN_LITERAL;
+}
+
+enji_pattern* enji_pattern_compile(const char* pattern, int flags, enj_error** err)
+{
+    if (!pattern)
     {
         enj_error_put(err, ENJ_ERR_ARGUMENT);
-        return -1;
+        return 0;
     }
 
-    enum
+    enji_pattern* pat = enj_malloc(sizeof(enji_pattern));
+    if (!pat)
     {
-        OP_EQ,
-        OP_LT,
-        OP_LTE,
-        OP_GT,
-        OP_GTE
-    };
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        return 0;
+    }
 
     const char* p = pattern;
-    while (isspace(*p))
-        ++p;
 
-    if (*p == '#')
+    if (flags & ENJI_PATTERN_SECTIONS)
     {
-        ++p;
+        while (isspace(*p))
+            ++p;
 
-        int op = OP_EQ;
-        if (*p == '<')
+        if (*p == '#')
         {
             ++p;
-            if (*p == '=')
+
+            pat->kind = ENJI_PATTERN_INDEX;
+            pat->op = OP_EQ;
+            if (*p == '<')
             {
                 ++p;
-                op = OP_LTE;
+                if (*p == '=')
+                {
+                    ++p;
+                    pat->op = OP_LTE;
+                }
+                else
+                    pat->op = OP_LT;
             }
-            else
-                op = OP_LT;
-        }
-        else if (*p == '>')
-        {
-            ++p;
-            if (*p == '=')
+            else if (*p == '>')
             {
                 ++p;
-                op = OP_GTE;
+                if (*p == '=')
+                {
+                    ++p;
+                    pat->op = OP_GTE;
+                }
+                else
+                    pat->op = OP_GT;
             }
-            else
-                op = OP_GT;
+
+            pat->index = enji_parse_number(p, err);
+            if (*err)
+            {
+                enj_free(pat);
+                return 0;
+            }
+
+            return pat;
         }
+    }
 
-        size_t index = enji_parse_number(p, err);
-        if (*err)
-            return -1;
+    size_t start;
+    size_t end;
+    pat->kind = _classify(p, &start, &end);
 
-        switch (op)
-        {
-            case OP_EQ:
-                return section->index == index ? 1 : 0;
+    pat->length = end - start;
+    pat->text = enj_malloc(pat->length + 1);
+    if (!pat->text)
+    {
+        enj_error_put(err, ENJ_ERR_MALLOC);
+        enj_free(pat);
+        return 0;
+    }
 
-            case OP_LT:
-                return section->index < index ? 1 : 0;
+    memcpy(pat->text, p + start, pat->length);
+    pat->text[pat->length] = '\0';
 
-            case OP_LTE:
-                return section->index <= index ? 1 : 0;
+    if (pat->kind == ENJI_PATTERN_LITERAL)
+        pat->hash = enj_fstring_hash(pat->text);
 
-            case OP_GT:
-                return section->index > index ? 1 : 0;
+    return pat;
+}
 
-            case OP_GTE:
-                return section->index >= index ? 1 : 0;
+void enji_pattern_delete(enji_pattern* pat)
+{
+    if (!pat)
+        return;
 
-            default:
-                return 0;
-        }
+    enj_free(pat->text);
+    enj_free(pat);
+}
+
+int enji_pattern_match_name(enji_pattern const* pat, enj_fstring const* name)
+{
+    if (!pat || !name)
+        return 0;
+
+    size_t length = name->length - 1;
+
+    switch (pat->kind)
+    {
+        case ENJI_PATTERN_LITERAL:
+            return name->hash == pat->hash && length == pat->length &&
+                   !memcmp(name->string, pat->text, length);
+
+        case ENJI_PATTERN_PREFIX:
+            return length >= pat->length && !memcmp(name->string, pat->text, pat->length);
+
+        case ENJI_PATTERN_SUFFIX:
+            return length >= pat->length && !memcmp(name->string + length - pat->length, pat->text, pat->length);
+
+        case ENJI_PATTERN_CONTAINS:
+            return memmem(name->string, length, pat->text, pat->length) != 0;
+
+        case ENJI_PATTERN_ANY:
+            return 1;
+
+        case ENJI_PATTERN_GLOB:
+            return fnmatch(pat->text, name->string, FNM_EXTMATCH) == 0;
+
+        default:
+            return 0;
     }
+}
+
+int enji_pattern_match_section(enji_pattern const* pat, enj_elf_shdr* section)
+{
+    if (!pat || !section)
+        return 0;
 
-    if (fnmatch(p, section->cached_name->string, FNM_EXTMATCH) == 0)
-        return 1;
+    if (pat->kind != ENJI_PATTERN_INDEX)
+        return enji_pattern_match_name(pat, section->cached_name);
 
-    return 0;
+    switch (pat->op)
+    {
+        case OP_EQ:
+            return section->index == pat->index ? 1 : 0;
+
+        case OP_LT:
+            return section->index < pat->index ? 1 : 0;
+
+        case OP_LTE:
+            return section->index <= pat->index ? 1 : 0;
+
+        case OP_GT:
+            return section->index > pat->index ? 1 : 0;
+
+        case OP_GTE:
+            return section->index >= pat->index ? 1 : 0;
+
+        default:
+            return 0;
+    }
+}
+
+int enji_pattern_match(enj_elf_shdr* section, const char* pattern, enj_error** err)
+{
+    if (!section || !pattern)
+    {
+        enj_error_put(err, ENJ_ERR_ARGUMENT);
+        return -1;
+    }
+
+    enji_pattern* pat = enji_pattern_compile(pattern, ENJI_PATTERN_SECTIONS, err);
+    if (!pat)
+        return -1;
+
+    int match = enji_pattern_match_section(pat, section);
+    enji_pattern_delete(pat);
+
+    return match;
 }
 
 enj_elf_shdr* enji_pattern_match_unique(enj_elf* elf, const char* pattern, enj_error** err)
@@ -115,26 +272,28 @@ enj_elf_shdr* enji_pattern_match_unique(enj_elf* elf, const char* pattern, enj_e
         return 0;
     }
 
+    enji_pattern* pat = enji_pattern_compile(pattern, ENJI_PATTERN_SECTIONS, err);
+    if (!pat)
+        return 0;
+
     enj_elf_shdr* found = 0;
 
     for (enj_elf_shdr* section = elf->sections; section; section = section->next)
     {
-        int match = enji_pattern_match(section, pattern, err);
-        if (match < 0)
-            return 0;
-
-        if (match)
+        if (enji_pattern_match_section(pat, section))
         {
             if (!found)
                 found = section;
             else
             {
                 enj_error_put(err, ENJ_ERR_MULTIPLE_MATCH);
+                enji_pattern_delete(pat);
                 return 0;
             }
         }
     }
 
+    enji_pattern_delete(pat);
     return found;
 }
 